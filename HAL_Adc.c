@@ -0,0 +1,504 @@
+/*******************************************************************************
+ *
+ *  HAL_Adc.c - Multi-channel ADC12 acquisition engine
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_Adc.c
+ * @addtogroup HAL_Adc
+ * @{
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_Dma.h"
+#include "HAL_Energy.h"
+#include "HAL_Adc.h"
+
+// Sequence trigger: TA0.1 output from ACLK; the period is stretched to the
+// next tick at which any channel is due, so idle ticks cost no wake-up
+#define ADC_TIMER_CTL       TA0CTL
+#define ADC_TIMER_CCR0      TA0CCR0
+#define ADC_TIMER_CCTL1     TA0CCTL1
+#define ADC_TIMER_CCR1      TA0CCR1
+#define ADC_TICK_PERIOD     (32768 / ADC_TICK_RATE)
+
+// Results are block-copied from ADC12MEMx by DMA channel 1
+#define ADC_DMA_CHANNEL     DMA_CHANNEL_1
+#define ADC_DMA_CTL         DMA1CTL
+#define ADC_DMA_SA          DMA1SA
+#define ADC_DMA_DA          DMA1DA
+#define ADC_DMA_SZ          DMA1SZ
+#define ADC_DMA_TRIGGER     24         // ADC12IFGx (end of sequence)
+
+#define ADC_NUM_SLOTS       12         // ADC12MEMx registers in use
+#define CSTARTADD_SHIFT     12
+
+// Factory calibration in the TLV structure (2.5 V reference)
+#define TLV_CAL_ADC_25T30   (*(uint16_t *)0x1A22)
+#define TLV_CAL_ADC_25T85   (*(uint16_t *)0x1A24)
+
+typedef struct
+{
+    uint8_t control;                   // ADC12MCTLx value (reference and input)
+    uint8_t firstSlot;                 // First ADC12MEMx used
+    uint8_t shift;                     // log2 of the number of oversampled slots
+    uint8_t usesReference;             // Needs the internal reference
+} AdcChannelConfig;
+
+typedef struct
+{
+    uint8_t divider;                   // Ticks between samples, 0 = off
+    uint8_t countdown;                 // Ticks until the next sample is due
+    uint8_t head;                      // Next history entry to write
+    uint16_t latest;
+    uint16_t history[ADC_HISTORY_SIZE];
+    Adc_callback subscribers[ADC_MAX_SUBSCRIBERS];
+} AdcChannel;
+
+// Slots 0-7 use ADC12SHT0x, slots 8-15 the longer ADC12SHT1x needed by the
+// temperature sensor (>= 30 us)
+static const AdcChannelConfig channelConfig[ADC_NUM_CHANNELS] = {
+    { ADC12SREF_0 + ADC12INCH_5,  0, 3, 0 },    // Wheel: 8 samples
+    { ADC12SREF_1 + ADC12INCH_10, 8, 1, 1 },    // Temperature: 2 samples
+    { ADC12SREF_1 + ADC12INCH_11, 10, 1, 1 },   // Supply: 2 samples
+};
+
+static AdcChannel channels[ADC_NUM_CHANNELS];
+static uint16_t results[ADC_NUM_SLOTS];
+const uint16_t Adc_ramSize = sizeof(channels) + sizeof(results);
+static uint8_t dueMask = 0;            // Channels in the programmed sequence
+static uint8_t running = 0;
+static uint8_t initialized = 0;
+
+// Forward declared functions
+static void Adc_start(void);
+static void Adc_stop(void);
+static void Adc_schedule(void);
+static void Adc_program(void);
+static void Adc_sequenceDone(void);
+
+/***************************************************************************//**
+ * @brief  Set up the ADC12 acquisition engine. All channels start disabled;
+ *         enable them with Adc_setRate(). Calling it again has no effect.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Adc_init(void)
+{
+    uint8_t i;
+
+    if (initialized)
+        return;
+    initialized = 1;
+
+    for (i = 0; i < ADC_NUM_CHANNELS; i++)
+    {
+        channels[i].divider = 0;
+        channels[i].head = 0;
+        channels[i].latest = 0;
+        channels[i].subscribers[0] = 0;
+        channels[i].subscribers[1] = 0;
+    }
+
+    Dma_setTrigger(ADC_DMA_CHANNEL, ADC_DMA_TRIGGER);
+    Dma_setCallback(ADC_DMA_CHANNEL, Adc_sequenceDone);
+}
+
+/***************************************************************************//**
+ * @brief  Set the sample rate of a channel
+ *
+ *         The rate is rounded to ADC_TICK_RATE divided by an integer. Changing
+ *         a rate restarts the schedule of all channels.
+ * @param  channel  ADC_CHANNEL_WHEEL, ADC_CHANNEL_TEMP or ADC_CHANNEL_VCC
+ * @param  rateHz   Samples per second (1 ... ADC_TICK_RATE), 0 to disable
+ * @return none
+ ******************************************************************************/
+
+void Adc_setRate(uint8_t channel, uint16_t rateHz)
+{
+    uint8_t i;
+    uint8_t anyEnabled = 0;
+    uint16_t gie;
+
+    if (channel >= ADC_NUM_CHANNELS)
+        return;
+
+    if (rateHz > ADC_TICK_RATE)
+        rateHz = ADC_TICK_RATE;
+
+    gie = __get_SR_register() & GIE;
+    __disable_interrupt();
+    Adc_stop();
+
+    channels[channel].divider = rateHz ? ADC_TICK_RATE / rateHz : 0;
+    for (i = 0; i < ADC_NUM_CHANNELS; i++)
+    {
+        channels[i].countdown = 0;
+        if (channels[i].divider)
+            anyEnabled = 1;
+    }
+
+    if (anyEnabled)
+        Adc_start();
+    __bis_SR_register(gie);
+}
+
+/***************************************************************************//**
+ * @brief  Get the sample rate of a channel
+ * @param  channel  ADC_CHANNEL_xxx
+ * @return Samples per second, 0 if the channel is disabled
+ ******************************************************************************/
+
+uint16_t Adc_getRate(uint8_t channel)
+{
+    if (channel >= ADC_NUM_CHANNELS || channels[channel].divider == 0)
+        return 0;
+
+    return ADC_TICK_RATE / channels[channel].divider;
+}
+
+/***************************************************************************//**
+ * @brief  Register a callback for new results of a channel
+ * @param  channel   ADC_CHANNEL_xxx
+ * @param  callback  Called in interrupt context with each new result
+ * @return 1 if registered (or already registered), 0 if no slot is free
+ ******************************************************************************/
+
+uint8_t Adc_subscribe(uint8_t channel, Adc_callback callback)
+{
+    uint8_t i;
+    Adc_callback *pSubscribers;
+
+    if (channel >= ADC_NUM_CHANNELS)
+        return 0;
+
+    pSubscribers = channels[channel].subscribers;
+    for (i = 0; i < ADC_MAX_SUBSCRIBERS; i++)
+    {
+        if (pSubscribers[i] == callback)
+            return 1;
+    }
+    for (i = 0; i < ADC_MAX_SUBSCRIBERS; i++)
+    {
+        if (pSubscribers[i] == 0)
+        {
+            pSubscribers[i] = callback;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/***************************************************************************//**
+ * @brief  Remove a callback registered with Adc_subscribe()
+ * @param  channel   ADC_CHANNEL_xxx
+ * @param  callback  Callback to remove
+ * @return none
+ ******************************************************************************/
+
+void Adc_unsubscribe(uint8_t channel, Adc_callback callback)
+{
+    uint8_t i;
+
+    if (channel >= ADC_NUM_CHANNELS)
+        return;
+
+    for (i = 0; i < ADC_MAX_SUBSCRIBERS; i++)
+    {
+        if (channels[channel].subscribers[i] == callback)
+            channels[channel].subscribers[i] = 0;
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Get the most recent result of a channel
+ * @param  channel  ADC_CHANNEL_xxx
+ * @return Averaged 12-bit result
+ ******************************************************************************/
+
+uint16_t Adc_getLatest(uint8_t channel)
+{
+    if (channel >= ADC_NUM_CHANNELS)
+        return 0;
+
+    return channels[channel].latest;
+}
+
+/***************************************************************************//**
+ * @brief  Copy the most recent results of a channel, newest first
+ * @param  channel  ADC_CHANNEL_xxx
+ * @param  pBuffer  Destination
+ * @param  count    Number of results wanted (at most ADC_HISTORY_SIZE)
+ * @return Number of results copied
+ ******************************************************************************/
+
+uint8_t Adc_getHistory(uint8_t channel, uint16_t *pBuffer, uint8_t count)
+{
+    uint8_t i;
+    uint8_t index;
+    uint16_t gie;
+
+    if (channel >= ADC_NUM_CHANNELS)
+        return 0;
+    if (count > ADC_HISTORY_SIZE)
+        count = ADC_HISTORY_SIZE;
+
+    gie = __get_SR_register() & GIE;
+    __disable_interrupt();
+    index = channels[channel].head;
+    for (i = 0; i < count; i++)
+    {
+        index = (index - 1) & (ADC_HISTORY_SIZE - 1);
+        pBuffer[i] = channels[channel].history[index];
+    }
+    __bis_SR_register(gie);
+
+    return count;
+}
+
+/***************************************************************************//**
+ * @brief  Convert the latest temperature sensor result
+ * @param  none
+ * @return Temperature in 0.1 degrees Celsius
+ ******************************************************************************/
+
+int16_t Adc_getTemperature(void)
+{
+    int32_t raw = Adc_getLatest(ADC_CHANNEL_TEMP);
+
+    // Linear interpolation between the 30 C and 85 C calibration points
+    return (int16_t)((raw - TLV_CAL_ADC_25T30) * (850 - 300) /
+                     ((int32_t)TLV_CAL_ADC_25T85 - TLV_CAL_ADC_25T30) + 300);
+}
+
+/***************************************************************************//**
+ * @brief  Convert the latest supply voltage result
+ * @param  none
+ * @return AVcc in millivolts
+ ******************************************************************************/
+
+uint16_t Adc_getSupplyVoltage(void)
+{
+    // Input is AVcc / 2 measured against the 2.5 V reference
+    return (uint32_t)Adc_getLatest(ADC_CHANNEL_VCC) * 2 * 2500 / 4096;
+}
+
+/***************************************************************************//**
+ * @brief  Power up the ADC and start the sequence trigger timer.
+ *         Must be called with interrupts disabled.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Adc_start(void)
+{
+    uint8_t i;
+    uint8_t needReference = 0;
+    volatile uint8_t *pMctl = &ADC12MCTL0;
+
+    for (i = 0; i < ADC_NUM_CHANNELS; i++)
+    {
+        if (channels[i].divider && channelConfig[i].usesReference)
+            needReference = 1;
+    }
+    if (needReference)
+        REFCTL0 = REFMSTR + REFVSEL_2 + REFON;  // 2.5 V reference
+
+    ADC12CTL0 = ADC12SHT0_2 + ADC12SHT1_7 + ADC12MSC + ADC12ON;
+
+    for (i = 0; i < ADC_NUM_CHANNELS; i++)
+    {
+        uint8_t slot = channelConfig[i].firstSlot;
+        uint8_t last = slot + (1 << channelConfig[i].shift);
+
+        for (; slot < last; slot++)
+            pMctl[slot] = channelConfig[i].control;
+    }
+
+    Adc_schedule();
+    Adc_program();
+
+    ADC_TIMER_CCR1 = ADC_TICK_PERIOD >> 1;
+    ADC_TIMER_CCTL1 = OUTMOD_3;                // Set/reset: rising edge at CCR1
+    ADC_TIMER_CTL = TASSEL_1 + MC_1 + TACLR;   // ACLK, up mode
+    running = 1;
+    ENERGY_SET_LOAD(ENERGY_ADC, ENERGY_FULL_LOAD);
+}
+
+/***************************************************************************//**
+ * @brief  Stop the trigger timer and power down the ADC and reference.
+ *         Must be called with interrupts disabled.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Adc_stop(void)
+{
+    if (!running)
+        return;
+
+    ADC_TIMER_CTL = 0;
+    ADC_TIMER_CCTL1 = 0;
+    ADC_DMA_CTL &= ~DMAEN;
+    ADC12CTL0 &= ~ADC12ENC;
+    ADC12CTL0 &= ~ADC12ON;
+    REFCTL0 &= ~REFON;
+    running = 0;
+    ENERGY_SET_LOAD(ENERGY_ADC, 0);
+}
+
+/***************************************************************************//**
+ * @brief  Advance to the next tick at which any channel is due, select the
+ *         due channels and stretch the timer period to reach that tick.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Adc_schedule(void)
+{
+    uint8_t i;
+    uint8_t ticks = 0xFF;
+
+    for (i = 0; i < ADC_NUM_CHANNELS; i++)
+    {
+        if (channels[i].divider && channels[i].countdown < ticks)
+            ticks = channels[i].countdown;
+    }
+
+    dueMask = 0;
+    for (i = 0; i < ADC_NUM_CHANNELS; i++)
+    {
+        if (channels[i].divider)
+        {
+            channels[i].countdown -= ticks;
+            if (channels[i].countdown == 0)
+            {
+                dueMask |= 1 << i;
+                channels[i].countdown = channels[i].divider;
+            }
+        }
+    }
+
+    // The first sequence runs one tick after Adc_start()
+    if (ticks == 0)
+        ticks = 1;
+    ADC_TIMER_CCR0 = (uint16_t)ticks * ADC_TICK_PERIOD - 1;
+}
+
+/***************************************************************************//**
+ * @brief  Program the conversion sequence and DMA transfer for dueMask.
+ *
+ *         The sequence spans the slots from the first to the last due channel;
+ *         slots of channels in between are converted but ignored.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Adc_program(void)
+{
+    uint8_t i;
+    uint8_t first = ADC_NUM_SLOTS;
+    uint8_t last = 0;
+    volatile uint8_t *pMctl = &ADC12MCTL0;
+
+    for (i = 0; i < ADC_NUM_CHANNELS; i++)
+    {
+        if (dueMask & (1 << i))
+        {
+            uint8_t end = channelConfig[i].firstSlot + (1 << channelConfig[i].shift);
+
+            if (channelConfig[i].firstSlot < first)
+                first = channelConfig[i].firstSlot;
+            if (end > last)
+                last = end;
+        }
+    }
+
+    ADC12CTL0 &= ~ADC12ENC;                    // Toggled between timer-triggered sequences
+    for (i = 0; i < ADC_NUM_SLOTS; i++)
+        pMctl[i] &= ~ADC12EOS;
+    pMctl[last - 1] |= ADC12EOS;
+    ADC12CTL1 = ((uint16_t)first << CSTARTADD_SHIFT) + ADC12SHS_1 + ADC12SHP + ADC12CONSEQ_1;
+
+    __data16_write_addr((unsigned short)&ADC_DMA_SA, (unsigned long)(&ADC12MEM0 + first));
+    __data16_write_addr((unsigned short)&ADC_DMA_DA, (unsigned long)&results[first]);
+    ADC_DMA_SZ = last - first;
+    ADC_DMA_CTL = DMADT_1 + DMASRCINCR_3 + DMADSTINCR_3 + DMAIE + DMAEN;
+
+    ADC12CTL0 |= ADC12ENC;
+}
+
+/***************************************************************************//**
+ * @brief  DMA completion handler - publishes the results of a sequence and
+ *         prepares the next one.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Adc_sequenceDone(void)
+{
+    uint8_t i, j;
+    uint8_t count;
+    uint16_t sum;
+    AdcChannel *pChannel;
+
+    for (i = 0; i < ADC_NUM_CHANNELS; i++)
+    {
+        if (!(dueMask & (1 << i)))
+            continue;
+
+        count = 1 << channelConfig[i].shift;
+        sum = 0;
+        for (j = 0; j < count; j++)
+            sum += results[channelConfig[i].firstSlot + j];
+
+        pChannel = &channels[i];
+        pChannel->latest = sum >> channelConfig[i].shift;
+        pChannel->history[pChannel->head] = pChannel->latest;
+        pChannel->head = (pChannel->head + 1) & (ADC_HISTORY_SIZE - 1);
+
+        for (j = 0; j < ADC_MAX_SUBSCRIBERS; j++)
+        {
+            if (pChannel->subscribers[j])
+                pChannel->subscribers[j](i, pChannel->latest);
+        }
+    }
+
+    Adc_schedule();
+    Adc_program();
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
@@ -0,0 +1,67 @@
+/*******************************************************************************
+ *
+ *  HAL_Adc.h
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef HAL_ADC_H
+#define HAL_ADC_H
+
+#include <stdint.h>
+
+#define ADC_CHANNEL_WHEEL        0     // A5, scroll wheel potentiometer
+#define ADC_CHANNEL_TEMP         1     // Internal temperature sensor
+#define ADC_CHANNEL_VCC          2     // (AVcc - AVss) / 2
+#define ADC_NUM_CHANNELS         3
+
+#define ADC_TICK_RATE            128   // Highest per-channel rate in Hz
+#define ADC_HISTORY_SIZE         8     // Results kept per channel
+#define ADC_MAX_SUBSCRIBERS      2     // Callbacks per channel
+
+// Called from interrupt context with each new (averaged) result of a channel
+typedef void (*Adc_callback)(uint8_t channel, uint16_t value);
+
+// Static RAM of the channel histories and results
+extern const uint16_t Adc_ramSize;
+
+extern void Adc_init(void);
+extern void Adc_setRate(uint8_t channel, uint16_t rateHz);
+extern uint16_t Adc_getRate(uint8_t channel);
+extern uint8_t Adc_subscribe(uint8_t channel, Adc_callback callback);
+extern void Adc_unsubscribe(uint8_t channel, Adc_callback callback);
+extern uint16_t Adc_getLatest(uint8_t channel);
+extern uint8_t Adc_getHistory(uint8_t channel, uint16_t *pBuffer, uint8_t count);
+extern int16_t Adc_getTemperature(void);
+extern uint16_t Adc_getSupplyVoltage(void);
+
+#endif /* HAL_ADC_H */
@@ -0,0 +1,216 @@
+/*******************************************************************************
+ *
+ *  HAL_AppFrame.c - COBS framed binary packets over the Application UART
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_AppFrame.c
+ * @addtogroup HAL_AppFrame
+ * @{
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_AppUart.h"
+#include "HAL_AppFrame.h"
+
+#define FRAME_DELIMITER     0x00
+#define COBS_MAX_CODE       0xFF       // Code byte of a full 254 byte block
+
+// Header and CRC bytes around the payload
+#define FRAME_OVERHEAD      4
+
+#if APPFRAME_MAX_PAYLOAD + FRAME_OVERHEAD + 3 > APPUART_TX_BUFFER_SIZE
+#error "APPFRAME_MAX_PAYLOAD frames do not fit the AppUart TX ring"
+#endif
+
+static uint8_t frameSequence = 0;
+static uint8_t payloadLeft = 0;
+
+// Position of the current COBS block's code byte in the TX ring, and the
+// code (1 + number of non-zero bytes in the block so far)
+static uint16_t codePosition;
+static uint8_t code;
+
+volatile uint16_t AppFrame_dropped = 0;
+
+// Forward declared functions
+static void AppFrame_encode(uint8_t data);
+static void AppFrame_encodeWithCrc(uint8_t data);
+
+/***************************************************************************//**
+ * @brief  COBS encode one byte straight into the TX ring.
+ *
+ *         Zero bytes close the current block: its code byte is patched in and
+ *         everything up to the next block's code byte is committed, so the
+ *         UART can start sending while the rest of the frame is encoded.
+ * @param  data  Raw frame byte
+ * @return none
+ ******************************************************************************/
+
+static void AppFrame_encode(uint8_t data)
+{
+    if (data != FRAME_DELIMITER)
+    {
+        AppUart_txStage(data);
+        code++;
+    }
+
+    if (data == FRAME_DELIMITER || code == COBS_MAX_CODE)
+    {
+        AppUart_txStagePatch(codePosition, code);
+        codePosition = AppUart_txStage(0);       // Placeholder for next code
+        code = 1;
+        AppUart_txStageCommit(codePosition);
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Feed one byte into the hardware CRC16 module and the encoder
+ * @param  data  Raw frame byte covered by the CRC
+ * @return none
+ ******************************************************************************/
+
+static void AppFrame_encodeWithCrc(uint8_t data)
+{
+    CRCDIRB_L = data;                           // Bit-reversed input yields
+                                                // standard CRC-CCITT
+    AppFrame_encode(data);
+}
+
+/***************************************************************************//**
+ * @brief  Start a frame
+ *
+ *         Room for the whole encoded frame is reserved up front, so a frame
+ *         is either sent completely or not at all. Exactly payloadSize bytes
+ *         must follow via AppFrame_putByte()/AppFrame_write() before
+ *         AppFrame_end().
+ * @param  type         Frame type (APPFRAME_TYPE_xxx)
+ * @param  payloadSize  Number of payload bytes (<= APPFRAME_MAX_PAYLOAD)
+ * @return 1 if the frame was started, 0 if it was dropped
+ ******************************************************************************/
+
+uint8_t AppFrame_begin(uint8_t type, uint8_t payloadSize)
+{
+    // Worst case: two code bytes (a full 254 byte block is followed by an
+    // empty one) plus the delimiter
+    if (payloadSize > APPFRAME_MAX_PAYLOAD ||
+        !AppUart_txStageBegin(payloadSize + FRAME_OVERHEAD + 3))
+    {
+        AppFrame_dropped++;
+        frameSequence++;                        // Let the host see the gap
+        return 0;
+    }
+
+    payloadLeft = payloadSize;
+    codePosition = AppUart_txStage(0);
+    code = 1;
+
+    CRCINIRES = 0xFFFF;
+    AppFrame_encodeWithCrc(type);
+    AppFrame_encodeWithCrc(frameSequence++);
+    return 1;
+}
+
+/***************************************************************************//**
+ * @brief  Append one payload byte to the current frame
+ * @param  data  Payload byte
+ * @return none
+ ******************************************************************************/
+
+void AppFrame_putByte(uint8_t data)
+{
+    if (payloadLeft)
+    {
+        payloadLeft--;
+        AppFrame_encodeWithCrc(data);
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Append payload bytes to the current frame
+ * @param  pData  Payload bytes
+ * @param  size   Number of payload bytes
+ * @return none
+ ******************************************************************************/
+
+void AppFrame_write(const uint8_t *pData, uint8_t size)
+{
+    while (size--)
+        AppFrame_putByte(*pData++);
+}
+
+/***************************************************************************//**
+ * @brief  Finish the current frame: append the CRC, close the last COBS block,
+ *         add the delimiter and commit the frame for transmission.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void AppFrame_end(void)
+{
+    uint16_t crc;
+
+    // Pad a short payload so the reserved size and the CRC stay consistent
+    while (payloadLeft)
+        AppFrame_putByte(0);
+
+    crc = CRCINIRES;
+    AppFrame_encode(crc >> 8);
+    AppFrame_encode(crc & 0xFF);
+
+    AppUart_txStagePatch(codePosition, code);
+    AppUart_txStage(FRAME_DELIMITER);
+    AppUart_txStageCommit(AppUart_txStageEnd());
+}
+
+/***************************************************************************//**
+ * @brief  Send a complete frame
+ * @param  type      Frame type (APPFRAME_TYPE_xxx)
+ * @param  pPayload  Payload bytes
+ * @param  size      Number of payload bytes (<= APPFRAME_MAX_PAYLOAD)
+ * @return 1 if the frame was queued, 0 if it was dropped
+ ******************************************************************************/
+
+uint8_t AppFrame_send(uint8_t type, const uint8_t *pPayload, uint8_t size)
+{
+    if (!AppFrame_begin(type, size))
+        return 0;
+
+    AppFrame_write(pPayload, size);
+    AppFrame_end();
+    return 1;
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
@@ -0,0 +1,72 @@
+/*******************************************************************************
+ *
+ *  HAL_AppFrame.h
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef HAL_APPFRAME_H
+#define HAL_APPFRAME_H
+
+#include <stdint.h>
+#include "HAL_AppUart.h"
+
+// Frame layout before COBS encoding (a 0x00 byte terminates each frame):
+//   type (1) | sequence (1) | payload (0..APPFRAME_MAX_PAYLOAD) | CRC16 (2, MSB first)
+// The CRC is CRC-CCITT (poly 0x1021, init 0xFFFF) over type, sequence and
+// payload. tools/appframe_decode.py is the matching host-side decoder.
+
+// Frames are staged in the AppUart TX ring, which must hold payload + 7 bytes
+// (header, CRC, two COBS code bytes, delimiter); at most 250 bytes keeps
+// every frame within one COBS block
+#if APPUART_TX_BUFFER_SIZE - 7 > 250
+#define APPFRAME_MAX_PAYLOAD    250
+#else
+#define APPFRAME_MAX_PAYLOAD    (APPUART_TX_BUFFER_SIZE - 7)
+#endif
+
+// Frame types
+#define APPFRAME_TYPE_TEXT      0x01   // Payload: ASCII text
+#define APPFRAME_TYPE_ACCEL     0x02   // Payload: n * (int8 x, int8 y, int8 z)
+#define APPFRAME_ACCEL_MAX_SAMPLES  (APPFRAME_MAX_PAYLOAD / 3)
+#define APPFRAME_TYPE_USER      0x80   // First application-defined type
+
+// Frames not sent because the TX ring had no room
+volatile extern uint16_t AppFrame_dropped;
+
+extern uint8_t AppFrame_begin(uint8_t type, uint8_t payloadSize);
+extern void AppFrame_putByte(uint8_t data);
+extern void AppFrame_write(const uint8_t *pData, uint8_t size);
+extern void AppFrame_end(void);
+extern uint8_t AppFrame_send(uint8_t type, const uint8_t *pPayload, uint8_t size);
+
+#endif /* HAL_APPFRAME_H */
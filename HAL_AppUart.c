@@ -42,8 +42,67 @@
 #include <stdint.h>
 #include "msp430.h"
 #include "HAL_UCS.h"
+#include "HAL_Dma.h"
 #include "HAL_AppUart.h"
 #include "HAL_Dogs102x6.h"
+#include "HAL_Energy.h"
+#include "HAL_Profile.h"
+#include "HAL_Stack.h"
+
+// DMA channel streaming blocks into UCA1TXBUF
+#define TX_DMA_CHANNEL      DMA_CHANNEL_0
+#define TX_DMA_CTL          DMA0CTL
+#define TX_DMA_SA           DMA0SA
+#define TX_DMA_DA           DMA0DA
+#define TX_DMA_SZ           DMA0SZ
+#define TX_DMA_TRIGGER      21         // UCA1TXIFG
+
+// Ring buffer index masks
+#define TX_MASK     (APPUART_TX_BUFFER_SIZE - 1)
+#define RX_MASK     (APPUART_RX_BUFFER_SIZE - 1)
+
+// TX ring: head advanced by the writer, tail by the USCI_A1 ISR
+static uint8_t txBuffer[APPUART_TX_BUFFER_SIZE];
+static volatile uint16_t txHead = 0;
+static volatile uint16_t txTail = 0;
+static volatile uint8_t txWaiting = 0;
+static volatile uint8_t txIdle = 1;         // Neither ring nor DMA sending
+static uint16_t txStageHead = 0;            // End of staged, uncommitted bytes
+
+// RX ring: head advanced by the USCI_A1 ISR, tail by the reader
+static uint8_t rxBuffer[APPUART_RX_BUFFER_SIZE];
+static volatile uint16_t rxHead = 0;
+static volatile uint16_t rxTail = 0;
+
+const uint16_t AppUart_ramSize = sizeof(txBuffer) + sizeof(rxBuffer);
+
+// Bytes rejected because the TX ring was full
+volatile uint16_t AppUart_txOverflows = 0;
+
+// Bytes lost because the RX ring was full or the USCI overran
+volatile uint16_t AppUart_rxOverflows = 0;
+
+// Block transmission by DMA: the active block and one pending block
+static const uint8_t *volatile blockActive = 0;
+static const uint8_t *volatile blockPending = 0;
+static volatile uint16_t blockPendingSize = 0;
+static AppUart_blockCallback blockCallback = 0;
+static AppUart_rxCallback rxCallback = 0;
+
+// Achieved baud rate and its error in 0.01 %
+static uint32_t uartBaudRate = 0;
+static int16_t uartBaudError = 0;
+
+// Last successful configuration, reapplied after clock profile changes
+static uint8_t uartClockSource = APPUART_CLOCK_ACLK;
+static uint32_t uartRequestedBaud = APPUART_DEFAULT_BAUD;
+
+// Forward declared functions
+static uint8_t AppUart_txPut(uint8_t transmitChar);
+static void AppUart_txStart(void);
+static void AppUart_startBlock(const uint8_t *pBuffer, uint16_t size);
+static void AppUart_blockDone(void);
+static void AppUart_clockChanged(void);
 
 /***************************************************************************//**
  * @brief   Initialize the Application UART
@@ -55,18 +114,138 @@ void AppUart_init(void)
 {
     SELECT_ACLK(SELA__XT1CLK);              // Source ACLK from LFXT1
 
-    P4SEL = BIT5 + BIT4;                    // P4.4,5 = USCI_A1 TXD/RXD
+    P4SEL |= BIT5 + BIT4;                   // P4.4,5 = USCI_A1 TXD/RXD, keep
+                                            // P4.1,3 for the USCI_B1 SPI bus
     UCA1CTL1 |= UCSWRST;                    // **Put state machine in reset**
     UCA1CTL0 = 0x00;
-    UCA1CTL1 = UCSSEL_1 + UCSWRST;          // Use ACLK, keep RESET
-    UCA1BR0 = 0x03;                         // 32kHz/9600=3.41 (see User's Guide)
-    UCA1BR1 = 0x00;                         //
-    UCA1MCTL = UCBRS_3 + UCBRF_0;           // Modulation UCBRSx=3, UCBRFx=0
+
+    txHead = txTail = 0;                    // Empty both rings
+    rxHead = rxTail = 0;
+
+    AppUart_configure(APPUART_CLOCK_ACLK, APPUART_DEFAULT_BAUD);
+    UCS_addClockCallback(AppUart_clockChanged);
+}
+
+/***************************************************************************//**
+ * @brief   Recompute the baud rate divider after a clock profile change
+ * @param   None
+ * @return  None
+ ******************************************************************************/
+
+static void AppUart_clockChanged(void)
+{
+    if (uartClockSource == APPUART_CLOCK_SMCLK)
+        AppUart_configure(uartClockSource, uartRequestedBaud);
+}
+
+/***************************************************************************//**
+ * @brief   Set the Application UART's clock source and baud rate
+ *
+ *          The divisors are computed from the live UCS settings: oversampling
+ *          mode (UCOS16, UCBRx, UCBRFx) when the clock is at least 16 times
+ *          the baud rate, low-frequency mode (UCBRx, UCBRSx) otherwise.
+ *          Bytes still queued in the TX ring are sent with the new setting.
+ * @param   clockSource  APPUART_CLOCK_ACLK or APPUART_CLOCK_SMCLK
+ * @param   baudRate     Requested baud rate, e.g. 9600 ... 460800
+ * @return  APPUART_CONFIG_OK, or APPUART_CONFIG_ERR_RANGE if the clock is
+ *          less than 3 times the baud rate (setting left unchanged)
+ ******************************************************************************/
+
+uint8_t AppUart_configure(uint8_t clockSource, uint32_t baudRate)
+{
+    uint32_t clock;
+    uint32_t remainder;
+    uint16_t divider;
+    uint8_t modulation;
+    uint16_t clocksPerBit8;                 // Clocks per bit * 8 (low-freq)
+
+    if (clockSource == APPUART_CLOCK_SMCLK)
+        clock = UCS_getSmclkFrequency();
+    else
+        clock = UCS_getAclkFrequency();
+
+    if (baudRate == 0 || clock < 3 * baudRate)
+        return APPUART_CONFIG_ERR_RANGE;
+
+    if (clock >= 16 * baudRate)
+    {
+        // N = clock / baud; UCBRx = INT(N / 16), UCBRFx = round(frac(N / 16) * 16)
+        divider = clock / (16 * baudRate);
+        remainder = clock - 16 * baudRate * divider;
+        modulation = (remainder + baudRate / 2) / baudRate;
+        if (modulation == 16)
+        {
+            divider++;
+            modulation = 0;
+        }
+        uartBaudRate = clock / (16UL * divider + modulation);
+        modulation = (modulation << 4) | UCOS16;
+    }
+    else
+    {
+        // UCBRx = INT(N), UCBRSx = round(frac(N) * 8)
+        divider = clock / baudRate;
+        remainder = clock - baudRate * divider;
+        modulation = (8 * remainder + baudRate / 2) / baudRate;
+        if (modulation == 8)
+        {
+            divider++;
+            modulation = 0;
+        }
+        clocksPerBit8 = 8 * divider + modulation;
+        uartBaudRate = 8 * clock / clocksPerBit8;
+        modulation <<= 1;
+    }
+
+    // Relative error of the achieved baud rate in 0.01 %
+    uartBaudError = (int16_t)(((int32_t)(uartBaudRate - baudRate) * 10000) / (int32_t)baudRate);
+
+    uartClockSource = clockSource;
+    uartRequestedBaud = baudRate;
+
+    while (UCA1STAT & UCBUSY) ;             // Let the current byte finish
+
+    UCA1CTL1 |= UCSWRST;                    // **Put state machine in reset**
+    UCA1CTL1 = clockSource + UCSWRST;       // Select clock, keep RESET
+    UCA1BR0 = divider & 0xFF;
+    UCA1BR1 = divider >> 8;
+    UCA1MCTL = modulation;
     UCA1CTL1 &= ~UCSWRST;                   // **Initialize USCI state machine**
+
+    // Reset cleared the interrupt enables
+    UCA1IE |= UCRXIE;
+    if (!txIdle && !blockActive)
+        UCA1IE |= UCTXIE;                   // Reset set UCTXIFG again
+
+    return APPUART_CONFIG_OK;
+}
+
+/***************************************************************************//**
+ * @brief   Get the baud rate achieved by the last AppUart_configure()
+ * @param   None
+ * @return  Actual baud rate
+ ******************************************************************************/
+
+uint32_t AppUart_getBaudRate(void)
+{
+    return uartBaudRate;
+}
+
+/***************************************************************************//**
+ * @brief   Get the baud rate error of the last AppUart_configure()
+ * @param   None
+ * @return  (actual - requested) / requested in units of 0.01 %
+ ******************************************************************************/
+
+int16_t AppUart_getBaudError(void)
+{
+    return uartBaudError;
 }
 
 /***************************************************************************//**
  * @brief   Receive a character via Application UART
+ *
+ *          Sleeps in LPM0 until a character has been received.
  * @param   None
  * @return  received character
  ******************************************************************************/
@@ -75,20 +254,452 @@ uint8_t AppUart_getChar(void)
 {
     uint8_t receiveChar;
 
-    while (!(UCA1IFG & UCRXIFG)) ;
-    receiveChar = UCA1RXBUF;
+    while (!AppUart_read(&receiveChar, 1))
+    {
+        __disable_interrupt();
+        if (rxHead == rxTail)
+            ENERGY_SLEEP(LPM0_bits);                // USCI_A1 RX ISR will force exit
+        __enable_interrupt();
+    }
     return receiveChar;
 }
 
 /***************************************************************************//**
  * @brief   Transmit a character via Application UART
+ *
+ *          Queues the character; sleeps in LPM0 only while the TX ring is full.
  * @param   transmitChar  Character to be transmitted
  * @return  None
  ******************************************************************************/
 
 void AppUart_putChar(uint8_t transmitChar)
 {
-    while (!(UCA1IFG & UCTXIFG)) ;
-    UCA1TXBUF = transmitChar;
+    while (!AppUart_txPut(transmitChar))
+    {
+        __disable_interrupt();
+        if ((uint16_t)(txHead - txTail) == APPUART_TX_BUFFER_SIZE)
+        {
+            txWaiting = 1;
+            ENERGY_SLEEP(LPM0_bits);                // USCI_A1 TX ISR will force exit
+        }
+        __enable_interrupt();
+    }
+}
+
+/***************************************************************************//**
+ * @brief   Queue one character in the TX ring and start transmission
+ * @param   transmitChar  Character to be transmitted
+ * @return  1 if queued, 0 if the TX ring is full
+ ******************************************************************************/
+
+static uint8_t AppUart_txPut(uint8_t transmitChar)
+{
+    uint16_t head = txHead;
+
+    if ((uint16_t)(head - txTail) == APPUART_TX_BUFFER_SIZE)
+        return 0;
+
+    txBuffer[head & TX_MASK] = transmitChar;
+    txHead = head + 1;
+    AppUart_txStart();
+    return 1;
+}
+
+/***************************************************************************//**
+ * @brief   Let the USCI_A1 TX ISR drain the TX ring
+ *
+ *          Reading UCA1IV in the ISR clears UCTXIFG, and once the ring has
+ *          drained no byte is written that would set it again. Enabling UCTXIE
+ *          alone then never interrupts, so the flag is raised by hand; TXBUF is
+ *          empty at that point. While a block is active the DMA completion
+ *          handler restarts the ring instead.
+ * @param   None
+ * @return  None
+ ******************************************************************************/
+
+static void AppUart_txStart(void)
+{
+    uint16_t gie = __get_SR_register() & GIE;   // Store current GIE state
+
+    __disable_interrupt();                      // txIdle is shared with the ISR
+
+    if (!blockActive)
+    {
+        if (txIdle)
+        {
+            txIdle = 0;
+            UCA1IFG |= UCTXIFG;
+        }
+        UCA1IE |= UCTXIE;
+    }
+
+    __bis_SR_register(gie);                     // Restore original GIE state
+}
+
+/***************************************************************************//**
+ * @brief   Queue bytes for transmission without blocking
+ * @param   pBuffer  Bytes to be transmitted
+ * @param   size     Number of bytes to be transmitted
+ * @return  Number of bytes queued; the rest is counted in AppUart_txOverflows
+ ******************************************************************************/
+
+uint16_t AppUart_write(const uint8_t *pBuffer, uint16_t size)
+{
+    uint16_t head = txHead;
+    uint16_t space = APPUART_TX_BUFFER_SIZE - (uint16_t)(head - txTail);
+    uint16_t count;
+
+    if (size > space)
+    {
+        AppUart_txOverflows += size - space;
+        size = space;
+    }
+
+    for (count = 0; count < size; count++)
+    {
+        txBuffer[head++ & TX_MASK] = *pBuffer++;
+    }
+
+    if (size)
+    {
+        txHead = head;
+        AppUart_txStart();
+    }
+
+    return size;
+}
+
+/***************************************************************************//**
+ * @brief   Fetch received bytes without blocking
+ * @param   pBuffer  Place to store the received bytes
+ * @param   size     Maximum number of bytes to fetch
+ * @return  Number of bytes fetched
+ ******************************************************************************/
+
+uint16_t AppUart_read(uint8_t *pBuffer, uint16_t size)
+{
+    uint16_t tail = rxTail;
+    uint16_t available = (uint16_t)(rxHead - tail);
+    uint16_t count;
+
+    if (size > available)
+        size = available;
+
+    for (count = 0; count < size; count++)
+    {
+        *pBuffer++ = rxBuffer[tail++ & RX_MASK];
+    }
+
+    rxTail = tail;
+    return size;
+}
+
+/***************************************************************************//**
+ * @brief   Get the number of received bytes waiting in the RX ring
+ * @param   None
+ * @return  Number of bytes available to AppUart_read()
+ ******************************************************************************/
+
+uint16_t AppUart_rxAvailable(void)
+{
+    return (uint16_t)(rxHead - rxTail);
+}
+
+/***************************************************************************//**
+ * @brief   Get the free space in the TX ring
+ * @param   None
+ * @return  Number of bytes AppUart_write() accepts without overflowing
+ ******************************************************************************/
+
+uint16_t AppUart_txFree(void)
+{
+    return APPUART_TX_BUFFER_SIZE - (uint16_t)(txHead - txTail);
 }
 
+/***************************************************************************//**
+ * @brief   Start staging bytes in the TX ring
+ *
+ *          Staged bytes are not transmitted until committed and can be patched
+ *          in place, which lets encoders fill in length fields after the fact
+ *          without building the message in RAM first. Other writers must not
+ *          use the TX ring until the staged bytes are committed.
+ * @param   size  Number of bytes that will be staged
+ * @return  1 if the TX ring has room for size bytes, 0 otherwise
+ ******************************************************************************/
+
+uint8_t AppUart_txStageBegin(uint16_t size)
+{
+    txStageHead = txHead;
+    return AppUart_txFree() >= size;
+}
+
+/***************************************************************************//**
+ * @brief   Stage one byte behind the previously staged ones
+ * @param   data  Byte to be staged
+ * @return  Ring position of the byte, for AppUart_txStagePatch()
+ ******************************************************************************/
+
+uint16_t AppUart_txStage(uint8_t data)
+{
+    uint16_t position = txStageHead++;
+
+    txBuffer[position & TX_MASK] = data;
+    return position;
+}
+
+/***************************************************************************//**
+ * @brief   Overwrite a staged byte that has not been committed yet
+ * @param   position  Ring position returned by AppUart_txStage()
+ * @param   data      New value
+ * @return  None
+ ******************************************************************************/
+
+void AppUart_txStagePatch(uint16_t position, uint8_t data)
+{
+    txBuffer[position & TX_MASK] = data;
+}
+
+/***************************************************************************//**
+ * @brief   Release staged bytes for transmission
+ * @param   position  Ring position up to (excluding) which bytes are final;
+ *                    bytes from there on remain staged
+ * @return  None
+ ******************************************************************************/
+
+void AppUart_txStageCommit(uint16_t position)
+{
+    if (position != txHead)
+    {
+        txHead = position;
+        AppUart_txStart();
+    }
+}
+
+/***************************************************************************//**
+ * @brief   Get the ring position following the last staged byte
+ * @param   None
+ * @return  Ring position, for AppUart_txStageCommit()
+ ******************************************************************************/
+
+uint16_t AppUart_txStageEnd(void)
+{
+    return txStageHead;
+}
+
+/***************************************************************************//**
+ * @brief   Register the handler called when a block has been handed to the UART
+ * @param   callback  Called in interrupt context with the finished block's
+ *                    buffer, which may then be reused; 0 for none
+ * @return  None
+ ******************************************************************************/
+
+void AppUart_setBlockCallback(AppUart_blockCallback callback)
+{
+    blockCallback = callback;
+}
+
+/***************************************************************************//**
+ * @brief   Register the handler called when a character has been received
+ * @param   callback  Called in interrupt context after the character was
+ *                    queued; 0 for none
+ * @return  None
+ ******************************************************************************/
+
+void AppUart_setRxCallback(AppUart_rxCallback callback)
+{
+    rxCallback = callback;
+}
+
+/***************************************************************************//**
+ * @brief   Queue a block for DMA transmission
+ *
+ *          Two blocks can be queued, so the next one can be prepared while the
+ *          current one is on the wire. A block starts once the TX ring has
+ *          drained; bytes queued in the ring while a block is active are sent
+ *          after it, ahead of the pending block. The buffer must stay untouched
+ *          until the block callback reports it done.
+ * @param   pBuffer  Bytes to be transmitted
+ * @param   size     Number of bytes to be transmitted (> 0)
+ * @return  1 if queued, 0 if both block slots are busy
+ ******************************************************************************/
+
+uint8_t AppUart_sendBlock(const uint8_t *pBuffer, uint16_t size)
+{
+    uint16_t gie = __get_SR_register() & GIE;   // Store current GIE state
+    uint8_t queued = 1;
+
+    if (size == 0)
+        return 1;
+
+    __disable_interrupt();                      // Slots are shared with the ISRs
+
+    if (blockPending)
+    {
+        queued = 0;
+    }
+    else if (!txIdle)
+    {
+        // DMA or ring busy: start from the TX ISR once the ring has drained
+        blockPending = pBuffer;
+        blockPendingSize = size;
+    }
+    else
+    {
+        txIdle = 0;
+        blockActive = pBuffer;
+        AppUart_startBlock(pBuffer, size);
+    }
+
+    __bis_SR_register(gie);                     // Restore original GIE state
+
+    return queued;
+}
+
+/***************************************************************************//**
+ * @brief   Get the number of free block slots
+ * @param   None
+ * @return  0, 1 or 2
+ ******************************************************************************/
+
+uint8_t AppUart_blockSlotsFree(void)
+{
+    // Only the pending slot can take a block while the transmitter is busy
+    if (blockPending)
+        return 0;
+    return txIdle ? 2 : 1;
+}
+
+/***************************************************************************//**
+ * @brief   Start streaming a block into UCA1TXBUF
+ *
+ *          Only called while the transmitter is idle or from the TX ISR after
+ *          the ring drained, so TXBUF is always empty here.
+ * @param   pBuffer  Bytes to be transmitted
+ * @param   size     Number of bytes to be transmitted
+ * @return  None
+ ******************************************************************************/
+
+static void AppUart_startBlock(const uint8_t *pBuffer, uint16_t size)
+{
+    Dma_setTrigger(TX_DMA_CHANNEL, TX_DMA_TRIGGER);
+    Dma_setCallback(TX_DMA_CHANNEL, AppUart_blockDone);
+
+    __data16_write_addr((unsigned short)&TX_DMA_SA, (unsigned long)pBuffer);
+    __data16_write_addr((unsigned short)&TX_DMA_DA, (unsigned long)&UCA1TXBUF);
+    TX_DMA_SZ = size;
+
+    // Single transfers, byte to byte, source incremented
+    TX_DMA_CTL = DMADT_0 + DMASRCINCR_3 + DMADSTINCR_0 + DMASRCBYTE + DMADSTBYTE +
+                 DMAIE + DMAEN;
+
+    // The trigger is edge sensitive and UCTXIFG is either still set or was
+    // consumed by the TX ISR; toggle it to start the first transfer
+    UCA1IFG &= ~UCTXIFG;
+    UCA1IFG |= UCTXIFG;
+}
+
+/***************************************************************************//**
+ * @brief   DMA completion handler - returns the transmitter to the TX ISR.
+ *
+ *          The last byte of the block may still sit in TXBUF, so the pending
+ *          block is not chained from here. UCTXIFG rises once that byte has
+ *          moved on; the TX ISR then drains the ring and starts the pending
+ *          block from a known empty TXBUF.
+ * @param   None
+ * @return  None
+ ******************************************************************************/
+
+static void AppUart_blockDone(void)
+{
+    const uint8_t *done = blockActive;
+
+    blockActive = 0;
+    UCA1IE |= UCTXIE;
+
+    if (blockCallback)
+        blockCallback(done);
+}
+
+/***************************************************************************//**
+ * @brief  Handles USCI_A1 interrupts - moves bytes between the UART and the
+ *         TX/RX rings.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+#pragma vector = USCI_A1_VECTOR
+__interrupt void AppUart_ISR(void)
+{
+    uint16_t index;
+    uint8_t receiveChar;
+
+    STACK_ISR_SAMPLE(STACK_ISR_APPUART);
+    PROFILE_ENTER(PROFILE_ISR_UART);
+
+    switch (__even_in_range(UCA1IV, USCI_UCTXIFG))
+    {
+        // Vector USCI_NONE: No interrupt
+        case USCI_NONE:
+            break;
+
+        // Vector USCI_UCRXIFG: Data received
+        case USCI_UCRXIFG:
+            if (UCA1STAT & UCOE)                   // Previous byte was overwritten
+                AppUart_rxOverflows++;
+
+            receiveChar = UCA1RXBUF;               // Clears UCRXIFG and UCOE
+            index = rxHead;
+            if ((uint16_t)(index - rxTail) == APPUART_RX_BUFFER_SIZE)
+            {
+                AppUart_rxOverflows++;
+            }
+            else
+            {
+                rxBuffer[index & RX_MASK] = receiveChar;
+                rxHead = index + 1;
+            }
+            if (rxCallback)
+                rxCallback();
+            __bic_SR_register_on_exit(LPM3_bits);  // Wake up the reader
+            break;
+
+        // Vector USCI_UCTXIFG: TX buffer empty
+        case USCI_UCTXIFG:
+            index = txTail;
+            if (index != txHead)
+            {
+                UCA1TXBUF = txBuffer[index & TX_MASK];
+                txTail = index + 1;
+            }
+            else
+            {
+                UCA1IE &= ~UCTXIE;                 // Ring drained
+                if (blockPending)                  // Hand over to the DMA
+                {
+                    blockActive = blockPending;
+                    blockPending = 0;
+                    AppUart_startBlock(blockActive, blockPendingSize);
+                }
+                else
+                {
+                    txIdle = 1;                    // Next producer raises UCTXIFG
+                }
+            }
+
+            if (txWaiting)
+            {
+                txWaiting = 0;
+                __bic_SR_register_on_exit(LPM3_bits);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    PROFILE_EXIT(PROFILE_ISR_UART);
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
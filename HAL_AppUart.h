@@ -39,9 +39,59 @@
 
 #include <stdint.h>
 
+// Clock sources for AppUart_configure
+#define APPUART_CLOCK_ACLK      0x40   // UCSSEL_1
+#define APPUART_CLOCK_SMCLK     0x80   // UCSSEL_2
+
+// AppUart_configure status
+#define APPUART_CONFIG_OK       0x00
+#define APPUART_CONFIG_ERR_RANGE 0x01
+
+// Baud rate set up by AppUart_init
+#define APPUART_DEFAULT_BAUD    9600
+
+// Ring buffer sizes, must be powers of two
+#ifndef APPUART_TX_BUFFER_SIZE
+#define APPUART_TX_BUFFER_SIZE  64
+#endif
+#ifndef APPUART_RX_BUFFER_SIZE
+#define APPUART_RX_BUFFER_SIZE  32
+#endif
+
+#if (APPUART_TX_BUFFER_SIZE & (APPUART_TX_BUFFER_SIZE - 1)) || \
+    (APPUART_RX_BUFFER_SIZE & (APPUART_RX_BUFFER_SIZE - 1))
+#error "AppUart ring buffer sizes must be powers of two"
+#endif
+
+// Called from interrupt context when a DMA block's buffer is free again
+typedef void (*AppUart_blockCallback)(const uint8_t *pBuffer);
+
+// Called from interrupt context after a received character was queued
+typedef void (*AppUart_rxCallback)(void);
+
+volatile extern uint16_t AppUart_txOverflows;
+volatile extern uint16_t AppUart_rxOverflows;
+extern const uint16_t AppUart_ramSize;     // Both rings
+
 extern void AppUart_init(void);
+extern uint8_t AppUart_configure(uint8_t clockSource, uint32_t baudRate);
+extern uint32_t AppUart_getBaudRate(void);
+extern int16_t AppUart_getBaudError(void);
 extern uint8_t AppUart_getChar(void);
 extern void AppUart_putChar(uint8_t transmitChar);
+extern uint16_t AppUart_write(const uint8_t *pBuffer, uint16_t size);
+extern uint16_t AppUart_read(uint8_t *pBuffer, uint16_t size);
+extern uint16_t AppUart_rxAvailable(void);
+extern uint16_t AppUart_txFree(void);
+extern uint8_t AppUart_txStageBegin(uint16_t size);
+extern uint16_t AppUart_txStage(uint8_t data);
+extern void AppUart_txStagePatch(uint16_t position, uint8_t data);
+extern void AppUart_txStageCommit(uint16_t position);
+extern uint16_t AppUart_txStageEnd(void);
+extern void AppUart_setBlockCallback(AppUart_blockCallback callback);
+extern uint8_t AppUart_sendBlock(const uint8_t *pBuffer, uint16_t size);
+extern uint8_t AppUart_blockSlotsFree(void);
+extern void AppUart_setRxCallback(AppUart_rxCallback callback);
 
 #endif /* HAL_APPUART_H */
 
@@ -0,0 +1,222 @@
+/*******************************************************************************
+ *
+ *  HAL_BusTrace.c - SPI bus transaction trace
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_BusTrace.c
+ * @addtogroup HAL_BusTrace
+ * @{
+ *
+ * Ring of the most recent SPI transactions on UCB1 (LCD, SD card) and UCA0
+ * (accelerometer) for post-mortem analysis of bus load and idle gaps.
+ *
+ * Each entry holds the ACLK tick and SMCLK cycle count at the start of the
+ * transfer and its duration in cycles. The cycle counter stops in LPM3,
+ * so a host placing entries on a timeline uses the cycle delta between two
+ * entries while it agrees with the tick delta and falls back to the ticks
+ * across sleep. Cycles are SMCLK at the time of the transaction; reset the
+ * trace after changing the clock profile.
+ *
+ * The ring overwrites the oldest entries; stop it with BusTrace_setRunning()
+ * right after the event of interest to keep the history leading up to it.
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_Cycles.h"
+#include "HAL_Timer.h"
+#include "HAL_BusTrace.h"
+
+#if (BUSTRACE_DEPTH & (BUSTRACE_DEPTH - 1)) || BUSTRACE_DEPTH > 128
+#error BUSTRACE_DEPTH must be a power of two up to 128
+#endif
+
+static BusTraceEntry ring[BUSTRACE_DEPTH];
+const uint16_t BusTrace_ramSize = sizeof(ring);
+static uint32_t total;                 // Entries ever recorded, next slot is total % depth
+static uint8_t running = 1;
+
+static const char * const deviceNames[BUSTRACE_NUM_DEVICES] = {
+    "lcd",
+    "sd",
+    "accel",
+};
+
+static const char * const busNames[BUSTRACE_NUM_DEVICES] = {
+    "ucb1",
+    "ucb1",
+    "uca0",
+};
+
+/***************************************************************************//**
+ * @brief  Stamp the start of a transaction, call before the first byte
+ * @param  pTrace     Caller's entry, completed by BusTrace_end()
+ * @param  device     BUSTRACE_LCD, BUSTRACE_SD or BUSTRACE_ACCEL
+ * @param  direction  BUSTRACE_TX or BUSTRACE_RX
+ * @param  bytes      Bytes transferred
+ * @return none
+ ******************************************************************************/
+
+void BusTrace_begin(BusTraceEntry *pTrace, uint8_t device, uint8_t direction, uint16_t bytes)
+{
+    pTrace->device = device;
+    pTrace->direction = direction;
+    pTrace->bytes = bytes;
+    pTrace->tick = Timer_now();
+    pTrace->start = Cycles_now();
+}
+
+/***************************************************************************//**
+ * @brief  Store a transaction in the ring, call after the last byte
+ * @param  pTrace  Entry started with BusTrace_begin()
+ * @return none
+ ******************************************************************************/
+
+void BusTrace_end(BusTraceEntry *pTrace)
+{
+    uint16_t gie = __get_SR_register() & GIE;   // Store current GIE state
+
+    pTrace->cycles = Cycles_now() - pTrace->start;
+
+    __disable_interrupt();
+    if (running)
+    {
+        ring[(uint8_t)total & (BUSTRACE_DEPTH - 1)] = *pTrace;
+        total++;
+    }
+    __bis_SR_register(gie);                     // Restore original GIE state
+}
+
+/***************************************************************************//**
+ * @brief  Discard all entries
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void BusTrace_reset(void)
+{
+    uint16_t gie = __get_SR_register() & GIE;   // Store current GIE state
+
+    __disable_interrupt();
+    total = 0;
+    __bis_SR_register(gie);                     // Restore original GIE state
+}
+
+/***************************************************************************//**
+ * @brief  Start or stop recording, the entries are kept
+ * @param  run  0 to stop, otherwise start
+ * @return Previous state
+ ******************************************************************************/
+
+uint8_t BusTrace_setRunning(uint8_t run)
+{
+    uint8_t previous = running;
+
+    running = run ? 1 : 0;
+
+    return previous;
+}
+
+/***************************************************************************//**
+ * @brief  Get the number of transactions recorded since the last reset
+ * @param  none
+ * @return Transactions, including those overwritten
+ ******************************************************************************/
+
+uint32_t BusTrace_getTotal(void)
+{
+    uint16_t gie = __get_SR_register() & GIE;   // Store current GIE state
+    uint32_t count;
+
+    __disable_interrupt();
+    count = total;
+    __bis_SR_register(gie);                     // Restore original GIE state
+
+    return count;
+}
+
+/***************************************************************************//**
+ * @brief  Get the number of entries held in the ring
+ * @param  none
+ * @return Entries, at most BUSTRACE_DEPTH
+ ******************************************************************************/
+
+uint8_t BusTrace_getCount(void)
+{
+    uint32_t count = BusTrace_getTotal();
+
+    return count < BUSTRACE_DEPTH ? count : BUSTRACE_DEPTH;
+}
+
+/***************************************************************************//**
+ * @brief  Get an entry, stop the trace while reading entries
+ * @param  index  0 for the oldest, BusTrace_getCount() - 1 for the newest
+ * @return Entry, or 0 if index is out of range
+ ******************************************************************************/
+
+const BusTraceEntry *BusTrace_getEntry(uint8_t index)
+{
+    uint32_t count = BusTrace_getTotal();
+    uint8_t held = count < BUSTRACE_DEPTH ? count : BUSTRACE_DEPTH;
+
+    if (index >= held)
+        return 0;
+
+    return &ring[(uint8_t)(count - held + index) & (BUSTRACE_DEPTH - 1)];
+}
+
+/***************************************************************************//**
+ * @brief  Get the name of a device
+ * @param  device  BUSTRACE_LCD, BUSTRACE_SD or BUSTRACE_ACCEL
+ * @return Name, "?" if unknown
+ ******************************************************************************/
+
+const char *BusTrace_getDeviceName(uint8_t device)
+{
+    return device < BUSTRACE_NUM_DEVICES ? deviceNames[device] : "?";
+}
+
+/***************************************************************************//**
+ * @brief  Get the name of the bus a device is on
+ * @param  device  BUSTRACE_LCD, BUSTRACE_SD or BUSTRACE_ACCEL
+ * @return Name, "?" if unknown
+ ******************************************************************************/
+
+const char *BusTrace_getBusName(uint8_t device)
+{
+    return device < BUSTRACE_NUM_DEVICES ? busNames[device] : "?";
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
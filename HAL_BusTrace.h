@@ -0,0 +1,95 @@
+/*******************************************************************************
+ *
+ *  HAL_BusTrace.h
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef HAL_BUSTRACE_H
+#define HAL_BUSTRACE_H
+
+#include <stdint.h>
+
+// Set to 0 to compile the SPI bus trace out
+#ifndef BUSTRACE_ENABLED
+#define BUSTRACE_ENABLED        1
+#endif
+
+#define BUSTRACE_DEPTH          32     // Entries, power of two
+
+// Devices and the bus they sit on
+#define BUSTRACE_LCD            0      // UCB1
+#define BUSTRACE_SD             1      // UCB1
+#define BUSTRACE_ACCEL          2      // UCA0
+#define BUSTRACE_NUM_DEVICES    3
+
+#define BUSTRACE_TX             0
+#define BUSTRACE_RX             1
+
+#define BUSTRACE_COLUMNS        "seq device bus dir bytes tick start cycles"
+
+typedef struct
+{
+    uint32_t tick;                     // Timer_now() at the start, keeps counting in LPM3
+    uint32_t start;                    // Cycles_now() at the start
+    uint32_t cycles;                   // Duration of the transfer
+    uint16_t bytes;
+    uint8_t device;
+    uint8_t direction;
+} BusTraceEntry;
+
+#if BUSTRACE_ENABLED
+// Bracket the transfer loop of a transaction; trace is a local BusTraceEntry
+#define BUSTRACE_DECLARE(trace)                     BusTraceEntry trace
+#define BUSTRACE_BEGIN(trace, device, direction, bytes) \
+    BusTrace_begin(&(trace), (device), (direction), (bytes))
+#define BUSTRACE_END(trace)                         BusTrace_end(&(trace))
+#else
+#define BUSTRACE_DECLARE(trace)
+#define BUSTRACE_BEGIN(trace, device, direction, bytes)
+#define BUSTRACE_END(trace)
+#endif
+
+// Static RAM of the trace ring
+extern const uint16_t BusTrace_ramSize;
+
+extern void BusTrace_begin(BusTraceEntry *pTrace, uint8_t device, uint8_t direction, uint16_t bytes);
+extern void BusTrace_end(BusTraceEntry *pTrace);
+extern void BusTrace_reset(void);
+extern uint8_t BusTrace_setRunning(uint8_t running);
+extern uint32_t BusTrace_getTotal(void);
+extern uint8_t BusTrace_getCount(void);
+extern const BusTraceEntry *BusTrace_getEntry(uint8_t index);
+extern const char *BusTrace_getDeviceName(uint8_t device);
+extern const char *BusTrace_getBusName(uint8_t device);
+
+#endif /* HAL_BUSTRACE_H */
@@ -42,7 +42,11 @@
 #include "msp430.h"
 #include "HAL_Board.h"
 #include "HAL_Buttons.h"
-#include "HAL_Cma3000.h"
+#include "HAL_EventLatency.h"
+#include "HAL_Profile.h"
+#include "HAL_Stack.h"
+#include "HAL_Timer.h"
+#include "HAL_Work.h"
 
 #define BUTTON_PORT_DIR   PADIR
 #define BUTTON_PORT_OUT   PAOUT
@@ -57,14 +61,50 @@
 #define BUTTON1_IFG       P1IFG      //P1.7
 #define BUTTON2_IFG       P2IFG      //P1.7
 
-volatile uint8_t buttonDebounce = 1;
+#define BUTTON_SAMPLE_MS  2
+#define BUTTON_COUNT      2
+#define BUTTON1_INDEX     0          // S1 in buttonMasks[]
+#define BUTTON2_INDEX     1          // S2
+
+typedef struct
+{
+    uint8_t integrator;              // 0 = released ... debounceSamples = pressed
+    uint8_t pressed;                 // Debounced state
+    uint16_t held;                   // Samples since the press was accepted
+#if EVENTLATENCY_ENABLED
+    uint8_t stamped;                 // pressStamp is set
+    uint32_t pressStamp;             // Timer_now() at the first edge or sample down
+#endif
+} ButtonState;
+
+static const uint16_t buttonMasks[BUTTON_COUNT] = { BUTTON_S1, BUTTON_S2 };
+
 volatile uint16_t buttonsPressed = 0;
 
+static ButtonState buttons[BUTTON_COUNT];
+static uint16_t enabledButtons = 0;
+static uint8_t sampling = 0;
+static uint32_t ticksPerSample = 1;
+static SoftTimer sampleTimer;        // Periodic while any button is active
+static uint16_t wakeBits = OSCOFF;   // SR bits to clear so the sample timer runs
+
+static uint8_t debounceSamples = BUTTON_DEFAULT_DEBOUNCE_MS / BUTTON_SAMPLE_MS;
+static uint16_t longPressSamples = BUTTON_DEFAULT_LONG_PRESS_MS / BUTTON_SAMPLE_MS;
+static uint16_t repeatSamples = BUTTON_DEFAULT_REPEAT_MS / BUTTON_SAMPLE_MS;
+
+static Work_handler eventHandler = 0;
+static uint8_t eventPosted;
+
 // Forward declared functions
-void Buttons_startWDT(void);
+static void Buttons_startSampling(void);
+static void Buttons_stamp(ButtonState *pButton);
+static void Buttons_postEvent(uint8_t index, uint8_t type);
+static uint8_t Buttons_sample(void);
+static uint16_t Buttons_sampleTimerExpired(SoftTimer *pTimer);
 
 /***************************************************************************//**
- * @brief  Initialize ports for buttons as active low inputs
+ * @brief  Initialize ports for buttons as active low inputs and prepare the
+ *         debounce sample timer
  * @param  buttonsMask   Use values defined in HAL_buttons.h for the buttons to
  *                       initialize
  * @return none
@@ -75,10 +115,18 @@ void Buttons_init(uint16_t buttonsMask)
     BUTTON_PORT_OUT |= buttonsMask;  //buttons are active low
     BUTTON_PORT_REN |= buttonsMask;  //pullup resistor
     BUTTON_PORT_SEL &= ~buttonsMask;
+
+    Timer_init();
+    Timer_create(&sampleTimer, Buttons_sampleTimerExpired);
+    ticksPerSample = Timer_msToTicks(BUTTON_SAMPLE_MS);
+    wakeBits = Timer_getWakeBits();
 }
 
 /***************************************************************************//**
- * @brief  Enable button interrupts for selected buttons
+ * @brief  Enable the button service for selected buttons.
+ *
+ *         An edge on an enabled button starts the sample timer, which runs
+ *         until all buttons are released again.
  * @param  buttonsMask   Use values defined in HAL_buttons.h for the buttons to
  *                       enable
  * @return none
@@ -86,13 +134,25 @@ void Buttons_init(uint16_t buttonsMask)
 
 void Buttons_interruptEnable(uint16_t buttonsMask)
 {
-    BUTTON_PORT_IES &= ~buttonsMask; //select falling edge trigger
-    BUTTON_PORT_IFG &= ~buttonsMask; //clear flags
-    BUTTON_PORT_IE |= buttonsMask;   //enable interrupts
+    uint16_t gie = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+    enabledButtons |= buttonsMask;
+    if (!sampling)
+    {
+        BUTTON_PORT_IES |= buttonsMask; //select falling edge trigger
+        BUTTON_PORT_IFG &= ~buttonsMask; //clear flags
+        BUTTON_PORT_IE |= buttonsMask;  //enable interrupts
+
+        // A button already held down produces no edge
+        if (~BUTTON_PORT_IN & enabledButtons)
+            Buttons_startSampling();
+    }
+    __bis_SR_register(gie);
 }
 
 /***************************************************************************//**
- * @brief  Disable button interrupts for selected buttons
+ * @brief  Disable the button service for selected buttons
  * @param  buttonsMask   Use values defined in HAL_buttons.h for the buttons to
  *                       disable
  * @return none
@@ -100,49 +160,234 @@ void Buttons_interruptEnable(uint16_t buttonsMask)
 
 void Buttons_interruptDisable(uint16_t buttonsMask)
 {
+    uint16_t gie = __get_SR_register() & GIE;
+
+    __disable_interrupt();
     BUTTON_PORT_IE &= ~buttonsMask;
+    enabledButtons &= ~buttonsMask;
+    __bis_SR_register(gie);
 }
 
 /***************************************************************************//**
- * @brief  Sets up the WDT as a button debouncer, only activated once a
- *         button interrupt has occurred.
- * @param  none
+ * @brief  Set the debounce and hold timing
+ * @param  debounceMs    Time a button must be stable before a press or release
+ *                       is reported
+ * @param  longPressMs   Hold time before BUTTON_EVENT_LONG_PRESS
+ * @param  repeatMs      Interval of BUTTON_EVENT_REPEAT after a long press,
+ *                       0 for no repeat
  * @return none
  ******************************************************************************/
 
-void Buttons_startWDT()
+void Buttons_setTiming(uint16_t debounceMs, uint16_t longPressMs, uint16_t repeatMs)
 {
-    // WDT as 250ms interval counter
-    SFRIFG1 &= ~WDTIFG;
-    WDTCTL = WDTPW + WDTSSEL_1 + WDTTMSEL + WDTCNTCL + WDTIS_5;
-    SFRIE1 |= WDTIE;
+    uint16_t samples = debounceMs / BUTTON_SAMPLE_MS;
+    uint16_t gie = __get_SR_register() & GIE;
+
+    if (samples == 0)
+        samples = 1;
+    if (samples > 0xFF)
+        samples = 0xFF;
+
+    __disable_interrupt();
+    debounceSamples = samples;
+    longPressSamples = longPressMs / BUTTON_SAMPLE_MS;
+    repeatSamples = repeatMs / BUTTON_SAMPLE_MS;
+    __bis_SR_register(gie);
+}
+
+/***************************************************************************//**
+ * @brief  Get the debounced state of the buttons
+ * @param  none
+ * @return Mask of buttons currently held down
+ ******************************************************************************/
+
+uint16_t Buttons_getState(void)
+{
+    uint8_t i;
+    uint16_t state = 0;
+
+    for (i = 0; i < BUTTON_COUNT; i++)
+    {
+        if (buttons[i].pressed)
+            state |= buttonMasks[i];
+    }
+    return state;
 }
 
 /***************************************************************************//**
- * @brief  Handles Watchdog Timer interrupts.
+ * @brief  Set the handler that receives button events in main-loop context
  *
- *         Global variables are used to determine the module triggering the
- *         interrupt, and therefore, how to handle it.
+ *         Events are posted to the deferred work queue; decode the argument
+ *         with BUTTON_EVENT_BUTTON() and BUTTON_EVENT_TYPE().
+ * @param  handler  Event handler, or 0 to only update buttonsPressed
+ * @return none
+ ******************************************************************************/
+
+void Buttons_setEventHandler(Work_handler handler)
+{
+    eventHandler = handler;
+}
+
+/***************************************************************************//**
+ * @brief  Switch from edge interrupts to periodic sampling.
+ *         Must be called with interrupts disabled.
  * @param  none
  * @return none
  ******************************************************************************/
 
-#pragma vector=WDT_VECTOR
-__interrupt void WDT_ISR(void)
+static void Buttons_startSampling(void)
+{
+    BUTTON_PORT_IE &= ~enabledButtons;
+    if (!sampling)
+    {
+        sampling = 1;
+        Timer_start(&sampleTimer, ticksPerSample, ticksPerSample);
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Remember when a press began, for the latency of its event. Keeps
+ *         the earliest time until the press is posted or sampling stops.
+ * @param  pButton  Button going down
+ * @return none
+ ******************************************************************************/
+
+static void Buttons_stamp(ButtonState *pButton)
+{
+#if EVENTLATENCY_ENABLED
+    if (!pButton->pressed && !pButton->stamped)
+    {
+        pButton->pressStamp = Timer_now();
+        pButton->stamped = 1;
+    }
+#endif
+}
+
+/***************************************************************************//**
+ * @brief  Post a button event and update buttonsPressed
+ * @param  index   Button, index into buttonMasks[]
+ * @param  type    BUTTON_EVENT_xxx
+ * @return none
+ ******************************************************************************/
+
+static void Buttons_postEvent(uint8_t index, uint8_t type)
 {
-    if (buttonDebounce == 2)
+    uint16_t button = buttonMasks[index];
+    uint32_t stamp = 0;
+
+    if (type == BUTTON_EVENT_PRESS)
+    {
+        buttonsPressed |= button;
+        eventPosted = 1;                 // Wakes Menu_active() as well
+    }
+
+#if EVENTLATENCY_ENABLED
+    // A press carries the time of its edge, other events the time they occur
+    stamp = Timer_now();
+    if (type == BUTTON_EVENT_PRESS && buttons[index].stamped)
     {
-        buttonDebounce = 1;
+        stamp = buttons[index].pressStamp;
+        buttons[index].stamped = 0;
+    }
+#endif
+
+    if (eventHandler && Work_postStamped(eventHandler, BUTTON_EVENT_ARG(button, type), stamp))
+        eventPosted = 1;
+}
+
+/***************************************************************************//**
+ * @brief  Integrate one sample of every enabled button and generate events
+ * @param  none
+ * @return 1 if any button is pressed or not yet settled, 0 when all are idle
+ ******************************************************************************/
+
+static uint8_t Buttons_sample(void)
+{
+    uint8_t i;
+    uint8_t busy = 0;
+    uint16_t down = ~BUTTON_PORT_IN & enabledButtons;   // Active low
+    ButtonState *pButton;
+
+    for (i = 0; i < BUTTON_COUNT; i++)
+    {
+        pButton = &buttons[i];
+
+        if (down & buttonMasks[i])
+        {
+            Buttons_stamp(pButton);
+            if (pButton->integrator < debounceSamples)
+                pButton->integrator++;
+        }
+        else if (pButton->integrator)
+        {
+            pButton->integrator--;
+        }
+
+        if (!pButton->pressed && pButton->integrator >= debounceSamples)
+        {
+            pButton->pressed = 1;
+            pButton->held = 0;
+            Buttons_postEvent(i, BUTTON_EVENT_PRESS);
+        }
+        else if (pButton->pressed && pButton->integrator == 0)
+        {
+            pButton->pressed = 0;
+            Buttons_postEvent(i, BUTTON_EVENT_RELEASE);
+        }
+        else if (pButton->pressed && pButton->held != 0xFFFF)
+        {
+            pButton->held++;
+            if (pButton->held == longPressSamples)
+            {
+                Buttons_postEvent(i, BUTTON_EVENT_LONG_PRESS);
+            }
+            else if (repeatSamples && pButton->held > longPressSamples &&
+                     (pButton->held - longPressSamples) % repeatSamples == 0)
+            {
+                Buttons_postEvent(i, BUTTON_EVENT_REPEAT);
+            }
+        }
 
-        SFRIFG1 &= ~WDTIFG;
-        SFRIE1 &= ~WDTIE;
-        WDTCTL = WDTPW + WDTHOLD;
+        if (pButton->pressed || pButton->integrator)
+            busy = 1;
     }
+
+    return busy;
+}
+
+/***************************************************************************//**
+ * @brief  Handles sample timer matches - samples the buttons every
+ *         BUTTON_SAMPLE_MS while any of them is active.
+ * @param  pTimer  The sample timer
+ * @return LPM4_bits if an event was posted, otherwise 0
+ ******************************************************************************/
+
+static uint16_t Buttons_sampleTimerExpired(SoftTimer *pTimer)
+{
+    eventPosted = 0;
+
+    if (!Buttons_sample())
+    {
+        // All idle: back to edge interrupts
+        Timer_stop(pTimer);
+        sampling = 0;
+#if EVENTLATENCY_ENABLED
+        buttons[BUTTON1_INDEX].stamped = 0;     // Glitches that never became a press
+        buttons[BUTTON2_INDEX].stamped = 0;
+#endif
+        BUTTON_PORT_IFG &= ~enabledButtons;
+        BUTTON_PORT_IE |= enabledButtons;
+
+        // Catch a press that came in before the edge was armed
+        if (~BUTTON_PORT_IN & enabledButtons)
+            Buttons_startSampling();
+    }
+
+    return eventPosted ? LPM4_bits : 0;         // Wake the event consumer
 }
 
 /***************************************************************************//**
- * @brief  Handles Port 2 interrupts - performs button debouncing and registers
- *         button presses.
+ * @brief  Handles Port 2 interrupts - starts debouncing on a button edge.
  * @param  none
  * @return none
  ******************************************************************************/
@@ -150,11 +395,8 @@ __interrupt void WDT_ISR(void)
 #pragma vector=PORT2_VECTOR
 __interrupt void Port2_ISR(void)
 {
-    //
-    // Context save interrupt flag before calling interrupt vector.
-    // Reading interrupt vector generator will automatically clear IFG flag
-    //
-    buttonsPressed = PAIFG & BUTTON_ALL;
+    STACK_ISR_SAMPLE(STACK_ISR_PORT2);
+    PROFILE_ENTER(PROFILE_ISR_PORT2);
 
     switch (__even_in_range(P2IV, P2IV_P2IFG7))
     {
@@ -172,17 +414,9 @@ __interrupt void Port2_ISR(void)
 
         // Vector  P2IV_P2IFG2:  P2IV P2IFG.2
         case  P2IV_P2IFG2:
-            if (buttonDebounce == 1)
-            {
-                buttonDebounce = 2;
-                Buttons_startWDT();
-                __bic_SR_register_on_exit(LPM3_bits);
-            }
-            else if (buttonDebounce == 0)
-            {
-                __bic_SR_register_on_exit(LPM4_bits);
-            }
-
+            Buttons_stamp(&buttons[BUTTON2_INDEX]);
+            Buttons_startSampling();
+            __bic_SR_register_on_exit(wakeBits);    // Keep the sample timer clock on
             break;
 
         // Vector  P2IV_P2IFG3:  P2IV P2IFG.3
@@ -209,11 +443,12 @@ __interrupt void Port2_ISR(void)
         default:
             break;
     }
+
+    PROFILE_EXIT(PROFILE_ISR_PORT2);
 }
 
 /***************************************************************************//**
- * @brief  Handles Port 1 interrupts - performs button debouncing and registers
- *         button presses.
+ * @brief  Handles Port 1 interrupts - starts debouncing on a button edge.
  * @param  none
  * @return none
  ******************************************************************************/
@@ -221,11 +456,8 @@ __interrupt void Port2_ISR(void)
 #pragma vector=PORT1_VECTOR
 __interrupt void Port1_ISR(void)
 {
-    //
-    // Context save interrupt flag before calling interrupt vector.
-    // Reading interrupt vector generator will automatically clear IFG flag
-    //
-    buttonsPressed = PAIFG & BUTTON_ALL;
+    STACK_ISR_SAMPLE(STACK_ISR_PORT1);
+    PROFILE_ENTER(PROFILE_ISR_PORT1);
 
     switch (__even_in_range(P1IV, P1IV_P1IFG7))
     {
@@ -263,23 +495,17 @@ __interrupt void Port1_ISR(void)
 
         // Vector  P1IV_P1IFG7:  P1IV P1IFG.7
         case  P1IV_P1IFG7:
-            if (buttonDebounce == 1)
-            {
-                buttonDebounce = 2;
-                Buttons_startWDT();
-                __bic_SR_register_on_exit(LPM3_bits);
-            }
-            else if (buttonDebounce == 0)
-            {
-                __bic_SR_register_on_exit(LPM4_bits);
-            }
-
+            Buttons_stamp(&buttons[BUTTON1_INDEX]);
+            Buttons_startSampling();
+            __bic_SR_register_on_exit(wakeBits);    // Keep the sample timer clock on
             break;
 
         // Default case
         default:
             break;
     }
+
+    PROFILE_EXIT(PROFILE_ISR_PORT1);
 }
 
 /***************************************************************************//**
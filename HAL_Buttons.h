@@ -38,16 +38,33 @@
 #define HAL_BUTTONS_H
 
 #include <stdint.h>
+#include "HAL_Work.h"
 
 #define BUTTON_S2       0x0400
 #define BUTTON_S1       0x0080
 #define BUTTON_ALL      0x0480
 
+#define BUTTON_EVENT_PRESS          0x01
+#define BUTTON_EVENT_RELEASE        0x02
+#define BUTTON_EVENT_LONG_PRESS     0x03
+#define BUTTON_EVENT_REPEAT         0x04
+
+#define BUTTON_DEFAULT_DEBOUNCE_MS      10
+#define BUTTON_DEFAULT_LONG_PRESS_MS    800
+#define BUTTON_DEFAULT_REPEAT_MS        150
+
+// Button events are posted as one 16-bit work item argument
+#define BUTTON_EVENT_ARG(button, type)  ((button) | ((uint16_t)(type) << 12))
+#define BUTTON_EVENT_BUTTON(arg)        ((arg) & BUTTON_ALL)
+#define BUTTON_EVENT_TYPE(arg)          ((uint8_t)((arg) >> 12))
+
 volatile extern uint16_t buttonsPressed;
-volatile extern uint8_t buttonDebounce;
 
 extern void Buttons_init(uint16_t buttonsMask);
 extern void Buttons_interruptEnable(uint16_t buttonsMask);
 extern void Buttons_interruptDisable(uint16_t buttonsMask);
+extern void Buttons_setTiming(uint16_t debounceMs, uint16_t longPressMs, uint16_t repeatMs);
+extern void Buttons_setEventHandler(Work_handler handler);
+extern uint16_t Buttons_getState(void);
 
 #endif /* HAL_BUTTONS_H */
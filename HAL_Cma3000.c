@@ -41,12 +41,25 @@
  * @{
  ******************************************************************************/
 #include "msp430.h"
+#include "HAL_BusTrace.h"
+#include "HAL_Energy.h"
+#include "HAL_Profile.h"
+#include "HAL_Timer.h"
 #include "HAL_UCS.h"
 #include "HAL_Cma3000.h"
 
 // CONSTANTS
-#define MCLK                    25000000
-#define TICKSPERUS              (MCLK / 1000000)
+#define INTERFRAME_DELAY_US     50          // Gap between consecutive register accesses
+#define DELAY_LOOP_CYCLES       8           // Cycles burnt per inter-frame delay loop pass
+#define SETTLE_POLL_MS          1           // INT line poll interval while settling
+#define SETTLE_TIMEOUT_MS       20          // Settling time per DS = 10ms, with margin
+#define INIT_MAX_ATTEMPTS       5           // Configuration attempts before giving up
+#define SPI_FREQUENCY           500000UL    // SPI clock limit per DS
+
+// INIT STATES
+#define INIT_STATE_IDLE         0
+#define INIT_STATE_SETTLING     1
+#define INIT_STATE_DONE         2
 
 // PORT DEFINITIONS
 #define ACCEL_INT_IN            P2IN
@@ -72,7 +85,9 @@
 // ACCELEROMETER REGISTER DEFINITIONS
 #define REVID                   0x01
 #define CTRL                    0x02
+#define MODE_100                0x02        // Measurement mode 100 Hz ODR
 #define MODE_400                0x04        // Measurement mode 400 Hz ODR
+#define MODE_40                 0x06        // Measurement mode 40 Hz ODR
 #define DOUTX                   0x06
 #define DOUTY                   0x07
 #define DOUTZ                   0x08
@@ -85,6 +100,9 @@ int8_t Cma3000_xAccel;
 int8_t Cma3000_yAccel;
 int8_t Cma3000_zAccel;
 
+// Timer_now() at the start of the last Cma3000_readAccel()
+uint32_t Cma3000_readTime;
+
 // Stores x-Offset
 int8_t Cma3000_xAccel_offset;
 
@@ -94,69 +112,315 @@ int8_t Cma3000_yAccel_offset;
 // Stores z-Offset
 int8_t Cma3000_zAccel_offset;
 
+// Measurement mode programmed into CTRL
+static uint8_t measurementMode = MODE_400;
+
+// Init state machine
+static uint8_t initState = INIT_STATE_IDLE;
+static uint8_t initStatus = CMA3000_INIT_BUSY;
+static uint8_t initAttempts;
+static uint8_t settleElapsedMs;
+static uint32_t settleTicksPerPoll;
+static SoftTimer settleTimer;               // One-shot, only wakes the CPU
+
+// Busy-wait loop count for the inter-frame delay at the current MCLK
+static uint16_t interFrameLoops;
+
+// Forward declared functions
+static void Cma3000_interFrameDelay(void);
+static void Cma3000_startSettleTimer(void);
+static void Cma3000_configure(void);
+static void Cma3000_setSpiDivider(void);
+static void Cma3000_setDelayLoops(void);
+static void Cma3000_clockChanged(void);
+
+
+/***************************************************************************//**
+ * @brief  Busy-waits for the gap required between two register accesses.
+ *
+ *         The gap is shorter than two ACLK ticks. Sleeping on the timer
+ *         service would stretch it to 61-92 us plus the LPM3 wake-up, three
+ *         times per Cma3000_readAccel(), so the loop count is derived from
+ *         MCLK instead.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Cma3000_interFrameDelay(void)
+{
+    uint16_t loops = interFrameLoops;
+
+    while (loops--)
+        __delay_cycles(DELAY_LOOP_CYCLES);
+}
+
+/***************************************************************************//**
+ * @brief  Arms the settle timer for one INT line poll interval.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Cma3000_startSettleTimer(void)
+{
+    Timer_start(&settleTimer, settleTicksPerPoll, 0);
+}
+
+/***************************************************************************//**
+ * @brief  Programs the USCI_A0 divider for SPI_FREQUENCY at the current SMCLK.
+ *         The state machine must be in reset.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Cma3000_setSpiDivider(void)
+{
+    uint16_t divider = UCS_getSmclkDivider(SPI_FREQUENCY);
+
+    UCA0BR0 = divider & 0xFF;
+    UCA0BR1 = divider >> 8;
+}
 
 /***************************************************************************//**
- * @brief  Configures the CMA3000-D01 3-Axis Ultra Low Power Accelerometer
+ * @brief  Derives the inter-frame delay loop count from the current MCLK.
  * @param  none
  * @return none
  ******************************************************************************/
 
-void Cma3000_init(void)
+static void Cma3000_setDelayLoops(void)
 {
-    do
+    interFrameLoops = UCS_getMclkFrequency() /
+                      (1000000UL / INTERFRAME_DELAY_US * DELAY_LOOP_CYCLES);
+}
+
+/***************************************************************************//**
+ * @brief  Recomputes the SPI divider and the inter-frame delay after a clock
+ *         profile change.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Cma3000_clockChanged(void)
+{
+    Cma3000_setDelayLoops();
+
+    if (UCA0CTL1 & UCSWRST)
+        return;
+
+    while (UCA0STAT & UCBUSY) ;
+    UCA0CTL1 |= UCSWRST;
+    Cma3000_setSpiDivider();
+    UCA0CTL1 &= ~UCSWRST;
+}
+
+/***************************************************************************//**
+ * @brief  Powers the sensor, sets up USCI_A0 and programs measurement mode.
+ *
+ *         This is one attempt of the init sequence; the sensor then needs to
+ *         settle until it raises its INT line.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Cma3000_configure(void)
+{
+    // Set P3.6 to output direction high
+    ACCEL_OUT |= ACCEL_PWR;
+    ACCEL_DIR |= ACCEL_PWR;
+    ENERGY_SET_LOAD(ENERGY_ACCEL, ENERGY_FULL_LOAD);
+
+    // P3.3,4 option select
+    ACCEL_SEL |= ACCEL_SIMO + ACCEL_SOMI;
+
+    // P2.7 option select
+    ACCEL_SCK_SEL |= ACCEL_SCK;
+
+    ACCEL_INT_DIR &= ~ACCEL_INT;
+
+    // Generate interrupt on Lo to Hi edge
+    ACCEL_INT_IES &= ~ACCEL_INT;
+
+    // Clear interrupt flag
+    ACCEL_INT_IFG &= ~ACCEL_INT;
+
+    // Unselect acceleration sensor
+    ACCEL_OUT |= ACCEL_CS;
+    ACCEL_DIR |= ACCEL_CS;
+
+    // **Put state machine in reset**
+    UCA0CTL1 |= UCSWRST;
+    // 3-pin, 8-bit SPI master Clock polarity high, MSB
+    UCA0CTL0 = UCMST + UCSYNC + UCCKPH + UCMSB;
+    // Use SMCLK, keep RESET
+    UCA0CTL1 = UCSWRST + UCSSEL_2;
+    // SMCLK divided down to at most SPI_FREQUENCY
+    Cma3000_setSpiDivider();
+    // No modulation
+    UCA0MCTL = 0;
+    // **Initialize USCI state machine**
+    UCA0CTL1 &= ~UCSWRST;
+
+    // Read REVID register
+    RevID = Cma3000_readRegister(REVID);
+    Cma3000_interFrameDelay();
+
+    // Activate measurement mode: 2g/400Hz unless changed by Cma3000_setSampleRate
+    accelData = Cma3000_writeRegister(CTRL, G_RANGE_2 | I2C_DIS | measurementMode);
+
+    // INT pin interrupt disabled
+    ACCEL_INT_IE  &= ~ACCEL_INT;
+
+    // Wait for the sensor to settle, polling its INT line
+    settleElapsedMs = 0;
+    Cma3000_startSettleTimer();
+    initState = INIT_STATE_SETTLING;
+}
+
+/***************************************************************************//**
+ * @brief  Starts configuring the CMA3000-D01 3-Axis Ultra Low Power
+ *         Accelerometer without waiting for it to settle.
+ *
+ *         Call Cma3000_initPoll() until it no longer returns CMA3000_INIT_BUSY;
+ *         other subsystems can be initialized in the meantime.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Cma3000_initStart(void)
+{
+    Timer_init();
+    Timer_create(&settleTimer, 0);
+    UCS_addClockCallback(Cma3000_clockChanged);
+    settleTicksPerPoll = Timer_msToTicks(SETTLE_POLL_MS);
+    Cma3000_setDelayLoops();
+
+    initAttempts = 0;
+    initStatus = CMA3000_INIT_BUSY;
+    Cma3000_configure();
+}
+
+/***************************************************************************//**
+ * @brief  Advances the init state machine started by Cma3000_initStart().
+ * @param  none
+ * @return CMA3000_INIT_BUSY while settling, CMA3000_INIT_OK once the sensor
+ *         raised its INT line, CMA3000_INIT_ERR_NO_RESPONSE after
+ *         INIT_MAX_ATTEMPTS attempts timed out
+ ******************************************************************************/
+
+uint8_t Cma3000_initPoll(void)
+{
+    if (initState != INIT_STATE_SETTLING)
+        return initStatus;
+
+    // INT line high shows the sensor is working
+    if (ACCEL_INT_IN & ACCEL_INT)
+    {
+        Timer_stop(&settleTimer);
+        initState = INIT_STATE_DONE;
+        initStatus = CMA3000_INIT_OK;
+    }
+    else if (settleTimer.expired)
+    {
+        settleElapsedMs += SETTLE_POLL_MS;
+
+        if (settleElapsedMs < SETTLE_TIMEOUT_MS)
+        {
+            Cma3000_startSettleTimer();
+        }
+        else if (++initAttempts < INIT_MAX_ATTEMPTS)
+        {
+            // Repeat the configuration sequence
+            Cma3000_configure();
+        }
+        else
+        {
+            Cma3000_disable();
+            initState = INIT_STATE_DONE;
+            initStatus = CMA3000_INIT_ERR_NO_RESPONSE;
+        }
+    }
+
+    return initStatus;
+}
+
+/***************************************************************************//**
+ * @brief  Configures the CMA3000-D01 3-Axis Ultra Low Power Accelerometer and
+ *         waits in LPM0 until it has settled or init has failed.
+ * @param  none
+ * @return CMA3000_INIT_OK or CMA3000_INIT_ERR_NO_RESPONSE
+ ******************************************************************************/
+
+uint8_t Cma3000_init(void)
+{
+    uint8_t status;
+
+    Cma3000_initStart();
+
+    while ((status = Cma3000_initPoll()) == CMA3000_INIT_BUSY)
+    {
+        __disable_interrupt();
+        if (!settleTimer.expired)
+            ENERGY_SLEEP(LPM0_bits);                   // Settle timer ISR will force exit
+        __enable_interrupt();
+    }
+
+    return status;
+}
+
+/***************************************************************************//**
+ * @brief  Sets the accelerometer's output data rate
+ *
+ *         Takes effect immediately if the sensor is running, otherwise with
+ *         the next init.
+ * @param  rateHz  40, 100 or 400
+ * @return 1 if the rate is supported, 0 otherwise
+ ******************************************************************************/
+
+uint8_t Cma3000_setSampleRate(uint16_t rateHz)
+{
+    switch (rateHz)
+    {
+        case 40:
+            measurementMode = MODE_40;
+            break;
+
+        case 100:
+            measurementMode = MODE_100;
+            break;
+
+        case 400:
+            measurementMode = MODE_400;
+            break;
+
+        default:
+            return 0;
+    }
+
+    if (initStatus == CMA3000_INIT_OK)
     {
-        // Set P3.6 to output direction high
-        ACCEL_OUT |= ACCEL_PWR;
-        ACCEL_DIR |= ACCEL_PWR;
-
-        // P3.3,4 option select
-        ACCEL_SEL |= ACCEL_SIMO + ACCEL_SOMI;
-
-        // P2.7 option select
-        ACCEL_SCK_SEL |= ACCEL_SCK;
-
-        ACCEL_INT_DIR &= ~ACCEL_INT;
-
-        // Generate interrupt on Lo to Hi edge
-        ACCEL_INT_IES &= ~ACCEL_INT;
-
-        // Clear interrupt flag
-        ACCEL_INT_IFG &= ~ACCEL_INT;
-
-        // Unselect acceleration sensor
-        ACCEL_OUT |= ACCEL_CS;
-        ACCEL_DIR |= ACCEL_CS;
-
-        // **Put state machine in reset**
-        UCA0CTL1 |= UCSWRST;
-        // 3-pin, 8-bit SPI master Clock polarity high, MSB
-        UCA0CTL0 = UCMST + UCSYNC + UCCKPH + UCMSB;
-        // Use SMCLK, keep RESET
-        UCA0CTL1 = UCSWRST + UCSSEL_2;
-        // /0x30
-        UCA0BR0 = 0x30;
-        // 0
-        UCA0BR1 = 0;
-        // No modulation
-        UCA0MCTL = 0;
-        // **Initialize USCI state machine**
-        UCA0CTL1 &= ~UCSWRST;
-
-        // Read REVID register
-        RevID = Cma3000_readRegister(REVID);
-        __delay_cycles(50 * TICKSPERUS);
-
-        // Activate measurement mode: 2g/400Hz
-        accelData = Cma3000_writeRegister(CTRL, G_RANGE_2 | I2C_DIS | MODE_400);
-
-        // Settling time per DS = 10ms
-        __delay_cycles(1000 * TICKSPERUS);
-
-        // INT pin interrupt disabled
-        ACCEL_INT_IE  &= ~ACCEL_INT;
-
-        // Repeat till interrupt Flag is set to show sensor is working
-    } while (!(ACCEL_INT_IN & ACCEL_INT));
+        accelData = Cma3000_writeRegister(CTRL, G_RANGE_2 | I2C_DIS | measurementMode);
+    }
+    return 1;
+}
+
+/***************************************************************************//**
+ * @brief  Gets the accelerometer's output data rate
+ * @param  none
+ * @return Output data rate in Hz
+ ******************************************************************************/
+
+uint16_t Cma3000_getSampleRate(void)
+{
+    switch (measurementMode)
+    {
+        case MODE_40:
+            return 40;
+
+        case MODE_100:
+            return 100;
+
+        default:
+            return 400;
+    }
 }
 
 /***************************************************************************//**
@@ -169,6 +433,7 @@ void Cma3000_disable(void)
 {
     // Set P3.6 to output direction low
     ACCEL_OUT &= ~ACCEL_PWR;
+    ENERGY_SET_LOAD(ENERGY_ACCEL, 0);
 
     // Disable P3.3,4 option select
     ACCEL_SEL &= ~(ACCEL_SIMO + ACCEL_SOMI);
@@ -182,6 +447,11 @@ void Cma3000_disable(void)
     // INT pin interrupt disabled
     ACCEL_INT_IE  &= ~ACCEL_INT;
 
+    // Stop a pending settle poll, a new init is needed
+    Timer_stop(&settleTimer);
+    initState = INIT_STATE_IDLE;
+    initStatus = CMA3000_INIT_BUSY;
+
     // **Put state machine in reset**
     UCA0CTL1 |= UCSWRST;
 }
@@ -194,16 +464,22 @@ void Cma3000_disable(void)
 
 void Cma3000_readAccel(void)
 {
+    PROFILE_ENTER(PROFILE_ACCEL_READ);
+
+    Cma3000_readTime = Timer_now();
+
     // Read DOUTX register
     Cma3000_xAccel = Cma3000_readRegister(DOUTX);
-    __delay_cycles(50 * TICKSPERUS);
+    Cma3000_interFrameDelay();
 
     // Read DOUTY register
     Cma3000_yAccel = Cma3000_readRegister(DOUTY);
-    __delay_cycles(50 * TICKSPERUS);
+    Cma3000_interFrameDelay();
 
     // Read DOUTZ register
     Cma3000_zAccel = Cma3000_readRegister(DOUTZ);
+
+    PROFILE_EXIT(PROFILE_ACCEL_READ);
 }
 
 /***************************************************************************//**
@@ -259,10 +535,13 @@ void Cma3000_readAccel_offset(void)
 int8_t Cma3000_readRegister(uint8_t Address)
 {
     uint8_t Result;
+    BUSTRACE_DECLARE(trace);
 
     // Address to be shifted left by 2 and RW bit to be reset
     Address <<= 2;
 
+    BUSTRACE_BEGIN(trace, BUSTRACE_ACCEL, BUSTRACE_RX, 2);
+
     // Select acceleration sensor
     ACCEL_OUT &= ~ACCEL_CS;
 
@@ -298,6 +577,7 @@ int8_t Cma3000_readRegister(uint8_t Address)
 
     // Deselect acceleration sensor
     ACCEL_OUT |= ACCEL_CS;
+    BUSTRACE_END(trace);
 
     // Return new data from RX buffer
     return Result;
@@ -313,6 +593,7 @@ int8_t Cma3000_readRegister(uint8_t Address)
 int8_t Cma3000_writeRegister(uint8_t Address, int8_t accelData)
 {
     uint8_t Result;
+    BUSTRACE_DECLARE(trace);
 
     // Address to be shifted left by 2
     Address <<= 2;
@@ -320,6 +601,8 @@ int8_t Cma3000_writeRegister(uint8_t Address, int8_t accelData)
     // RW bit to be set
     Address |= 2;
 
+    BUSTRACE_BEGIN(trace, BUSTRACE_ACCEL, BUSTRACE_TX, 2);
+
     // Select acceleration sensor
     ACCEL_OUT &= ~ACCEL_CS;
 
@@ -355,6 +638,7 @@ int8_t Cma3000_writeRegister(uint8_t Address, int8_t accelData)
 
     // Deselect acceleration sensor
     ACCEL_OUT |= ACCEL_CS;
+    BUSTRACE_END(trace);
 
     return Result;
 }
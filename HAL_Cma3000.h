@@ -43,12 +43,22 @@
 #define DOUTY       0x07
 #define DOUTZ       0x08
 
+// Cma3000_init status
+#define CMA3000_INIT_BUSY               0x00
+#define CMA3000_INIT_OK                 0x01
+#define CMA3000_INIT_ERR_NO_RESPONSE    0x80
+
 extern int8_t Cma3000_xAccel;
 extern int8_t Cma3000_yAccel;
 extern int8_t Cma3000_zAccel;
+extern uint32_t Cma3000_readTime;
 
-extern void Cma3000_init(void);
+extern uint8_t Cma3000_init(void);
+extern void Cma3000_initStart(void);
+extern uint8_t Cma3000_initPoll(void);
 extern void Cma3000_disable(void);
+extern uint8_t Cma3000_setSampleRate(uint16_t rateHz);
+extern uint16_t Cma3000_getSampleRate(void);
 extern void Cma3000_readAccel(void);
 extern void Cma3000_setAccel_offset(int8_t xAccel_offset, int8_t yAccel_offset, int8_t zAccel_offset);
 extern void Cma3000_readAccel_offset(void);
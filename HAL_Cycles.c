@@ -0,0 +1,240 @@
+/*******************************************************************************
+ *
+ *  HAL_Cycles.c - Free-running SMCLK cycle counter
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_Cycles.c
+ * @addtogroup HAL_Cycles
+ * @{
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_Stack.h"
+#include "HAL_Timer.h"
+#include "HAL_UCS.h"
+#include "HAL_Cycles.h"
+
+// TA1 counts SMCLK continuously; its overflows extend the count to 32 bits
+#define CYCLES_TIMER_CTL    TA1CTL
+#define CYCLES_TIMER_R      TA1R
+#define CYCLES_TIMER_IV     TA1IV
+#define CYCLES_TIMER_VECTOR TIMER1_A1_VECTOR
+#define CYCLES_PROBE_CCTL   TA1CCTL1
+#define CYCLES_PROBE_CCR    TA1CCR1
+
+static volatile uint16_t cyclesHigh = 0;
+static uint32_t cyclesPerTick = 0;          // SMCLK per HAL_Timer tick, 16.16 fixed point
+static uint16_t probePeriod = 0;
+static Cycles_probeHandler probeHandler = 0;
+
+// Forward declared functions
+static void Cycles_clockChanged(void);
+
+/***************************************************************************//**
+ * @brief  Recompute the SMCLK to HAL_Timer tick ratio after a clock change
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Cycles_clockChanged(void)
+{
+    cyclesPerTick = ((uint64_t)UCS_getSmclkFrequency() << 16) / Timer_getFrequency();
+}
+
+/***************************************************************************//**
+ * @brief  Start the cycle counter. Timer_init() must have been called.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Cycles_init(void)
+{
+    cyclesHigh = 0;
+    Cycles_clockChanged();
+    UCS_addClockCallback(Cycles_clockChanged);
+    CYCLES_TIMER_CTL = TASSEL__SMCLK + MC__CONTINOUS + TACLR + TAIE;
+}
+
+/***************************************************************************//**
+ * @brief  Start a periodic compare interrupt on CCR1 that reports how late
+ *         its ISR ran, i.e. the interrupt latency at that moment
+ * @param  period   Cycles between probes
+ * @param  handler  Called from the ISR with the measured lateness
+ * @return none
+ ******************************************************************************/
+
+void Cycles_startProbe(uint16_t period, Cycles_probeHandler handler)
+{
+    uint16_t gie = __get_SR_register() & GIE;   // Store current GIE state
+
+    __disable_interrupt();
+    probePeriod = period;
+    probeHandler = handler;
+    CYCLES_PROBE_CCR = CYCLES_TIMER_R + period;
+    CYCLES_PROBE_CCTL = CCIE;
+    __bis_SR_register(gie);                     // Restore original GIE state
+}
+
+/***************************************************************************//**
+ * @brief  Stop the latency probe
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Cycles_stopProbe(void)
+{
+    CYCLES_PROBE_CCTL = 0;
+    probeHandler = 0;
+}
+
+/***************************************************************************//**
+ * @brief  Read the 32-bit cycle count
+ *
+ *         Safe to call with interrupts disabled: a pending overflow that the
+ *         ISR has not counted yet is accounted for here.
+ * @param  none
+ * @return SMCLK cycles since Cycles_init()
+ ******************************************************************************/
+
+uint32_t Cycles_now(void)
+{
+    uint16_t gie = __get_SR_register() & GIE;   // Store current GIE state
+    uint16_t high, low;
+
+    __disable_interrupt();
+
+    low = CYCLES_TIMER_R;
+    high = cyclesHigh;
+    if ((CYCLES_TIMER_CTL & TAIFG) && low < 0x8000)
+        high++;                                 // Wrapped before TAR was read
+
+    __bis_SR_register(gie);                     // Restore original GIE state
+
+    return ((uint32_t)high << 16) | low;
+}
+
+/***************************************************************************//**
+ * @brief  Cycles since a start time, corrected for missed TA1 overflows
+ *
+ *         With interrupts disabled for more than one TA1 period Cycles_now()
+ *         loses overflows. The HAL_Timer tick count, which such a section
+ *         cannot wrap, tells how many; it is good to about one tick, far less
+ *         than the 65536 cycles of a missed overflow. SMCLK must have run
+ *         throughout, i.e. the CPU must not have been in LPM3 or deeper.
+ * @param  startCycles  Cycles_now() at the start
+ * @param  startTicks   Timer_now() at the start
+ * @return SMCLK cycles
+ ******************************************************************************/
+
+uint32_t Cycles_elapsed(uint32_t startCycles, uint32_t startTicks)
+{
+    uint32_t cycles = Cycles_now() - startCycles;
+    uint32_t ticks = Timer_now() - startTicks;
+    uint32_t expected = ((uint64_t)ticks * cyclesPerTick) >> 16;
+
+    // Round the difference to whole TA1 periods, either way: a single
+    // overflow still pending with TAR past 0x8000 is missed as well
+    return cycles + ((expected - cycles + 0x8000) & 0xFFFF0000UL);
+}
+
+/***************************************************************************//**
+ * @brief  Check for a TA1 overflow the ISR has not counted yet
+ *
+ *         With interrupts disabled since a Cycles_now() time stamp, no pending
+ *         overflow means TA1 has not wrapped since.
+ * @param  none
+ * @return 1 if an overflow is pending, 0 otherwise
+ ******************************************************************************/
+
+uint8_t Cycles_overflowPending(void)
+{
+    return (CYCLES_TIMER_CTL & TAIFG) ? 1 : 0;
+}
+
+/***************************************************************************//**
+ * @brief  Convert a cycle count to microseconds at the current SMCLK
+ * @param  cycles  SMCLK cycles
+ * @return Microseconds
+ ******************************************************************************/
+
+uint32_t Cycles_toMicroseconds(uint32_t cycles)
+{
+    uint32_t cyclesPerMs = UCS_getSmclkFrequency() / 1000;
+
+    if (cyclesPerMs == 0)
+        return 0;
+
+    // Split to avoid overflowing 32 bits for long intervals
+    return (cycles / cyclesPerMs) * 1000 + (cycles % cyclesPerMs) * 1000 / cyclesPerMs;
+}
+
+/***************************************************************************//**
+ * @brief  Handles cycle counter overflow and latency probe interrupts.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+#pragma vector = CYCLES_TIMER_VECTOR
+__interrupt void Cycles_ISR(void)
+{
+    uint16_t lateness;
+
+    STACK_ISR_SAMPLE(STACK_ISR_CYCLES);
+
+    switch (__even_in_range(CYCLES_TIMER_IV, TA1IV_TAIFG))
+    {
+        // Vector TA1IV_TACCR1: Latency probe
+        case TA1IV_TACCR1:
+            lateness = CYCLES_TIMER_R - CYCLES_PROBE_CCR;
+            if (lateness < probePeriod)
+                CYCLES_PROBE_CCR += probePeriod;
+            else
+                CYCLES_PROBE_CCR = CYCLES_TIMER_R + probePeriod;  // Missed a period
+            if (probeHandler)
+                probeHandler(lateness);
+            break;
+
+        // Vector TA1IV_TAIFG: Timer overflow
+        case TA1IV_TAIFG:
+            cyclesHigh++;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
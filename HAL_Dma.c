@@ -0,0 +1,139 @@
+/*******************************************************************************
+ *
+ *  HAL_Dma.c - Shared DMA controller trigger and interrupt handling
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_Dma.c
+ * @addtogroup HAL_Dma
+ * @{
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_Dma.h"
+#include "HAL_Profile.h"
+#include "HAL_Stack.h"
+
+#define TSEL_MASK           0x1F       // DMAxTSEL field width
+
+static Dma_callback dmaCallbacks[DMA_NUM_CHANNELS] = { 0, 0, 0 };
+
+/***************************************************************************//**
+ * @brief  Select the trigger source of a DMA channel
+ * @param  channel  DMA_CHANNEL_0 ... DMA_CHANNEL_2
+ * @param  trigger  Trigger number, e.g. 21 for UCA1TXIFG (see device datasheet)
+ * @return none
+ ******************************************************************************/
+
+void Dma_setTrigger(uint8_t channel, uint8_t trigger)
+{
+    // Let the DMA wait for read-modify-write CPU instructions to complete
+    DMACTL4 |= DMARMWDIS;
+
+    switch (channel)
+    {
+        case DMA_CHANNEL_0:
+            DMACTL0 = (DMACTL0 & ~TSEL_MASK) | (trigger & TSEL_MASK);
+            break;
+
+        case DMA_CHANNEL_1:
+            DMACTL0 = (DMACTL0 & ~(TSEL_MASK << 8)) | ((uint16_t)(trigger & TSEL_MASK) << 8);
+            break;
+
+        case DMA_CHANNEL_2:
+            DMACTL1 = (DMACTL1 & ~TSEL_MASK) | (trigger & TSEL_MASK);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Register the completion handler of a DMA channel
+ * @param  channel   DMA_CHANNEL_0 ... DMA_CHANNEL_2
+ * @param  callback  Handler called in interrupt context, or 0 for none
+ * @return none
+ ******************************************************************************/
+
+void Dma_setCallback(uint8_t channel, Dma_callback callback)
+{
+    if (channel < DMA_NUM_CHANNELS)
+        dmaCallbacks[channel] = callback;
+}
+
+/***************************************************************************//**
+ * @brief  Handles DMA interrupts - dispatches to the channel's callback.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+#pragma vector = DMA_VECTOR
+__interrupt void DMA_ISR(void)
+{
+    uint8_t channel;
+
+    STACK_ISR_SAMPLE(STACK_ISR_DMA);
+
+    switch (__even_in_range(DMAIV, DMAIV_DMA2IFG))
+    {
+        // Vector DMAIV_DMA0IFG: DMA channel 0
+        case DMAIV_DMA0IFG:
+            channel = DMA_CHANNEL_0;
+            break;
+
+        // Vector DMAIV_DMA1IFG: DMA channel 1
+        case DMAIV_DMA1IFG:
+            channel = DMA_CHANNEL_1;
+            break;
+
+        // Vector DMAIV_DMA2IFG: DMA channel 2
+        case DMAIV_DMA2IFG:
+            channel = DMA_CHANNEL_2;
+            break;
+
+        default:
+            return;
+    }
+
+    PROFILE_ENTER(PROFILE_ISR_DMA);
+    if (dmaCallbacks[channel])
+        dmaCallbacks[channel]();
+    PROFILE_EXIT(PROFILE_ISR_DMA);
+
+    __bic_SR_register_on_exit(LPM3_bits);
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
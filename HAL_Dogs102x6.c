@@ -41,7 +41,12 @@
  ******************************************************************************/
 #include "msp430.h"
 #include "HAL_Buttons.h"
+#include "HAL_BusTrace.h"
 #include "HAL_Dogs102x6.h"
+#include "HAL_Energy.h"
+#include "HAL_Latency.h"
+#include "HAL_Profile.h"
+#include "HAL_UCS.h"
 
 // Macros
 #ifndef abs
@@ -98,6 +103,20 @@
 #define SPI_SEL         P4SEL
 #define SPI_DIR         P4DIR
 
+// Highest SPI clock used for the LCD
+#define SPI_FREQUENCY   12500000UL
+
+// Backlight PWM: TB0.4 set at the start of the period, reset at TB0CCR4
+#define BACKLIGHT_DUTY_PERMILLE ((uint32_t)TB0CCR4 * ENERGY_FULL_LOAD / (TB0CCR0 + 1))
+
+#define LATENCY_FILE    LATENCY_FILE_DOGS102X6
+
+#if DOGS102x6_STATS_ENABLED
+#define STATS_ADD(field, n)   (stats.field += (n))
+#else
+#define STATS_ADD(field, n)
+#endif
+
 // Font lookup table
 static const uint8_t FONT6x8[] = {
     /* 6x8 font, each line is a character each byte is a one pixel wide column
@@ -218,6 +237,7 @@ static const uint8_t FONT6x8[] = {
 // what is stored there Two additional byes are used for driver-
 // internal purposes
 uint8_t dogs102x6Memory[816 + 2];
+const uint16_t Dogs102x6_ramSize = sizeof(dogs102x6Memory);
 
 uint8_t currentPage = 0, currentColumn = 0;
 
@@ -225,6 +245,9 @@ uint8_t backlight  = 8;
 uint8_t contrast = 0x0F;
 uint8_t drawmode = DOGS102x6_DRAW_IMMEDIATE;
 
+// SPI transaction counters, see Dogs102x6_getStats()
+static Dogs102x6Stats stats;
+
 // Dog102-6 Initialization Commands
 uint8_t Dogs102x6_initMacro[] = {
     SET_SCROLL_LINE,
@@ -245,6 +268,29 @@ uint8_t Dogs102x6_initMacro[] = {
     SET_COLUMN_ADDRESS_LSB
 };
 
+/***************************************************************************//**
+ * @brief   Recompute the SPI divider after a clock profile change, if the
+ *          bus is currently set up for the LCD (clock polarity low)
+ * @param   None
+ * @return  None
+ ******************************************************************************/
+
+static void Dogs102x6_clockChanged(void)
+{
+    uint16_t divider;
+
+    if ((UCB1CTL1 & UCSWRST) || (UCB1CTL0 & UCCKPL))
+        return;
+
+    divider = UCS_getSmclkDivider(SPI_FREQUENCY);
+    while (UCB1STAT & UCBUSY) ;
+    UCB1CTL1 |= UCSWRST;
+    UCB1BR0 = divider & 0xFF;
+    UCB1BR1 = divider >> 8;
+    UCB1CTL1 &= ~UCSWRST;
+    UCB1IFG &= ~UCRXIFG;
+}
+
 /***************************************************************************//**
  * @brief   Initialize LCD
  * @param   None
@@ -253,6 +299,8 @@ uint8_t Dogs102x6_initMacro[] = {
 
 void Dogs102x6_init(void)
 {
+    uint16_t divider = UCS_getSmclkDivider(SPI_FREQUENCY);
+
     // Port initialization for LCD operation
     CD_RST_DIR |= RST;
     // Reset is active low
@@ -284,11 +332,12 @@ void Dogs102x6_init(void)
     // MSB
     // Use SMCLK, keep RESET
     UCB1CTL1 = UCSSEL_2 + UCSWRST;
-    UCB1BR0 = 0x02;
-    UCB1BR1 = 0;
+    UCB1BR0 = divider & 0xFF;
+    UCB1BR1 = divider >> 8;
     // Release USCI state machine
     UCB1CTL1 &= ~UCSWRST;
     UCB1IFG &= ~UCRXIFG;
+    UCS_addClockCallback(Dogs102x6_clockChanged);
 
     Dogs102x6_writeCommand(Dogs102x6_initMacro, 13);
 
@@ -319,6 +368,7 @@ void Dogs102x6_backlightInit(void)
 
     TB0CCR0 = 50;
     TB0CTL = TBSSEL_1 + MC_1;
+    ENERGY_SET_LOAD(ENERGY_BACKLIGHT, BACKLIGHT_DUTY_PERMILLE);
 }
 
 /***************************************************************************//**
@@ -347,11 +397,15 @@ void Dogs102x6_setBacklight(uint8_t brightness)
         //If the backlight was previously turned off, turn it on.
         if (!backlight)
             TB0CTL |= MC0;
+
+        ENERGY_SET_LOAD(ENERGY_BACKLIGHT, BACKLIGHT_DUTY_PERMILLE);
     }
     else
     {
         TB0CCTL4 = 0;
         TB0CTL &= ~MC0;
+
+        ENERGY_SET_LOAD(ENERGY_BACKLIGHT, 0);
     }
     backlight = brightness;
 }
@@ -382,9 +436,15 @@ void Dogs102x6_writeCommand(uint8_t *sCmd, uint8_t i)
 {
     // Store current GIE state
     uint16_t gie = __get_SR_register() & GIE;
+    BUSTRACE_DECLARE(trace);
 
     // Make this operation atomic
     __disable_interrupt();
+    LATENCY_CRITICAL_ENTER(gie);
+
+    STATS_ADD(selects, 1);
+    STATS_ADD(bytes, i);
+    BUSTRACE_BEGIN(trace, BUSTRACE_LCD, BUSTRACE_TX, i);
 
     // CS Low
     P7OUT &= ~CS;
@@ -414,8 +474,10 @@ void Dogs102x6_writeCommand(uint8_t *sCmd, uint8_t i)
 
     // CS High
     P7OUT |= CS;
+    BUSTRACE_END(trace);
 
     // Restore original GIE state
+    LATENCY_CRITICAL_EXIT(gie);
     __bis_SR_register(gie);
 }
 
@@ -430,9 +492,13 @@ void Dogs102x6_writeData(uint8_t *sData, uint8_t i)
 {
     // Store current GIE state
     uint16_t gie = __get_SR_register() & GIE;
+    BUSTRACE_DECLARE(trace);
+
+    PROFILE_ENTER(PROFILE_LCD_WRITE_DATA);
 
     // Make this operation atomic
     __disable_interrupt();
+    LATENCY_CRITICAL_ENTER(gie);
 
     if (drawmode == DOGS102x6_DRAW_ON_REFRESH) 
     {
@@ -453,7 +519,10 @@ void Dogs102x6_writeData(uint8_t *sData, uint8_t i)
     } 
     else 
     {
-    
+      STATS_ADD(selects, 1);
+      STATS_ADD(bytes, i);
+      BUSTRACE_BEGIN(trace, BUSTRACE_LCD, BUSTRACE_TX, i);
+
       // CS Low
       P7OUT &= ~CS;
       //CD High
@@ -488,9 +557,13 @@ void Dogs102x6_writeData(uint8_t *sData, uint8_t i)
   
       // CS High
       P7OUT |= CS;
+      BUSTRACE_END(trace);
     }
     
+    PROFILE_EXIT(PROFILE_LCD_WRITE_DATA);
+
     // Restore original GIE state
+    LATENCY_CRITICAL_EXIT(gie);
     __bis_SR_register(gie);
 }
 
@@ -552,6 +625,8 @@ void Dogs102x6_setAddress(uint8_t pa, uint8_t ca)
 
     if (drawmode == DOGS102x6_DRAW_ON_REFRESH) return; // exit if drawmode on refresh
 
+    STATS_ADD(addressSets, 1);
+
     // Separate Command Address to low and high
     L = (ca & 0x0F);
     H = (ca & 0xF0);
@@ -1444,6 +1519,38 @@ void Dogs102x6_refresh(uint8_t mode)
   drawmode = mode;
 }
 
+/***************************************************************************//**
+ * @brief   Gets the SPI transaction counters
+ *
+ *          Counted since reset or the last Dogs102x6_resetStats().
+ *          All zero if DOGS102x6_STATS_ENABLED is 0.
+ * @param   None
+ * @return  Pointer to the counters
+ ******************************************************************************/
+
+const Dogs102x6Stats *Dogs102x6_getStats(void)
+{
+    return &stats;
+}
+
+/***************************************************************************//**
+ * @brief   Clears the SPI transaction counters
+ * @param   None
+ * @return  None
+ ******************************************************************************/
+
+void Dogs102x6_resetStats(void)
+{
+    // Store current GIE state
+    uint16_t gie = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+    stats.bytes = 0;
+    stats.selects = 0;
+    stats.addressSets = 0;
+    __bis_SR_register(gie);
+}
+
 /***************************************************************************//**
  * @}
  ******************************************************************************/
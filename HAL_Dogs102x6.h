@@ -51,7 +51,20 @@
 #define DOGS102x6_DRAW_IMMEDIATE  0x01  // Display update done immediately
 #define DOGS102x6_DRAW_ON_REFRESH 0x00  // Display update done only with refresh
 
+// Set to 0 to compile the SPI transaction counters out
+#ifndef DOGS102x6_STATS_ENABLED
+#define DOGS102x6_STATS_ENABLED 1
+#endif
+
+typedef struct
+{
+    uint32_t bytes;                    // Command and data bytes sent
+    uint32_t selects;                  // Chip select windows
+    uint32_t addressSets;              // Dogs102x6_setAddress() command sequences
+} Dogs102x6Stats;
+
 extern uint8_t dogs102x6Memory[];      // Provide direct access to the frame buffer
+extern const uint16_t Dogs102x6_ramSize;   // sizeof(dogs102x6Memory)
 
 extern void Dogs102x6_init(void);
 extern void Dogs102x6_backlightInit(void);
@@ -82,5 +95,7 @@ extern void Dogs102x6_lineDraw(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, u
 extern void Dogs102x6_circleDraw(uint8_t x, uint8_t y, uint8_t radius, uint8_t style);
 extern void Dogs102x6_imageDraw(const uint8_t IMAGE[], uint8_t row, uint8_t col);
 extern void Dogs102x6_clearImage(uint8_t height, uint8_t width, uint8_t row, uint8_t col);
+extern const Dogs102x6Stats *Dogs102x6_getStats(void);
+extern void Dogs102x6_resetStats(void);
 
 #endif /* HAL_DOGS102x6_H */
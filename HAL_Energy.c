@@ -0,0 +1,377 @@
+/*******************************************************************************
+ *
+ *  HAL_Energy.c - LPM residency and energy accounting
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_Energy.c
+ * @addtogroup HAL_Energy
+ * @{
+ *
+ * Time spent in active mode and each low-power mode, the on-time of the
+ * power-hungry loads, and the charge drawn estimated from configurable
+ * currents.
+ *
+ * All times are Timer_now() ticks, which count ACLK and keep running in
+ * LPM3. The CPU state changes in Energy_sleep(), which the wait loops of
+ * HAL_Scheduler, HAL_Timer, HAL_AppUart and HAL_Cma3000 use instead of
+ * entering the LPM directly. ISRs that run while the CPU sleeps and return
+ * to the LPM are counted as sleep, see the note in HAL_Energy.h. Active
+ * time is weighted by the MCLK frequency, so a clock profile change is
+ * reflected in the charge.
+ *
+ * Loads report their level with Energy_setLoad() as they are switched; the
+ * backlight passes its PWM duty. Counters wrap after about 36 hours.
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_Timer.h"
+#include "HAL_UCS.h"
+#include "HAL_Energy.h"
+
+#define FIRST_LOAD          ENERGY_NUM_CPU_STATES
+#define NUM_LOADS           (ENERGY_NUM_ACCOUNTS - ENERGY_NUM_CPU_STATES)
+
+static uint32_t ticks[ENERGY_NUM_ACCOUNTS];    // Full load equivalent
+static uint64_t activeKhzTicks;                // ENERGY_ACTIVE ticks times MCLK in kHz
+static uint32_t cpuMark;                       // Start of the current active period
+static uint32_t loadMarks[NUM_LOADS];
+static uint16_t loadPermille[NUM_LOADS];
+static uint32_t resetMark;
+static uint32_t mclkKhz;
+static uint8_t initialized = 0;
+
+static uint32_t currents[ENERGY_NUM_ACCOUNTS] = {
+    ENERGY_DEFAULT_ACTIVE_UA_PER_MHZ,
+    ENERGY_DEFAULT_LPM0_UA,
+    ENERGY_DEFAULT_LPM3_UA,
+    ENERGY_DEFAULT_LPM4_UA,
+    ENERGY_DEFAULT_BACKLIGHT_UA,
+    ENERGY_DEFAULT_ADC_UA,
+    ENERGY_DEFAULT_ACCEL_UA,
+    ENERGY_DEFAULT_SD_UA,
+};
+
+static const char * const accountNames[ENERGY_NUM_ACCOUNTS] = {
+    "active",
+    "lpm0",
+    "lpm3",
+    "lpm4",
+    "backlight",
+    "adc",
+    "accel",
+    "sd",
+};
+
+// Forward declared functions
+static void Energy_closeActive(uint32_t now);
+static void Energy_closeLoad(uint8_t index, uint32_t now);
+static void Energy_closeAll(void);
+static void Energy_clockChanged(void);
+
+/***************************************************************************//**
+ * @brief  Book the active period up to now. Interrupts must be disabled.
+ * @param  now  Timer_now()
+ * @return none
+ ******************************************************************************/
+
+static void Energy_closeActive(uint32_t now)
+{
+    uint32_t elapsed = now - cpuMark;
+
+    ticks[ENERGY_ACTIVE] += elapsed;
+    activeKhzTicks += (uint64_t)elapsed * mclkKhz;
+    cpuMark = now;
+}
+
+/***************************************************************************//**
+ * @brief  Book the on-time of a load up to now. Interrupts must be disabled.
+ * @param  index  Load index, account - FIRST_LOAD
+ * @param  now    Timer_now()
+ * @return none
+ ******************************************************************************/
+
+static void Energy_closeLoad(uint8_t index, uint32_t now)
+{
+    uint32_t elapsed = now - loadMarks[index];
+
+    if (loadPermille[index] == ENERGY_FULL_LOAD)
+        ticks[FIRST_LOAD + index] += elapsed;
+    else if (loadPermille[index])
+        ticks[FIRST_LOAD + index] += (uint64_t)elapsed * loadPermille[index] / ENERGY_FULL_LOAD;
+    loadMarks[index] = now;
+}
+
+/***************************************************************************//**
+ * @brief  Book all open periods up to now, so the counters are current
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Energy_closeAll(void)
+{
+    uint16_t gie = __get_SR_register() & GIE;   // Store current GIE state
+    uint32_t now;
+    uint8_t i;
+
+    __disable_interrupt();
+    if (initialized)
+    {
+        now = Timer_now();
+        Energy_closeActive(now);
+        for (i = 0; i < NUM_LOADS; i++)
+            Energy_closeLoad(i, now);
+    }
+    __bis_SR_register(gie);                     // Restore original GIE state
+}
+
+/***************************************************************************//**
+ * @brief  Clock change callback: book the active time at the old frequency
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Energy_clockChanged(void)
+{
+    uint16_t gie = __get_SR_register() & GIE;   // Store current GIE state
+
+    __disable_interrupt();
+    Energy_closeActive(Timer_now());
+    mclkKhz = UCS_getMclkFrequency() / 1000;
+    __bis_SR_register(gie);                     // Restore original GIE state
+}
+
+/***************************************************************************//**
+ * @brief  Start accounting. Loads set before are accounted from now on.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Energy_init(void)
+{
+    if (initialized)
+        return;
+
+    Timer_init();
+    mclkKhz = UCS_getMclkFrequency() / 1000;
+    UCS_addClockCallback(Energy_clockChanged);
+    initialized = 1;
+    Energy_reset();
+}
+
+/***************************************************************************//**
+ * @brief  Clear all counters; the current CPU state and load levels are kept
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Energy_reset(void)
+{
+    uint16_t gie = __get_SR_register() & GIE;   // Store current GIE state
+    uint8_t i;
+
+    __disable_interrupt();
+    resetMark = Timer_now();
+    cpuMark = resetMark;
+    activeKhzTicks = 0;
+    for (i = 0; i < ENERGY_NUM_ACCOUNTS; i++)
+        ticks[i] = 0;
+    for (i = 0; i < NUM_LOADS; i++)
+        loadMarks[i] = resetMark;
+    __bis_SR_register(gie);                     // Restore original GIE state
+}
+
+/***************************************************************************//**
+ * @brief  Enter a low-power mode and book the time spent in it.
+ *
+ *         Call with interrupts disabled after checking the wake condition;
+ *         returns with interrupts enabled once an ISR has woken the CPU.
+ * @param  lpmBits  LPM0_bits, LPM3_bits or LPM4_bits
+ * @return none
+ ******************************************************************************/
+
+void Energy_sleep(uint16_t lpmBits)
+{
+    uint8_t state;
+    uint32_t now;
+
+    if (!initialized)
+    {
+        __bis_SR_register(lpmBits + GIE);
+        return;
+    }
+
+    if (lpmBits & OSCOFF)
+        state = ENERGY_LPM4;
+    else if (lpmBits & SCG1)
+        state = ENERGY_LPM3;
+    else
+        state = ENERGY_LPM0;
+
+    Energy_closeActive(Timer_now());
+
+    __bis_SR_register(lpmBits + GIE);
+
+    __disable_interrupt();
+    now = Timer_now();
+    ticks[state] += now - cpuMark;
+    cpuMark = now;
+    __enable_interrupt();
+}
+
+/***************************************************************************//**
+ * @brief  Report the level of a load after switching it
+ * @param  load      ENERGY_BACKLIGHT, ENERGY_ADC, ENERGY_ACCEL or ENERGY_SD
+ * @param  permille  0 for off up to ENERGY_FULL_LOAD
+ * @return none
+ ******************************************************************************/
+
+void Energy_setLoad(uint8_t load, uint16_t permille)
+{
+    uint16_t gie = __get_SR_register() & GIE;   // Store current GIE state
+    uint8_t index = load - FIRST_LOAD;
+
+    if (load < FIRST_LOAD || load >= ENERGY_NUM_ACCOUNTS)
+        return;
+    if (permille > ENERGY_FULL_LOAD)
+        permille = ENERGY_FULL_LOAD;
+
+    __disable_interrupt();
+    if (initialized)
+        Energy_closeLoad(index, Timer_now());
+    loadPermille[index] = permille;
+    __bis_SR_register(gie);                     // Restore original GIE state
+}
+
+/***************************************************************************//**
+ * @brief  Get the time since the last reset
+ * @param  none
+ * @return Ticks
+ ******************************************************************************/
+
+uint32_t Energy_getElapsed(void)
+{
+    return initialized ? Timer_now() - resetMark : 0;
+}
+
+/***************************************************************************//**
+ * @brief  Get the time booked to an account since the last reset
+ * @param  account  ENERGY_ACTIVE ... ENERGY_SD
+ * @return Ticks; for loads the full load equivalent
+ ******************************************************************************/
+
+uint32_t Energy_getTicks(uint8_t account)
+{
+    if (account >= ENERGY_NUM_ACCOUNTS)
+        return 0;
+
+    Energy_closeAll();
+
+    return ticks[account];
+}
+
+/***************************************************************************//**
+ * @brief  Estimate the charge drawn by an account since the last reset
+ * @param  account  ENERGY_ACTIVE ... ENERGY_SD
+ * @return Microcoulomb (uA s)
+ ******************************************************************************/
+
+uint32_t Energy_getCharge(uint8_t account)
+{
+    uint64_t frequency = Timer_getFrequency();
+
+    if (account >= ENERGY_NUM_ACCOUNTS)
+        return 0;
+
+    Energy_closeAll();
+
+    if (account == ENERGY_ACTIVE)
+        return activeKhzTicks * currents[ENERGY_ACTIVE] / (frequency * 1000);
+
+    return (uint64_t)ticks[account] * currents[account] / frequency;
+}
+
+/***************************************************************************//**
+ * @brief  Get the current configured for an account
+ * @param  account  ENERGY_ACTIVE ... ENERGY_SD
+ * @return Microamps; per MHz of MCLK for ENERGY_ACTIVE
+ ******************************************************************************/
+
+uint32_t Energy_getCurrent(uint8_t account)
+{
+    return account < ENERGY_NUM_ACCOUNTS ? currents[account] : 0;
+}
+
+/***************************************************************************//**
+ * @brief  Set the current of an account, e.g. from a measurement. Applies to
+ *         the time already booked as well.
+ * @param  account    ENERGY_ACTIVE ... ENERGY_SD
+ * @param  microamps  Microamps; per MHz of MCLK for ENERGY_ACTIVE
+ * @return 1 on success, 0 if account is out of range
+ ******************************************************************************/
+
+uint8_t Energy_setCurrent(uint8_t account, uint32_t microamps)
+{
+    if (account >= ENERGY_NUM_ACCOUNTS || microamps > 1000000)
+        return 0;
+
+    currents[account] = microamps;
+
+    return 1;
+}
+
+/***************************************************************************//**
+ * @brief  Get the name of an account
+ * @param  account  ENERGY_ACTIVE ... ENERGY_SD
+ * @return Name, "?" if unknown
+ ******************************************************************************/
+
+const char *Energy_getName(uint8_t account)
+{
+    return account < ENERGY_NUM_ACCOUNTS ? accountNames[account] : "?";
+}
+
+/***************************************************************************//**
+ * @brief  Convert ticks to milliseconds
+ * @param  count  Timer_now() ticks
+ * @return Milliseconds
+ ******************************************************************************/
+
+uint32_t Energy_toMilliseconds(uint32_t count)
+{
+    return (uint64_t)count * 1000 / Timer_getFrequency();
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
@@ -0,0 +1,104 @@
+/*******************************************************************************
+ *
+ *  HAL_Energy.h
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef HAL_ENERGY_H
+#define HAL_ENERGY_H
+
+#include <stdint.h>
+
+// Set to 0 to compile the energy accounting out
+#ifndef ENERGY_ENABLED
+#define ENERGY_ENABLED          1
+#endif
+
+// Accounts: the CPU is in exactly one of the first four, the loads are
+// switched on and off independently.
+//
+// Limitation: an ISR that runs while the CPU sleeps and returns to the LPM
+// is booked to that LPM, not to ENERGY_ACTIVE; only the ISR that wakes the
+// main loop ends the sleep period. In LPM0 that includes the TA1 cycle
+// counter overflow (SMCLK / 65536, about 381 Hz at 25 MHz) and the
+// HAL_Latency probe (about 2.5 kHz at 25 MHz) while it runs; in LPM3 the
+// TA2 timers whose handler does not wake the CPU, e.g. button debouncing.
+// ENERGY_ACTIVE is under-reported, and the LPM account over-reported, by
+// the time those ISRs take.
+#define ENERGY_ACTIVE           0      // CPU running, including busy-waits and ISRs while awake
+#define ENERGY_LPM0             1
+#define ENERGY_LPM3             2
+#define ENERGY_LPM4             3
+#define ENERGY_BACKLIGHT        4      // LCD backlight LED, weighted by PWM duty
+#define ENERGY_ADC              5      // ADC12 and reference powered
+#define ENERGY_ACCEL            6      // CMA3000 power pin high
+#define ENERGY_SD               7      // SD card selected
+#define ENERGY_NUM_ACCOUNTS     8
+#define ENERGY_NUM_CPU_STATES   4
+
+#define ENERGY_FULL_LOAD        1000   // Permille for Energy_setLoad()
+
+// Default currents in uA, ENERGY_ACTIVE in uA per MHz of MCLK; typical
+// datasheet values at 3 V, adjust with Energy_setCurrent()
+#define ENERGY_DEFAULT_ACTIVE_UA_PER_MHZ    360
+#define ENERGY_DEFAULT_LPM0_UA              90
+#define ENERGY_DEFAULT_LPM3_UA              3
+#define ENERGY_DEFAULT_LPM4_UA              2
+#define ENERGY_DEFAULT_BACKLIGHT_UA         15000
+#define ENERGY_DEFAULT_ADC_UA               300
+#define ENERGY_DEFAULT_ACCEL_UA             50
+#define ENERGY_DEFAULT_SD_UA                30000
+
+#if ENERGY_ENABLED
+// Replaces __bis_SR_register(lpmBits + GIE) in wait loops; call with
+// interrupts disabled, returns with interrupts enabled
+#define ENERGY_SLEEP(lpmBits)           Energy_sleep(lpmBits)
+#define ENERGY_SET_LOAD(load, permille) Energy_setLoad((load), (permille))
+#else
+#define ENERGY_SLEEP(lpmBits)           __bis_SR_register((lpmBits) + GIE)
+#define ENERGY_SET_LOAD(load, permille)
+#endif
+
+extern void Energy_init(void);
+extern void Energy_reset(void);
+extern void Energy_sleep(uint16_t lpmBits);
+extern void Energy_setLoad(uint8_t load, uint16_t permille);
+extern uint32_t Energy_getElapsed(void);
+extern uint32_t Energy_getTicks(uint8_t account);
+extern uint32_t Energy_getCharge(uint8_t account);
+extern uint32_t Energy_getCurrent(uint8_t account);
+extern uint8_t Energy_setCurrent(uint8_t account, uint32_t microamps);
+extern const char *Energy_getName(uint8_t account);
+extern uint32_t Energy_toMilliseconds(uint32_t count);
+
+#endif /* HAL_ENERGY_H */
@@ -0,0 +1,432 @@
+/*******************************************************************************
+ *
+ *  HAL_EventLatency.c - Sensor to pixel latency statistics
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_EventLatency.c
+ * @addtogroup HAL_EventLatency
+ * @{
+ *
+ * End-to-end latency from a physical event to the pixels showing it.
+ *
+ * The event is stamped with Timer_now() where it enters the system: in the
+ * port ISR for a button edge, in Cma3000_readAccel() for a sample. The stamp
+ * travels with the event through Work_postStamped(), and the handler passes
+ * Work_getStamp() to EventLatency_record() once its last LCD transfer has
+ * returned. The Dogs102x6 writes are polled until UCBUSY clears, so that is
+ * when the pixels are on the display.
+ *
+ * Timer_now() counts ACLK, which keeps running in LPM3 while the button
+ * service debounces; the cycle counter would stop there. The resolution is
+ * one ACLK period.
+ *
+ * EventLatency_startAccel() is the benchmark mode for the accelerometer: a
+ * scheduler task reads a sample at the given rate and the value is drawn
+ * from the work queue. The period is programmed in timer ticks, so rates
+ * like 400 Hz are not rounded to whole milliseconds;
+ * EventLatency_getAccelPeriod() tells the period actually used. With
+ * EventLatency_setAccelFrames() the samples are also streamed over AppUart,
+ * batched into APPFRAME_TYPE_ACCEL frames for tools/appframe_decode.py.
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_AppFrame.h"
+#include "HAL_Cma3000.h"
+#include "HAL_Dogs102x6.h"
+#include "HAL_Scheduler.h"
+#include "HAL_Timer.h"
+#include "HAL_UCS.h"
+#include "HAL_Work.h"
+#include "HAL_EventLatency.h"
+
+#define ACCEL_ROW           3          // Below the number shown by main.c
+#define ACCEL_BUDGET_SHARE  4          // Sampling may use 1/4 of its period
+
+static EventLatencyStats stats[EVENTLATENCY_NUM_SOURCES];
+static int8_t accelBatch[APPFRAME_ACCEL_MAX_SAMPLES * 3];   // x, y, z triplets
+const uint16_t EventLatency_ramSize = sizeof(stats) + sizeof(accelBatch);
+static uint8_t accelTask = SCHEDULER_INVALID_TASK;
+static uint8_t accelFrameSamples = 0;       // Samples per frame, 0 = no frames
+static uint8_t accelBatchSize = 0;          // Bytes in accelBatch
+
+static const char * const sourceNames[EVENTLATENCY_NUM_SOURCES] = {
+    "button",
+    "accel",
+};
+
+// Forward declared functions
+static uint16_t EventLatency_bin(uint32_t ticks);
+static uint32_t EventLatency_binLimit(uint16_t bin);
+static void EventLatency_accelTask(void);
+static void EventLatency_accelFrame(void);
+static char *EventLatency_formatAxis(char *pText, char axis, int8_t value);
+static void EventLatency_accelDraw(uint16_t arg);
+
+/***************************************************************************//**
+ * @brief  Get the histogram bin of a latency
+ * @param  ticks  Latency in Timer_now() ticks
+ * @return Bin index
+ ******************************************************************************/
+
+static uint16_t EventLatency_bin(uint32_t ticks)
+{
+    uint8_t msb = EVENTLATENCY_SUB_BITS;
+
+    if (ticks < (1UL << EVENTLATENCY_SUB_BITS))
+        return ticks;
+    if (ticks >= (1UL << EVENTLATENCY_RANGE_BITS))
+        return EVENTLATENCY_BINS - 1;
+
+    while (ticks >> (msb + 1))
+        msb++;
+
+    return ((msb - EVENTLATENCY_SUB_BITS + 1) << EVENTLATENCY_SUB_BITS) |
+           ((ticks >> (msb - EVENTLATENCY_SUB_BITS)) & ((1 << EVENTLATENCY_SUB_BITS) - 1));
+}
+
+/***************************************************************************//**
+ * @brief  Get the largest latency that falls into a bin
+ * @param  bin  Bin index
+ * @return Ticks
+ ******************************************************************************/
+
+static uint32_t EventLatency_binLimit(uint16_t bin)
+{
+    uint8_t shift;
+    uint32_t mantissa;
+
+    if (bin < (1 << EVENTLATENCY_SUB_BITS))
+        return bin;
+
+    shift = (bin >> EVENTLATENCY_SUB_BITS) - 1;
+    mantissa = (1 << EVENTLATENCY_SUB_BITS) | (bin & ((1 << EVENTLATENCY_SUB_BITS) - 1));
+
+    return ((mantissa + 1) << shift) - 1;
+}
+
+/***************************************************************************//**
+ * @brief  Clear all statistics
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void EventLatency_reset(void)
+{
+    uint16_t gie = __get_SR_register() & GIE;   // Store current GIE state
+    uint16_t i;
+    uint8_t source;
+
+    __disable_interrupt();
+    for (source = 0; source < EVENTLATENCY_NUM_SOURCES; source++)
+    {
+        stats[source].count = 0;
+        stats[source].max = 0;
+        for (i = 0; i < EVENTLATENCY_BINS; i++)
+            stats[source].histogram[i] = 0;
+    }
+    __bis_SR_register(gie);                     // Restore original GIE state
+}
+
+/***************************************************************************//**
+ * @brief  Record the latency of an event whose pixels are now on the display
+ * @param  source  EVENTLATENCY_xxx
+ * @param  stamp   Timer_now() when the event happened, usually Work_getStamp()
+ * @return none
+ ******************************************************************************/
+
+void EventLatency_record(uint8_t source, uint32_t stamp)
+{
+#if EVENTLATENCY_ENABLED
+    uint32_t ticks = Timer_now() - stamp;
+    EventLatencyStats *pStats = &stats[source];
+    uint16_t bin = EventLatency_bin(ticks);
+
+    pStats->count++;
+    if (ticks > pStats->max)
+        pStats->max = ticks;
+    if (pStats->histogram[bin] != 0xFFFF)
+        pStats->histogram[bin]++;
+#endif
+}
+
+/***************************************************************************//**
+ * @brief  Get the statistics of one source
+ * @param  source  EVENTLATENCY_xxx
+ * @return Event count, maximum and histogram, all in ticks
+ ******************************************************************************/
+
+const EventLatencyStats *EventLatency_getStats(uint8_t source)
+{
+    return &stats[source];
+}
+
+/***************************************************************************//**
+ * @brief  Get a latency percentile
+ *
+ *         The result is the upper edge of the histogram bin the percentile
+ *         falls into, limited to the largest latency seen.
+ * @param  source   EVENTLATENCY_xxx
+ * @param  permille Percentile in 0.1 %, e.g. 500 for the median, 999 for
+ *                  the 99.9th percentile
+ * @return Ticks, 0 if no events were recorded
+ ******************************************************************************/
+
+uint32_t EventLatency_getPercentile(uint8_t source, uint16_t permille)
+{
+    const EventLatencyStats *pStats = &stats[source];
+    uint32_t total = 0, rank, seen = 0, limit;
+    uint16_t bin;
+
+    // The bins may have saturated, so count them rather than use count
+    for (bin = 0; bin < EVENTLATENCY_BINS; bin++)
+        total += pStats->histogram[bin];
+    if (total == 0)
+        return 0;
+
+    rank = (total * permille + 999) / 1000;
+    if (rank == 0)
+        rank = 1;
+
+    for (bin = 0; bin < EVENTLATENCY_BINS - 1; bin++)
+    {
+        seen += pStats->histogram[bin];
+        if (seen >= rank)
+            break;
+    }
+
+    // The last bin is open ended
+    limit = bin == EVENTLATENCY_BINS - 1 ? pStats->max : EventLatency_binLimit(bin);
+    return limit < pStats->max ? limit : pStats->max;
+}
+
+/***************************************************************************//**
+ * @brief  Convert Timer_now() ticks to microseconds
+ * @param  ticks  Ticks
+ * @return Microseconds
+ ******************************************************************************/
+
+uint32_t EventLatency_toMicroseconds(uint32_t ticks)
+{
+    return (uint64_t)ticks * 1000000 / Timer_getFrequency();
+}
+
+/***************************************************************************//**
+ * @brief  Get the name of a source
+ * @param  source  EVENTLATENCY_xxx
+ * @return Name
+ ******************************************************************************/
+
+const char *EventLatency_getName(uint8_t source)
+{
+    return sourceNames[source];
+}
+
+/***************************************************************************//**
+ * @brief  Start or stop the accelerometer benchmark
+ *
+ *         Initializes the accelerometer if needed and draws every sample on
+ *         the display, recording EVENTLATENCY_ACCEL for each.
+ * @param  rateHz  Samples per second, 0 to stop
+ * @return 1 if running or stopped as requested, 0 if the accelerometer or
+ *         the scheduler are not available
+ ******************************************************************************/
+
+uint8_t EventLatency_startAccel(uint16_t rateHz)
+{
+    if (rateHz == 0)
+    {
+        if (accelTask != SCHEDULER_INVALID_TASK)
+            Scheduler_setPeriod(accelTask, 0);
+        return 1;
+    }
+
+    if (rateHz > 1000)
+        rateHz = 1000;
+    if (Cma3000_initPoll() != CMA3000_INIT_OK && Cma3000_init() != CMA3000_INIT_OK)
+        return 0;
+
+    if (accelTask == SCHEDULER_INVALID_TASK)
+        accelTask = Scheduler_addTask(EventLatency_accelTask, 0);
+    if (accelTask == SCHEDULER_INVALID_TASK)
+        return 0;
+
+    // Nearest whole number of ticks: 400 Hz is 82 ticks at 32768 Hz
+    Scheduler_setPeriodTicks(accelTask, (Timer_getFrequency() + rateHz / 2) / rateHz);
+
+    // A share of the period the timer actually runs at, in SMCLK cycles.
+    // Overruns are reported, not throttled: the rate is what is measured.
+    Scheduler_setBudget(accelTask,
+                        (uint64_t)EventLatency_getAccelPeriod() * UCS_getSmclkFrequency() /
+                        Timer_getFrequency() / ACCEL_BUDGET_SHARE, 0);
+    return 1;
+}
+
+/***************************************************************************//**
+ * @brief  Get the sampling period of the accelerometer benchmark
+ * @param  none
+ * @return Timer_now() ticks between samples, 0 if the benchmark is stopped
+ ******************************************************************************/
+
+uint32_t EventLatency_getAccelPeriod(void)
+{
+    if (accelTask == SCHEDULER_INVALID_TASK)
+        return 0;
+    return Scheduler_getStats(accelTask)->period;
+}
+
+/***************************************************************************//**
+ * @brief  Stream the accelerometer benchmark samples as AppFrame packets
+ * @param  samples  Samples per APPFRAME_TYPE_ACCEL frame
+ *                  (<= APPFRAME_ACCEL_MAX_SAMPLES), 0 to stop streaming
+ * @return 1 if set, 0 if samples is out of range
+ ******************************************************************************/
+
+uint8_t EventLatency_setAccelFrames(uint8_t samples)
+{
+    if (samples > APPFRAME_ACCEL_MAX_SAMPLES)
+        return 0;
+
+    accelFrameSamples = samples;
+    accelBatchSize = 0;
+    return 1;
+}
+
+/***************************************************************************//**
+ * @brief  Get the number of samples per accelerometer frame
+ * @param  none
+ * @return Samples per frame, 0 if not streaming
+ ******************************************************************************/
+
+uint8_t EventLatency_getAccelFrames(void)
+{
+    return accelFrameSamples;
+}
+
+/***************************************************************************//**
+ * @brief  Benchmark task - reads a sample and hands it to the drawing side
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void EventLatency_accelTask(void)
+{
+    Cma3000_readAccel();
+    Work_postStamped(EventLatency_accelDraw, 0, Cma3000_readTime);
+
+    if (accelFrameSamples)
+        EventLatency_accelFrame();
+}
+
+/***************************************************************************//**
+ * @brief  Add the last sample to the batch and send the batch once full. A
+ *         frame the TX ring has no room for is dropped; the host sees the
+ *         sequence gap.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void EventLatency_accelFrame(void)
+{
+    accelBatch[accelBatchSize++] = Cma3000_xAccel;
+    accelBatch[accelBatchSize++] = Cma3000_yAccel;
+    accelBatch[accelBatchSize++] = Cma3000_zAccel;
+
+    if (accelBatchSize >= accelFrameSamples * 3)
+    {
+        AppFrame_send(APPFRAME_TYPE_ACCEL, (const uint8_t *)accelBatch, accelBatchSize);
+        accelBatchSize = 0;
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Formats one axis as the name and a right aligned value, "X -12"
+ * @param  pText  Destination, 5 characters
+ * @param  axis   Axis name
+ * @param  value  Acceleration
+ * @return Pointer past the last character written
+ ******************************************************************************/
+
+static char *EventLatency_formatAxis(char *pText, char axis, int8_t value)
+{
+    uint8_t magnitude = value < 0 ? -value : value;
+    uint8_t i;
+
+    pText[0] = axis;
+    for (i = 4; i > 0; i--)
+    {
+        if (i == 4 || magnitude)
+        {
+            pText[i] = '0' + magnitude % 10;
+            magnitude /= 10;
+        }
+        else if (value < 0)
+        {
+            pText[i] = '-';
+            value = 0;
+        }
+        else
+        {
+            pText[i] = ' ';
+        }
+    }
+
+    return pText + 5;
+}
+
+/***************************************************************************//**
+ * @brief  Draws the last sample and records its latency
+ * @param  arg  Unused
+ * @return none
+ ******************************************************************************/
+
+static void EventLatency_accelDraw(uint16_t arg)
+{
+    char text[18];
+    char *pText = text;
+
+    pText = EventLatency_formatAxis(pText, 'X', Cma3000_xAccel);
+    *pText++ = ' ';
+    pText = EventLatency_formatAxis(pText, 'Y', Cma3000_yAccel);
+    *pText++ = ' ';
+    pText = EventLatency_formatAxis(pText, 'Z', Cma3000_zAccel);
+    *pText = '\0';
+
+    Dogs102x6_stringDraw(ACCEL_ROW, 0, text, DOGS102x6_DRAW_NORMAL);
+
+    EventLatency_record(EVENTLATENCY_ACCEL, Work_getStamp());
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
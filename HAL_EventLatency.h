@@ -0,0 +1,80 @@
+/*******************************************************************************
+ *
+ *  HAL_EventLatency.h
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef HAL_EVENTLATENCY_H
+#define HAL_EVENTLATENCY_H
+
+#include <stdint.h>
+
+// Set to 0 to compile the event time stamps out
+#ifndef EVENTLATENCY_ENABLED
+#define EVENTLATENCY_ENABLED    1
+#endif
+
+// Event sources
+#define EVENTLATENCY_BUTTON     0      // Port ISR edge to the handler's last LCD write
+#define EVENTLATENCY_ACCEL      1      // Cma3000_readAccel() to the value drawn
+#define EVENTLATENCY_NUM_SOURCES 2
+
+// Logarithmic histogram of Timer_now() ticks: the first 8 bins are exact,
+// then each power of two is split in 8 bins (12.5 % wide). Latencies of
+// 2^EVENTLATENCY_RANGE_BITS ticks and more land in the last bin.
+#define EVENTLATENCY_SUB_BITS   3
+#define EVENTLATENCY_RANGE_BITS 24
+#define EVENTLATENCY_BINS       ((EVENTLATENCY_RANGE_BITS - EVENTLATENCY_SUB_BITS + 1) << EVENTLATENCY_SUB_BITS)
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t max;                      // Ticks
+    uint16_t histogram[EVENTLATENCY_BINS];     // Saturating
+} EventLatencyStats;
+
+// Static RAM of the histograms and the accelerometer frame batch
+extern const uint16_t EventLatency_ramSize;
+
+extern void EventLatency_reset(void);
+extern void EventLatency_record(uint8_t source, uint32_t stamp);
+extern const EventLatencyStats *EventLatency_getStats(uint8_t source);
+extern uint32_t EventLatency_getPercentile(uint8_t source, uint16_t permille);
+extern uint32_t EventLatency_toMicroseconds(uint32_t ticks);
+extern const char *EventLatency_getName(uint8_t source);
+extern uint8_t EventLatency_startAccel(uint16_t rateHz);
+extern uint32_t EventLatency_getAccelPeriod(void);
+extern uint8_t EventLatency_setAccelFrames(uint8_t samples);
+extern uint8_t EventLatency_getAccelFrames(void);
+
+#endif /* HAL_EVENTLATENCY_H */
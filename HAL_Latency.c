@@ -0,0 +1,286 @@
+/*******************************************************************************
+ *
+ *  HAL_Latency.c - Interrupt-disabled window and ISR latency tracker
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_Latency.c
+ * @addtogroup HAL_Latency
+ * @{
+ *
+ * Two tables of worst offenders are kept, each with at most one entry per
+ * call site:
+ * - critical sections: how long interrupts stayed disabled,
+ * - ISR latency: a periodic TA1 compare interrupt measures how late its ISR
+ *   ran. A late probe is blamed on the critical section that ended just
+ *   before it, or on LATENCY_SITE_NONE (another ISR was running) otherwise.
+ *
+ * A critical section longer than one TA1 period makes HAL_Cycles miss
+ * overflows; its duration is corrected with Cycles_elapsed(). The probe only
+ * sees the low 16 bits of its lateness, which are unwrapped when a critical
+ * section is to blame. Delays caused by ISRs and untimed sections are good to
+ * 65535 cycles.
+ *
+ * The probe needs SMCLK, so latency is only sampled while the CPU is awake
+ * or in LPM0.
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_Cycles.h"
+#include "HAL_Timer.h"
+#include "HAL_Latency.h"
+
+static LatencyEntry criticalTable[LATENCY_WORST_N];
+static LatencyEntry isrTable[LATENCY_WORST_N];
+const uint16_t Latency_ramSize = sizeof(criticalTable) + sizeof(isrTable);
+static uint32_t probeCount = 0;
+
+static uint32_t criticalStart;
+static uint32_t criticalStartTicks;
+static volatile uint16_t lastSite = LATENCY_SITE_NONE;
+static volatile uint32_t lastExit;
+static volatile uint32_t lastDuration;
+
+static const char * const fileNames[LATENCY_NUM_FILES] = {
+    "?",                                    // LATENCY_FILE_UNKNOWN
+    "HAL_Dogs102x6.c",                      // LATENCY_FILE_DOGS102X6
+    "HAL_SDCard.c"                          // LATENCY_FILE_SDCARD
+};
+
+// Forward declared functions
+static void Latency_update(LatencyEntry *pTable, uint16_t site, uint32_t cycles);
+static void Latency_probe(uint16_t lateness);
+
+/***************************************************************************//**
+ * @brief  Clear the tables and start the latency probe. Cycles_init() must
+ *         have been called.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Latency_init(void)
+{
+    Latency_reset();
+    Cycles_startProbe(LATENCY_PROBE_PERIOD, Latency_probe);
+}
+
+/***************************************************************************//**
+ * @brief  Clear both offender tables
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Latency_reset(void)
+{
+    uint16_t gie = __get_SR_register() & GIE;   // Store current GIE state
+    uint8_t i;
+
+    __disable_interrupt();
+    for (i = 0; i < LATENCY_WORST_N; i++)
+    {
+        criticalTable[i].count = 0;
+        isrTable[i].count = 0;
+    }
+    probeCount = 0;
+    __bis_SR_register(gie);                     // Restore original GIE state
+}
+
+/***************************************************************************//**
+ * @brief  Time stamp the start of a critical section. Called with
+ *         interrupts disabled through LATENCY_CRITICAL_ENTER().
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Latency_criticalEnter(void)
+{
+    criticalStartTicks = Timer_now();
+    criticalStart = Cycles_now();
+}
+
+/***************************************************************************//**
+ * @brief  Record the end of a critical section. Called with interrupts
+ *         still disabled through LATENCY_CRITICAL_EXIT().
+ * @param  site  LATENCY_SITE of the section
+ * @return none
+ ******************************************************************************/
+
+void Latency_criticalExit(uint16_t site)
+{
+    uint32_t now = Cycles_now();
+    uint32_t cycles = now - criticalStart;
+
+    // Interrupts have been off since the start, so unless an overflow is
+    // pending TA1 has not wrapped and the count is exact
+    if (Cycles_overflowPending())
+        cycles = Cycles_elapsed(criticalStart, criticalStartTicks);
+
+    Latency_update(criticalTable, site, cycles);
+    lastSite = site;
+    lastExit = now;
+    lastDuration = cycles;
+}
+
+/***************************************************************************//**
+ * @brief  Get an entry of the critical section table
+ * @param  index  0 ... LATENCY_WORST_N - 1, in no particular order
+ * @return Entry, or 0 if unused
+ ******************************************************************************/
+
+const LatencyEntry *Latency_getCritical(uint8_t index)
+{
+    if (index >= LATENCY_WORST_N || criticalTable[index].count == 0)
+        return 0;
+    return &criticalTable[index];
+}
+
+/***************************************************************************//**
+ * @brief  Get an entry of the ISR latency table
+ * @param  index  0 ... LATENCY_WORST_N - 1, in no particular order
+ * @return Entry, or 0 if unused
+ ******************************************************************************/
+
+const LatencyEntry *Latency_getIsr(uint8_t index)
+{
+    if (index >= LATENCY_WORST_N || isrTable[index].count == 0)
+        return 0;
+    return &isrTable[index];
+}
+
+/***************************************************************************//**
+ * @brief  Get the number of latency probes taken since the last reset
+ * @param  none
+ * @return Probe count
+ ******************************************************************************/
+
+uint32_t Latency_getProbeCount(void)
+{
+    return probeCount;
+}
+
+/***************************************************************************//**
+ * @brief  Get the name of the file a call site is in
+ * @param  site  LATENCY_SITE value
+ * @return File name
+ ******************************************************************************/
+
+const char *Latency_getFileName(uint16_t site)
+{
+    if (LATENCY_SITE_FILE(site) >= LATENCY_NUM_FILES)
+        return fileNames[LATENCY_FILE_UNKNOWN];
+    return fileNames[LATENCY_SITE_FILE(site)];
+}
+
+/***************************************************************************//**
+ * @brief  Account a duration to a site: update its entry, or take a free
+ *         entry, or replace the entry with the smallest worst case if the new
+ *         duration is larger. Must be called with interrupts disabled.
+ * @param  pTable  criticalTable or isrTable
+ * @param  site    Call site
+ * @param  cycles  Duration
+ * @return none
+ ******************************************************************************/
+
+static void Latency_update(LatencyEntry *pTable, uint16_t site, uint32_t cycles)
+{
+    LatencyEntry *pVictim = 0;
+    uint8_t i;
+
+    for (i = 0; i < LATENCY_WORST_N; i++)
+    {
+        if (pTable[i].count && pTable[i].site == site)
+        {
+            if (pTable[i].count != 0xFFFF)
+                pTable[i].count++;
+            if (cycles > pTable[i].worst)
+                pTable[i].worst = cycles;
+            return;
+        }
+        if (!pTable[i].count)
+        {
+            if (!pVictim || pVictim->count)
+                pVictim = &pTable[i];
+        }
+        else if (!pVictim || (pVictim->count && pTable[i].worst < pVictim->worst))
+        {
+            pVictim = &pTable[i];
+        }
+    }
+
+    if (pVictim->count && cycles <= pVictim->worst)
+        return;
+
+    pVictim->site = site;
+    pVictim->count = 1;
+    pVictim->worst = cycles;
+}
+
+/***************************************************************************//**
+ * @brief  Latency probe handler, called from the TA1 ISR
+ * @param  lateness  Cycles between the compare match and the ISR
+ * @return none
+ ******************************************************************************/
+
+static void Latency_probe(uint16_t lateness)
+{
+    uint16_t site = LATENCY_SITE_NONE;
+    uint32_t sinceExit = Cycles_now() - lastExit;
+    uint32_t sinceStart;
+    uint32_t cycles = lateness;
+
+    probeCount++;
+
+    if (lastSite != LATENCY_SITE_NONE)
+    {
+        if (lastDuration >= LATENCY_PROBE_PERIOD)
+        {
+            // The probe was armed before the section and came due at most one
+            // period into it, well within half a TA1 period of its start;
+            // that fixes the multiples of 65536 cycles the lateness lost
+            sinceStart = lastDuration + sinceExit;
+            cycles = sinceStart - (int16_t)(sinceStart - lateness);
+            site = lastSite;
+        }
+        else if (sinceExit <= lateness)
+        {
+            site = lastSite;                    // Ended while the probe was pending
+        }
+    }
+    lastSite = LATENCY_SITE_NONE;
+
+    Latency_update(isrTable, site, cycles);
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
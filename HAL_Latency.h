@@ -0,0 +1,90 @@
+/*******************************************************************************
+ *
+ *  HAL_Latency.h
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef HAL_LATENCY_H
+#define HAL_LATENCY_H
+
+#include <stdint.h>
+
+// Set to 0 to compile the critical section hooks out
+#ifndef LATENCY_ENABLED
+#define LATENCY_ENABLED         1
+#endif
+
+#define LATENCY_WORST_N         8      // Offenders kept per table
+#define LATENCY_PROBE_PERIOD    10007  // Cycles, prime so it drifts against periodic work
+
+// Call-site ids: the instrumented file (define LATENCY_FILE before use) and
+// line number
+#define LATENCY_FILE_UNKNOWN    0
+#define LATENCY_FILE_DOGS102X6  1
+#define LATENCY_FILE_SDCARD     2
+#define LATENCY_NUM_FILES       3
+#define LATENCY_SITE            ((LATENCY_FILE << 12) | (__LINE__ & 0x0FFF))
+#define LATENCY_SITE_FILE(site) ((site) >> 12)
+#define LATENCY_SITE_LINE(site) ((site) & 0x0FFF)
+#define LATENCY_SITE_NONE       0      // No critical section was to blame
+
+#if LATENCY_ENABLED
+// Place after __disable_interrupt() and before restoring GIE; gie is the
+// saved GIE state, sections entered with interrupts already off are not timed
+#define LATENCY_CRITICAL_ENTER(gie) do { if (gie) Latency_criticalEnter(); } while (0)
+#define LATENCY_CRITICAL_EXIT(gie)  do { if (gie) Latency_criticalExit(LATENCY_SITE); } while (0)
+#else
+#define LATENCY_CRITICAL_ENTER(gie)
+#define LATENCY_CRITICAL_EXIT(gie)
+#endif
+
+typedef struct
+{
+    uint16_t site;                     // LATENCY_SITE of the offender
+    uint16_t count;                    // Occurrences, saturating
+    uint32_t worst;                    // Cycles
+} LatencyEntry;
+
+// Static RAM of the worst-case tables
+extern const uint16_t Latency_ramSize;
+
+extern void Latency_init(void);
+extern void Latency_reset(void);
+extern void Latency_criticalEnter(void);
+extern void Latency_criticalExit(uint16_t site);
+extern const LatencyEntry *Latency_getCritical(uint8_t index);
+extern const LatencyEntry *Latency_getIsr(uint8_t index);
+extern uint32_t Latency_getProbeCount(void);
+extern const char *Latency_getFileName(uint16_t site);
+
+#endif /* HAL_LATENCY_H */
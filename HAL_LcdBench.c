@@ -0,0 +1,200 @@
+/*******************************************************************************
+ *
+ *  HAL_LcdBench.c - Dogs102x6 SPI transaction benchmark
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_LcdBench.c
+ * @addtogroup HAL_LcdBench
+ * @{
+ *
+ * SPI cost of the Dogs102x6 drawing primitives. Each workload is run once
+ * with the driver's transaction counters cleared; the result gives the bytes
+ * sent, chip select windows, address sequences, the time those bytes take
+ * on the wire at the UCB1 divider in use, and the cycles the call took.
+ *
+ * Dogs102x6_init() and Cycles_init() must have been called. The workloads
+ * draw over the whole screen. In DOGS102x6_DRAW_ON_REFRESH mode only the
+ * "refresh" workload sends anything.
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_Cycles.h"
+#include "HAL_Dogs102x6.h"
+#include "HAL_UCS.h"
+#include "HAL_LcdBench.h"
+
+typedef struct
+{
+    const char *name;
+    void (*run)(void);
+} LcdBenchWorkload;
+
+// 16 x 16 pixel image: width, height in pages, then one byte per column and page
+static const uint8_t benchImage[2 + 16 * 2] = {
+    16, 2,
+    0xE0, 0x18, 0x04, 0x02, 0x32, 0x31, 0x01, 0x01, 0x01, 0x01, 0x31, 0x32, 0x02, 0x04, 0x18, 0xE0,
+    0x07, 0x18, 0x20, 0x40, 0x48, 0x90, 0xA0, 0xA0, 0xA0, 0xA0, 0x90, 0x48, 0x40, 0x20, 0x18, 0x07
+};
+
+// Forward declared functions
+static void LcdBench_clear(void);
+static void LcdBench_string(void);
+static void LcdBench_charXY(void);
+static void LcdBench_lineHorizontal(void);
+static void LcdBench_lineVertical(void);
+static void LcdBench_lineDiagonal(void);
+static void LcdBench_circleSmall(void);
+static void LcdBench_circleLarge(void);
+static void LcdBench_image(void);
+static void LcdBench_refresh(void);
+
+static const LcdBenchWorkload workloads[] = {
+    { "clear",        LcdBench_clear          },
+    { "string",       LcdBench_string         },
+    { "charxy",       LcdBench_charXY         },
+    { "line_h",       LcdBench_lineHorizontal },
+    { "line_v",       LcdBench_lineVertical   },
+    { "line_diag",    LcdBench_lineDiagonal   },
+    { "circle_r8",    LcdBench_circleSmall    },
+    { "circle_r30",   LcdBench_circleLarge    },
+    { "image16x16",   LcdBench_image          },
+    { "refresh",      LcdBench_refresh        },
+};
+
+#define NUM_WORKLOADS       (sizeof(workloads) / sizeof(workloads[0]))
+
+static void LcdBench_clear(void)
+{
+    Dogs102x6_clearScreen();
+}
+
+static void LcdBench_string(void)
+{
+    // 17 characters fill a row
+    Dogs102x6_stringDraw(0, 0, "Quick brown fox 1", DOGS102x6_DRAW_NORMAL);
+}
+
+static void LcdBench_charXY(void)
+{
+    // Not page aligned, spans two pages
+    Dogs102x6_charDrawXY(40, 21, 'A', DOGS102x6_DRAW_NORMAL);
+}
+
+static void LcdBench_lineHorizontal(void)
+{
+    Dogs102x6_lineDraw(0, 31, DOGS102x6_X_SIZE - 1, 31, DOGS102x6_DRAW_NORMAL);
+}
+
+static void LcdBench_lineVertical(void)
+{
+    Dogs102x6_lineDraw(50, 0, 50, DOGS102x6_Y_SIZE - 1, DOGS102x6_DRAW_NORMAL);
+}
+
+static void LcdBench_lineDiagonal(void)
+{
+    Dogs102x6_lineDraw(0, 0, DOGS102x6_X_SIZE - 1, DOGS102x6_Y_SIZE - 1, DOGS102x6_DRAW_NORMAL);
+}
+
+static void LcdBench_circleSmall(void)
+{
+    Dogs102x6_circleDraw(20, 40, 8, DOGS102x6_DRAW_NORMAL);
+}
+
+static void LcdBench_circleLarge(void)
+{
+    Dogs102x6_circleDraw(50, 32, 30, DOGS102x6_DRAW_NORMAL);
+}
+
+static void LcdBench_image(void)
+{
+    Dogs102x6_imageDraw(benchImage, 2, 80);
+}
+
+static void LcdBench_refresh(void)
+{
+    Dogs102x6_refresh(DOGS102x6_DRAW_IMMEDIATE);
+}
+
+/***************************************************************************//**
+ * @brief  Get the number of workloads
+ * @param  none
+ * @return Number of workloads, valid indices for LcdBench_run()
+ ******************************************************************************/
+
+uint8_t LcdBench_getCount(void)
+{
+    return NUM_WORKLOADS;
+}
+
+/***************************************************************************//**
+ * @brief  Run one workload and measure its cost
+ * @param  index    Workload, 0 ... LcdBench_getCount() - 1
+ * @param  pResult  Receives the workload name and its cost
+ * @return none
+ ******************************************************************************/
+
+void LcdBench_run(uint8_t index, LcdBenchResult *pResult)
+{
+    const Dogs102x6Stats *pStats;
+    uint32_t start, overhead, clocks;
+    uint16_t divider;
+
+    // Cost of the measurement itself
+    start = Cycles_now();
+    overhead = Cycles_now() - start;
+
+    Dogs102x6_resetStats();
+    start = Cycles_now();
+    workloads[index].run();
+    pResult->cycles = Cycles_now() - start - overhead;
+
+    pStats = Dogs102x6_getStats();
+    pResult->name = workloads[index].name;
+    pResult->bytes = pStats->bytes;
+    pResult->selects = pStats->selects;
+    pResult->addressSets = pStats->addressSets;
+
+    // 8 bit clocks per byte, each UCB1BRW SMCLK periods long
+    divider = UCB1BR0 | (UCB1BR1 << 8);
+    if (divider == 0)
+    {
+        divider = 1;
+    }
+    clocks = pStats->bytes * 8 * divider;
+    pResult->wireMicroseconds = (uint64_t)clocks * 1000000 / UCS_getSmclkFrequency();
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
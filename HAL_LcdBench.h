@@ -0,0 +1,58 @@
+/*******************************************************************************
+ *
+ *  HAL_LcdBench.h
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef HAL_LCDBENCH_H
+#define HAL_LCDBENCH_H
+
+#include <stdint.h>
+
+// Header of the result table, one LcdBench_Result per line below it
+#define LCDBENCH_COLUMNS    "name bytes selects addrsets wire_us cycles us"
+
+typedef struct
+{
+    const char *name;
+    uint32_t bytes;                    // SPI bytes sent to the display
+    uint32_t selects;                  // Chip select windows
+    uint32_t addressSets;              // Page/column address command sequences
+    uint32_t wireMicroseconds;         // bytes at the current UCB1 bit rate
+    uint32_t cycles;                   // Measured MCLK cycles for the call
+} LcdBenchResult;
+
+extern uint8_t LcdBench_getCount(void);
+extern void LcdBench_run(uint8_t index, LcdBenchResult *pResult);
+
+#endif /* HAL_LCDBENCH_H */
@@ -43,6 +43,7 @@
 #include "HAL_Dogs102x6.h"
 #include "HAL_Buttons.h"
 #include "HAL_Menu.h"
+#include "HAL_Scheduler.h"
 #include "HAL_Wheel.h"
 
 
@@ -92,6 +93,12 @@ uint8_t Menu_active(char **menuText, uint8_t numItems)
             }
             lastPosition = position;
         }
+
+        // Sleep until the next wheel result or button press
+        __disable_interrupt();
+        if (!buttonsPressed)
+            Scheduler_sleep();
+        __enable_interrupt();
     }
     return position;
 }
@@ -0,0 +1,174 @@
+/*******************************************************************************
+ *
+ *  HAL_PMM.c - Core voltage control of the power management module
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_PMM.c
+ * @addtogroup HAL_PMM
+ * @{
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_PMM.h"
+
+// Forward declared functions
+static uint8_t PMM_setVCoreUp(uint8_t level);
+static void PMM_setVCoreDown(uint8_t level);
+
+/***************************************************************************//**
+ * @brief  Raise VCore by one level. The high-side supervisor is moved first
+ *         to check that DVCC can support the new level.
+ * @param  level  New core voltage level, one above the current one
+ * @return PMM_STATUS_OK or PMM_STATUS_ERROR (level left unchanged)
+ ******************************************************************************/
+
+static uint8_t PMM_setVCoreUp(uint8_t level)
+{
+    uint16_t svsmhctl = SVSMHCTL;
+    uint16_t svsmlctl = SVSMLCTL;
+
+    PMMCTL0_H = PMMPW_H;                         // Open PMM registers
+
+    // Set SVM high side to the new level and check DVCC
+    PMMIFG &= ~(SVMHIFG + SVSMHDLYIFG);
+    SVSMHCTL = SVMHE + SVSHE + SVSMHRRL0 * level;
+    while (!(PMMIFG & SVSMHDLYIFG)) ;
+    if (PMMIFG & SVMHIFG)
+    {
+        // DVCC is too low for this level, restore the supervisor
+        SVSMHCTL = svsmhctl;
+        PMMIFG &= ~(SVMHIFG + SVSMHDLYIFG);
+        PMMCTL0_H = 0x00;
+        return PMM_STATUS_ERROR;
+    }
+
+    // Set SVS high side to the new level
+    SVSMHCTL = SVMHE + SVSHE + SVSHRVL0 * level + SVSMHRRL0 * level;
+
+    // Set SVM low side to the new level
+    PMMIFG &= ~(SVMLVLRIFG + SVMLIFG + SVSMLDLYIFG);
+    SVSMLCTL = SVMLE + SVSLE + (svsmlctl & SVSLRVL_3) + SVSMLRRL0 * level;
+    while (!(PMMIFG & SVSMLDLYIFG)) ;
+
+    // Set VCore to the new level and wait until it is reached
+    PMMCTL0_L = PMMCOREV0 * level;
+    if (PMMIFG & SVMLIFG)
+        while (!(PMMIFG & SVMLVLRIFG)) ;
+
+    // Set SVS low side to the new level
+    SVSMLCTL = SVMLE + SVSLE + SVSLRVL0 * level + SVSMLRRL0 * level;
+    PMMIFG &= ~(SVMLVLRIFG + SVMLIFG + SVSMLDLYIFG);
+
+    PMMCTL0_H = 0x00;                            // Lock PMM registers
+    return PMM_STATUS_OK;
+}
+
+/***************************************************************************//**
+ * @brief  Lower VCore by one level. MCLK must already be slow enough for the
+ *         new level.
+ * @param  level  New core voltage level, one below the current one
+ * @return none
+ ******************************************************************************/
+
+static void PMM_setVCoreDown(uint8_t level)
+{
+    PMMCTL0_H = PMMPW_H;                         // Open PMM registers
+
+    // Move the low side supervisor down first so it does not trip
+    PMMIFG &= ~(SVMLVLRIFG + SVMLIFG + SVSMLDLYIFG);
+    SVSMLCTL = SVMLE + SVSLE + SVSLRVL0 * level + SVSMLRRL0 * level;
+    while (!(PMMIFG & SVSMLDLYIFG)) ;
+
+    // Set VCore to the new level
+    PMMCTL0_L = PMMCOREV0 * level;
+
+    // The high side follows to save supervisor current
+    SVSMHCTL = SVMHE + SVSHE + SVSHRVL0 * level + SVSMHRRL0 * level;
+    PMMIFG &= ~(SVMLVLRIFG + SVMLIFG + SVSMLDLYIFG);
+
+    PMMCTL0_H = 0x00;                            // Lock PMM registers
+}
+
+/***************************************************************************//**
+ * @brief  Set the core voltage, stepping one level at a time as required.
+ *
+ *         Raise VCore before increasing MCLK and lower it only after MCLK has
+ *         been reduced.
+ * @param  level  Core voltage level 0 ... 3
+ * @return PMM_STATUS_OK, or PMM_STATUS_ERROR if DVCC cannot support the level
+ *         (VCore is left at the highest level reached)
+ ******************************************************************************/
+
+uint8_t PMM_setVCore(uint8_t level)
+{
+    uint8_t current;
+    uint8_t status = PMM_STATUS_OK;
+    uint16_t gie = __get_SR_register() & GIE;    // Store current GIE state
+
+    if (level > 3)
+        level = 3;
+
+    __disable_interrupt();                       // PMM accesses must not be interrupted
+
+    current = PMM_getVCore();
+    while (current < level && status == PMM_STATUS_OK)
+    {
+        status = PMM_setVCoreUp(current + 1);
+        if (status == PMM_STATUS_OK)
+            current++;
+    }
+    while (current > level)
+    {
+        PMM_setVCoreDown(--current);
+    }
+
+    __bis_SR_register(gie);                      // Restore original GIE state
+
+    return status;
+}
+
+/***************************************************************************//**
+ * @brief  Get the current core voltage level
+ * @param  none
+ * @return Core voltage level 0 ... 3
+ ******************************************************************************/
+
+uint8_t PMM_getVCore(void)
+{
+    return PMMCTL0 & PMMCOREV_3;
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
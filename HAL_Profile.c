@@ -0,0 +1,205 @@
+/*******************************************************************************
+ *
+ *  HAL_Profile.c - Cycle-accurate profiling probes
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_Profile.c
+ * @addtogroup HAL_Profile
+ * @{
+ *
+ * Durations are measured in SMCLK cycles with the HAL_Cycles counter (TA1),
+ * as TB0 is taken by the backlight PWM. Cycles_init() must have been called.
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_Cycles.h"
+#include "HAL_Profile.h"
+
+static ProfileProbe probes[PROFILE_MAX_PROBES];
+const uint16_t Profile_ramSize = sizeof(probes);
+static uint32_t overhead = 0;               // Cycles added by the probe itself
+
+static const char * const probeNames[PROFILE_USER_FIRST] = {
+    "lcdData",                               // PROFILE_LCD_WRITE_DATA
+    "sdRead",                                // PROFILE_SD_READ_FRAME
+    "accelRead",                             // PROFILE_ACCEL_READ
+    "isrTimer",                              // PROFILE_ISR_TIMER
+    "isrDma",                                // PROFILE_ISR_DMA
+    "isrUart",                               // PROFILE_ISR_UART
+    "isrPort1",                              // PROFILE_ISR_PORT1
+    "isrPort2"                               // PROFILE_ISR_PORT2
+};
+
+/***************************************************************************//**
+ * @brief  Clear all probes and measure the probe overhead
+ *
+ *         The overhead is the shortest of a few empty PROFILE_ENTER() /
+ *         PROFILE_EXIT() pairs, which is what every measurement includes.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Profile_init(void)
+{
+    uint8_t i;
+
+    overhead = 0;
+    Profile_reset();
+    for (i = 0; i < 4; i++)
+    {
+        Profile_enter(PROFILE_USER_FIRST);
+        Profile_exit(PROFILE_USER_FIRST);
+    }
+    overhead = probes[PROFILE_USER_FIRST].min;
+    Profile_reset();
+}
+
+/***************************************************************************//**
+ * @brief  Clear the statistics of all probes
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Profile_reset(void)
+{
+    uint16_t gie = __get_SR_register() & GIE;   // Store current GIE state
+    uint8_t id, bin;
+
+    __disable_interrupt();
+    for (id = 0; id < PROFILE_MAX_PROBES; id++)
+    {
+        probes[id].count = 0;
+        probes[id].total = 0;
+        probes[id].min = 0xFFFFFFFF;
+        probes[id].max = 0;
+        for (bin = 0; bin < PROFILE_HISTOGRAM_BINS; bin++)
+            probes[id].histogram[bin] = 0;
+    }
+    __bis_SR_register(gie);                     // Restore original GIE state
+}
+
+/***************************************************************************//**
+ * @brief  Start timing a probe. Use PROFILE_ENTER() so probes can be
+ *         compiled out.
+ * @param  id  Probe id
+ * @return none
+ ******************************************************************************/
+
+void Profile_enter(uint8_t id)
+{
+    if (id < PROFILE_MAX_PROBES)
+        probes[id].start = Cycles_now();
+}
+
+/***************************************************************************//**
+ * @brief  Stop timing a probe started with Profile_enter() and record it
+ * @param  id  Probe id
+ * @return none
+ ******************************************************************************/
+
+void Profile_exit(uint8_t id)
+{
+    if (id < PROFILE_MAX_PROBES)
+        Profile_record(id, Cycles_now() - probes[id].start);
+}
+
+/***************************************************************************//**
+ * @brief  Add one measured duration to a probe's statistics
+ * @param  id      Probe id
+ * @param  cycles  Duration in SMCLK cycles, including the probe overhead
+ * @return none
+ ******************************************************************************/
+
+void Profile_record(uint8_t id, uint32_t cycles)
+{
+    uint16_t gie = __get_SR_register() & GIE;
+    ProfileProbe *pProbe;
+    uint32_t limit = PROFILE_HISTOGRAM_BASE;
+    uint8_t bin = 0;
+
+    if (id >= PROFILE_MAX_PROBES)
+        return;
+
+    cycles = cycles > overhead ? cycles - overhead : 0;
+    while (bin < PROFILE_HISTOGRAM_BINS - 1 && cycles >= limit)
+    {
+        bin++;
+        limit <<= 1;
+    }
+
+    pProbe = &probes[id];
+    __disable_interrupt();
+    pProbe->count++;
+    if (pProbe->total <= PROFILE_TOTAL_SATURATED - cycles)
+        pProbe->total += cycles;
+    else
+        pProbe->total = PROFILE_TOTAL_SATURATED;
+    if (cycles < pProbe->min)
+        pProbe->min = cycles;
+    if (cycles > pProbe->max)
+        pProbe->max = cycles;
+    if (pProbe->histogram[bin] != 0xFFFF)
+        pProbe->histogram[bin]++;
+    __bis_SR_register(gie);
+}
+
+/***************************************************************************//**
+ * @brief  Get a probe's statistics
+ * @param  id  Probe id
+ * @return Probe, or 0 for an invalid id
+ ******************************************************************************/
+
+const ProfileProbe *Profile_getProbe(uint8_t id)
+{
+    if (id >= PROFILE_MAX_PROBES)
+        return 0;
+    return &probes[id];
+}
+
+/***************************************************************************//**
+ * @brief  Get the display name of a probe
+ * @param  id  Probe id
+ * @return Name, or 0 for user probes
+ ******************************************************************************/
+
+const char *Profile_getName(uint8_t id)
+{
+    if (id >= PROFILE_USER_FIRST)
+        return 0;
+    return probeNames[id];
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
@@ -0,0 +1,103 @@
+/*******************************************************************************
+ *
+ *  HAL_Profile.h
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef HAL_PROFILE_H
+#define HAL_PROFILE_H
+
+#include <stdint.h>
+#include "HAL_Cycles.h"
+
+// Set to 0 to compile all probes out
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED         1
+#endif
+
+// Probe ids; PROFILE_USER_FIRST ... PROFILE_MAX_PROBES - 1 are free
+#define PROFILE_LCD_WRITE_DATA  0
+#define PROFILE_SD_READ_FRAME   1
+#define PROFILE_ACCEL_READ      2
+#define PROFILE_ISR_TIMER       3
+#define PROFILE_ISR_DMA         4
+#define PROFILE_ISR_UART        5
+#define PROFILE_ISR_PORT1       6
+#define PROFILE_ISR_PORT2       7
+#define PROFILE_USER_FIRST      8
+#define PROFILE_MAX_PROBES      16
+
+// Histogram bin i counts durations below PROFILE_HISTOGRAM_BASE << i cycles,
+// the last bin everything longer
+#define PROFILE_HISTOGRAM_BINS  10
+#define PROFILE_HISTOGRAM_BASE  128
+
+// ProfileProbe.total once it no longer fits; the mean is then unknown
+#define PROFILE_TOTAL_SATURATED 0xFFFFFFFFUL
+
+typedef struct
+{
+    uint32_t start;                    // Cycles_now() at Profile_enter()
+    uint32_t count;
+    uint32_t total;                    // Sum of all durations in cycles, saturating
+    uint32_t min;
+    uint32_t max;
+    uint16_t histogram[PROFILE_HISTOGRAM_BINS];   // Saturating
+} ProfileProbe;
+
+#if PROFILE_ENABLED
+// Non-reentrant code and ISRs: the start time is kept in the probe
+#define PROFILE_ENTER(id)       Profile_enter(id)
+#define PROFILE_EXIT(id)        Profile_exit(id)
+// Any block, may nest: the start time is kept on the stack
+#define PROFILE_SCOPE_BEGIN(id) { uint32_t profileStart = Cycles_now();
+#define PROFILE_SCOPE_END(id)   Profile_record((id), Cycles_now() - profileStart); }
+#else
+#define PROFILE_ENTER(id)
+#define PROFILE_EXIT(id)
+#define PROFILE_SCOPE_BEGIN(id) {
+#define PROFILE_SCOPE_END(id)   }
+#endif
+
+// Static RAM of the probe table
+extern const uint16_t Profile_ramSize;
+
+extern void Profile_init(void);
+extern void Profile_reset(void);
+extern void Profile_enter(uint8_t id);
+extern void Profile_exit(uint8_t id);
+extern void Profile_record(uint8_t id, uint32_t cycles);
+extern const ProfileProbe *Profile_getProbe(uint8_t id);
+extern const char *Profile_getName(uint8_t id);
+
+#endif /* HAL_PROFILE_H */
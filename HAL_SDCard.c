@@ -40,6 +40,11 @@
  * @{
  ******************************************************************************/
 #include "msp430.h"
+#include "HAL_BusTrace.h"
+#include "HAL_Energy.h"
+#include "HAL_Latency.h"
+#include "HAL_Profile.h"
+#include "HAL_UCS.h"
 #include "HAL_SDCard.h"
 
 // Pins from MSP430 connected to the SD Card
@@ -57,6 +62,52 @@
 #define SD_CS_OUT       P3OUT
 #define SD_CS_DIR       P3DIR
 
+// SPI clock limits
+#define SD_INIT_FREQUENCY   400000UL   // Identification mode
+#define SD_FAST_FREQUENCY   12500000UL // Data transfer
+
+#define LATENCY_FILE        LATENCY_FILE_SDCARD
+
+static uint32_t spiFrequency = SD_INIT_FREQUENCY;
+
+// Forward declared functions
+static void SDCard_setSpiDivider(void);
+static void SDCard_clockChanged(void);
+
+/***************************************************************************//**
+ * @brief   Program the USCI_B1 divider for spiFrequency at the current SMCLK.
+ *          The state machine must be in reset.
+ * @param   None
+ * @return  None
+ ******************************************************************************/
+
+static void SDCard_setSpiDivider(void)
+{
+    uint16_t divider = UCS_getSmclkDivider(spiFrequency);
+
+    UCB1BR0 = divider & 0xFF;
+    UCB1BR1 = divider >> 8;
+}
+
+/***************************************************************************//**
+ * @brief   Recompute the SPI divider after a clock profile change, if the
+ *          bus is currently set up for the SD Card (clock polarity high)
+ * @param   None
+ * @return  None
+ ******************************************************************************/
+
+static void SDCard_clockChanged(void)
+{
+    if ((UCB1CTL1 & UCSWRST) || !(UCB1CTL0 & UCCKPL))
+        return;
+
+    while (UCB1STAT & UCBUSY) ;                            // Let the current byte finish
+    UCB1CTL1 |= UCSWRST;                                   // Put state machine in reset
+    SDCard_setSpiDivider();
+    UCB1CTL1 &= ~UCSWRST;                                  // Release USCI state machine
+    UCB1IFG &= ~UCRXIFG;
+}
+
 /***************************************************************************//**
  * @brief   Initialize SD Card
  * @param   None
@@ -81,10 +132,12 @@ void SDCard_init(void)
     // Clock polarity select - The inactive state is high
     // MSB first
     UCB1CTL1 = UCSWRST + UCSSEL_2;                         // Use SMCLK, keep RESET
-    UCB1BR0 = 63;                                          // Initial SPI clock must be <400kHz
-    UCB1BR1 = 0;                                           // f_UCxCLK = 25MHz/63 = 397kHz
+    spiFrequency = SD_INIT_FREQUENCY;                      // Initial SPI clock must be <400kHz
+    SDCard_setSpiDivider();
     UCB1CTL1 &= ~UCSWRST;                                  // Release USCI state machine
     UCB1IFG &= ~UCRXIFG;
+
+    UCS_addClockCallback(SDCard_clockChanged);
 }
 
 /***************************************************************************//**
@@ -98,11 +151,39 @@ void SDCard_init(void)
 void SDCard_fastMode(void)
 {
     UCB1CTL1 |= UCSWRST;                                   // Put state machine in reset
-    UCB1BR0 = 2;                                           // f_UCxCLK = 25MHz/2 = 12.5MHz
-    UCB1BR1 = 0;
+    spiFrequency = SD_FAST_FREQUENCY;                      // f_UCxCLK <= 12.5MHz
+    SDCard_setSpiDivider();
     UCB1CTL1 &= ~UCSWRST;                                  // Release USCI state machine
 }
 
+/***************************************************************************//**
+ * @brief   Set the SPI clock divider directly, e.g. to benchmark slower
+ *          clocks. Dividers faster than data transfer mode allows are raised
+ *          to its limit. A later clock profile change keeps the resulting
+ *          SPI frequency.
+ * @param   divider UCB1BRW value
+ * @return  The divider programmed
+ ******************************************************************************/
+
+uint16_t SDCard_setDivider(uint16_t divider)
+{
+    uint32_t smclk = UCS_getSmclkFrequency();
+    uint16_t minimum = UCS_getSmclkDivider(SD_FAST_FREQUENCY);
+
+    if (divider < minimum)
+    {
+        divider = minimum;
+    }
+
+    UCB1CTL1 |= UCSWRST;                                   // Put state machine in reset
+    spiFrequency = (smclk + divider - 1) / divider;        // Rounded up, maps back to divider
+    UCB1BR0 = divider & 0xFF;
+    UCB1BR1 = divider >> 8;
+    UCB1CTL1 &= ~UCSWRST;                                  // Release USCI state machine
+
+    return divider;
+}
+
 /***************************************************************************//**
  * @brief   Read a frame of bytes via SPI
  * @param   pBuffer Place to store the received bytes
@@ -113,8 +194,12 @@ void SDCard_fastMode(void)
 void SDCard_readFrame(uint8_t *pBuffer, uint16_t size)
 {
     uint16_t gie = __get_SR_register() & GIE;              // Store current GIE state
+    BUSTRACE_DECLARE(trace);
 
     __disable_interrupt();                                 // Make this operation atomic
+    LATENCY_CRITICAL_ENTER(gie);
+    PROFILE_ENTER(PROFILE_SD_READ_FRAME);
+    BUSTRACE_BEGIN(trace, BUSTRACE_SD, BUSTRACE_RX, size);
 
     UCB1IFG &= ~UCRXIFG;                                   // Ensure RXIFG is clear
 
@@ -126,6 +211,9 @@ void SDCard_readFrame(uint8_t *pBuffer, uint16_t size)
         *pBuffer++ = UCB1RXBUF;
     }
 
+    BUSTRACE_END(trace);
+    PROFILE_EXIT(PROFILE_SD_READ_FRAME);
+    LATENCY_CRITICAL_EXIT(gie);
     __bis_SR_register(gie);                                // Restore original GIE state
 }
 
@@ -139,8 +227,11 @@ void SDCard_readFrame(uint8_t *pBuffer, uint16_t size)
 void SDCard_sendFrame(uint8_t *pBuffer, uint16_t size)
 {
     uint16_t gie = __get_SR_register() & GIE;              // Store current GIE state
+    BUSTRACE_DECLARE(trace);
 
     __disable_interrupt();                                 // Make this operation atomic
+    LATENCY_CRITICAL_ENTER(gie);
+    BUSTRACE_BEGIN(trace, BUSTRACE_SD, BUSTRACE_TX, size);
 
     // Clock the actual data transfer and send the bytes. Note that we
     // intentionally not read out the receive buffer during frame transmission
@@ -154,7 +245,9 @@ void SDCard_sendFrame(uint8_t *pBuffer, uint16_t size)
 
     UCB1RXBUF;                                             // Dummy read to empty RX buffer
                                                            // and clear any overrun conditions
+    BUSTRACE_END(trace);
 
+    LATENCY_CRITICAL_EXIT(gie);
     __bis_SR_register(gie);                                // Restore original GIE state
 }
 
@@ -167,6 +260,7 @@ void SDCard_sendFrame(uint8_t *pBuffer, uint16_t size)
 void SDCard_setCSHigh(void)
 {
     SD_CS_OUT |= SD_CS;
+    ENERGY_SET_LOAD(ENERGY_SD, 0);
 }
 
 /***************************************************************************//**
@@ -178,6 +272,7 @@ void SDCard_setCSHigh(void)
 void SDCard_setCSLow(void)
 {
     SD_CS_OUT &= ~SD_CS;
+    ENERGY_SET_LOAD(ENERGY_SD, ENERGY_FULL_LOAD);
 }
 
 /***************************************************************************//**
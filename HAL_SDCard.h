@@ -41,6 +41,7 @@
 
 extern void SDCard_init(void);
 extern void SDCard_fastMode(void);
+extern uint16_t SDCard_setDivider(uint16_t divider);
 extern void SDCard_readFrame(uint8_t *pBuffer, uint16_t size);
 extern void SDCard_sendFrame(uint8_t *pBuffer, uint16_t size);
 extern void SDCard_setCSHigh(void);
@@ -0,0 +1,426 @@
+/*******************************************************************************
+ *
+ *  HAL_Scheduler.c - Cooperative run-to-completion task scheduler
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_Scheduler.c
+ * @addtogroup HAL_Scheduler
+ * @{
+ *
+ * Tickless: each periodic task owns a software timer, so the CPU only wakes
+ * when a task is actually due.
+ *
+ * Every run is timed with the TA1 cycle counter (Cycles_init() must have
+ * been called). A task that exceeds its budget counts an overrun; with
+ * SCHEDULER_BUDGET_THROTTLE its period is doubled, up to
+ * SCHEDULER_MAX_THROTTLE times, so it cannot starve the other tasks. The
+ * rate is restored by Scheduler_setPeriod() or Scheduler_resetStats().
+ * Time the task spends sleeping in LPM3 is not counted, as TA1 stops.
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_Cycles.h"
+#include "HAL_Energy.h"
+#include "HAL_Timer.h"
+#include "HAL_Work.h"
+#include "HAL_Scheduler.h"
+
+static Scheduler_task tasks[SCHEDULER_MAX_TASKS];
+static SoftTimer taskTimers[SCHEDULER_MAX_TASKS];  // Periodic, stopped for event tasks
+static SchedulerTaskStats taskStats[SCHEDULER_MAX_TASKS];
+const uint16_t Scheduler_ramSize = sizeof(tasks) + sizeof(taskTimers) + sizeof(taskStats);
+static uint8_t numTasks = 0;
+static volatile uint16_t readyTasks = 0;        // One bit per task
+static uint8_t lpmHolds[2] = { 0, 0 };
+
+// Forward declared functions
+static uint16_t Scheduler_taskDue(SoftTimer *pTimer);
+static uint16_t Scheduler_lpmBits(void);
+static void Scheduler_startTimer(uint8_t id);
+#if SCHEDULER_BUDGET_ENABLED
+static void Scheduler_account(uint8_t id, uint32_t cycles);
+#endif
+
+/***************************************************************************//**
+ * @brief  Add a task
+ * @param  task      Function to run
+ * @param  periodMs  Run interval, or 0 for a
+ *                   task that only runs when signalled
+ * @return Task id, or SCHEDULER_INVALID_TASK if the table is full
+ ******************************************************************************/
+
+uint8_t Scheduler_addTask(Scheduler_task task, uint16_t periodMs)
+{
+    uint8_t id;
+
+    if (numTasks == SCHEDULER_MAX_TASKS)
+        return SCHEDULER_INVALID_TASK;
+
+    Timer_init();
+    id = numTasks++;
+    tasks[id] = task;
+    taskStats[id].budget = 0;
+    taskStats[id].flags = 0;
+    Timer_create(&taskTimers[id], Scheduler_taskDue);
+    Scheduler_setPeriod(id, periodMs);
+    return id;
+}
+
+/***************************************************************************//**
+ * @brief  Change the run interval of a task
+ * @param  id        Task id returned by Scheduler_addTask()
+ * @param  periodMs  Run interval, or 0 to only run when signalled
+ * @return none
+ ******************************************************************************/
+
+void Scheduler_setPeriod(uint8_t id, uint16_t periodMs)
+{
+    Scheduler_setPeriodTicks(id, periodMs ? Timer_msToTicks(periodMs) : 0);
+}
+
+/***************************************************************************//**
+ * @brief  Change the run interval of a task, at timer tick resolution, for
+ *         rates that are not a whole number of milliseconds
+ * @param  id     Task id returned by Scheduler_addTask()
+ * @param  ticks  Run interval in Timer_now() ticks, or 0 to only run when
+ *                signalled
+ * @return none
+ ******************************************************************************/
+
+void Scheduler_setPeriodTicks(uint8_t id, uint32_t ticks)
+{
+    if (id >= numTasks)
+        return;
+
+    taskStats[id].period = ticks;
+    taskStats[id].throttle = 0;
+    Scheduler_startTimer(id);
+}
+
+/***************************************************************************//**
+ * @brief  (Re)start the timer of a task at its throttled period
+ * @param  id  Task id
+ * @return none
+ ******************************************************************************/
+
+static void Scheduler_startTimer(uint8_t id)
+{
+    uint32_t period;
+
+    if (taskStats[id].period)
+    {
+        period = taskStats[id].period << taskStats[id].throttle;
+        Timer_start(&taskTimers[id], period, period);
+    }
+    else
+    {
+        Timer_stop(&taskTimers[id]);
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Set the cycle budget of a task
+ * @param  id      Task id returned by Scheduler_addTask()
+ * @param  cycles  SMCLK cycles a run may take, 0 for no budget
+ * @param  flags   0 or SCHEDULER_BUDGET_THROTTLE to lower the rate of a
+ *                 periodic task on overruns
+ * @return none
+ ******************************************************************************/
+
+void Scheduler_setBudget(uint8_t id, uint32_t cycles, uint8_t flags)
+{
+    if (id >= numTasks)
+        return;
+
+    taskStats[id].budget = cycles;
+    taskStats[id].flags = flags;
+}
+
+#if SCHEDULER_BUDGET_ENABLED
+/***************************************************************************//**
+ * @brief  Book a task run against its budget
+ * @param  id      Task id
+ * @param  cycles  Cycles the run took
+ * @return none
+ ******************************************************************************/
+
+static void Scheduler_account(uint8_t id, uint32_t cycles)
+{
+    SchedulerTaskStats *pStats = &taskStats[id];
+
+    pStats->last = cycles;
+    pStats->runs++;
+    if (cycles > pStats->worst)
+        pStats->worst = cycles;
+
+    if (pStats->budget == 0 || cycles <= pStats->budget)
+        return;
+
+    if (pStats->overruns != 0xFFFF)
+        pStats->overruns++;
+
+    if ((pStats->flags & SCHEDULER_BUDGET_THROTTLE) && pStats->period &&
+        pStats->throttle < SCHEDULER_MAX_THROTTLE)
+    {
+        pStats->throttle++;
+        Scheduler_startTimer(id);
+    }
+}
+#endif
+
+/***************************************************************************//**
+ * @brief  Get the run time statistics of a task
+ * @param  id  Task id returned by Scheduler_addTask()
+ * @return Statistics, or 0 if id is not a task
+ ******************************************************************************/
+
+const SchedulerTaskStats *Scheduler_getStats(uint8_t id)
+{
+    return id < numTasks ? &taskStats[id] : 0;
+}
+
+/***************************************************************************//**
+ * @brief  Get the number of tasks added
+ * @param  none
+ * @return Tasks, ids are 0 ... count - 1
+ ******************************************************************************/
+
+uint8_t Scheduler_getTaskCount(void)
+{
+    return numTasks;
+}
+
+/***************************************************************************//**
+ * @brief  Find the task that exceeded its budget by the largest factor
+ * @param  none
+ * @return Task id, or SCHEDULER_INVALID_TASK if no task has overrun
+ ******************************************************************************/
+
+uint8_t Scheduler_getWorstTask(void)
+{
+    uint8_t id, worst = SCHEDULER_INVALID_TASK;
+
+    for (id = 0; id < numTasks; id++)
+    {
+        if (taskStats[id].overruns == 0)
+            continue;
+
+        // worst / budget larger than that of the current worst offender
+        if (worst == SCHEDULER_INVALID_TASK ||
+            (uint64_t)taskStats[id].worst * taskStats[worst].budget >
+            (uint64_t)taskStats[worst].worst * taskStats[id].budget)
+        {
+            worst = id;
+        }
+    }
+
+    return worst;
+}
+
+/***************************************************************************//**
+ * @brief  Clear the run time statistics and restore throttled periods
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Scheduler_resetStats(void)
+{
+    uint8_t id;
+
+    for (id = 0; id < numTasks; id++)
+    {
+        taskStats[id].last = 0;
+        taskStats[id].worst = 0;
+        taskStats[id].runs = 0;
+        taskStats[id].overruns = 0;
+        if (taskStats[id].throttle)
+        {
+            taskStats[id].throttle = 0;
+            Scheduler_startTimer(id);
+        }
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Make a task ready to run. May be called from ISRs; the ISR must
+ *         also wake the CPU.
+ * @param  id  Task id returned by Scheduler_addTask()
+ * @return none
+ ******************************************************************************/
+
+void Scheduler_signal(uint8_t id)
+{
+    if (id < numTasks)
+        readyTasks |= 1 << id;
+}
+
+/***************************************************************************//**
+ * @brief  Keep the CPU from sleeping deeper than a low-power mode, e.g. while
+ *         a peripheral clocked by SMCLK is busy. Holds are counted.
+ * @param  level  SCHEDULER_LPM0 or SCHEDULER_LPM3
+ * @return none
+ ******************************************************************************/
+
+void Scheduler_holdLpm(uint8_t level)
+{
+    uint16_t gie = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+    lpmHolds[level]++;
+    __bis_SR_register(gie);
+}
+
+/***************************************************************************//**
+ * @brief  Release a hold taken with Scheduler_holdLpm()
+ * @param  level  SCHEDULER_LPM0 or SCHEDULER_LPM3
+ * @return none
+ ******************************************************************************/
+
+void Scheduler_releaseLpm(uint8_t level)
+{
+    uint16_t gie = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+    if (lpmHolds[level])
+        lpmHolds[level]--;
+    __bis_SR_register(gie);
+}
+
+/***************************************************************************//**
+ * @brief  Enter the deepest low-power mode the running peripherals allow.
+ *
+ *         Call with interrupts disabled after checking there is nothing to do;
+ *         returns with interrupts enabled once an ISR has woken the CPU.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Scheduler_sleep(void)
+{
+    ENERGY_SLEEP(Scheduler_lpmBits());
+    __no_operation();
+}
+
+/***************************************************************************//**
+ * @brief  Run tasks and deferred work forever, sleeping when idle
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Scheduler_run(void)
+{
+    uint8_t id;
+    uint16_t mask;
+#if SCHEDULER_BUDGET_ENABLED
+    uint32_t start;
+#endif
+
+    while (1)
+    {
+        // Run every ready task once, in the order they were added
+        for (id = 0, mask = 1; id < numTasks; id++, mask <<= 1)
+        {
+            if (readyTasks & mask)
+            {
+                __disable_interrupt();
+                readyTasks &= ~mask;
+                __enable_interrupt();
+#if SCHEDULER_BUDGET_ENABLED
+                start = Cycles_now();
+                tasks[id]();
+                Scheduler_account(id, Cycles_now() - start);
+#else
+                tasks[id]();
+#endif
+            }
+        }
+        Work_dispatch();
+
+        __disable_interrupt();
+        if (readyTasks == 0 && Work_pending() == 0)
+            Scheduler_sleep();
+        __enable_interrupt();
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Task timer handler - makes a periodic task ready
+ * @param  pTimer  Timer of the due task
+ * @return LPM4_bits to wake the CPU
+ ******************************************************************************/
+
+static uint16_t Scheduler_taskDue(SoftTimer *pTimer)
+{
+    readyTasks |= 1 << (pTimer - taskTimers);
+    return LPM4_bits;
+}
+
+/***************************************************************************//**
+ * @brief  Select the deepest low-power mode the current state allows.
+ *
+ *         Timers and the UART clocked from SMCLK need LPM0, ACLK users LPM3.
+ *         The SPI masters only clock while the CPU waits on them and the
+ *         TA1 cycle counter may pause, so neither is considered.
+ * @param  none
+ * @return Status register bits for __bis_SR_register()
+ ******************************************************************************/
+
+static uint16_t Scheduler_lpmBits(void)
+{
+    uint8_t i;
+    uint16_t clocks = 0;               // TASSEL__ACLK and/or TASSEL__SMCLK
+    const volatile uint16_t *timers[] = { &TA0CTL, &TA2CTL, &TB0CTL };
+
+    if (lpmHolds[SCHEDULER_LPM0])
+        return LPM0_bits;
+
+    for (i = 0; i < sizeof(timers) / sizeof(timers[0]); i++)
+    {
+        if (*timers[i] & MC_3)
+            clocks |= *timers[i] & TASSEL_3;
+    }
+
+    if (!(UCA1CTL1 & UCSWRST))
+        clocks |= (UCA1CTL1 & UCSSEL_3) == UCSSEL_1 ? TASSEL__ACLK : TASSEL__SMCLK;
+
+    if (clocks & TASSEL__SMCLK)
+        return LPM0_bits;
+    if ((clocks & TASSEL__ACLK) || lpmHolds[SCHEDULER_LPM3])
+        return LPM3_bits;
+    return LPM4_bits;
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
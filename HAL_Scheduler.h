@@ -0,0 +1,90 @@
+/*******************************************************************************
+ *
+ *  HAL_Scheduler.h
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef HAL_SCHEDULER_H
+#define HAL_SCHEDULER_H
+
+#include <stdint.h>
+
+#define SCHEDULER_MAX_TASKS     8
+#define SCHEDULER_INVALID_TASK  0xFF
+
+// Set to 0 to compile the per-task cycle measurement out
+#ifndef SCHEDULER_BUDGET_ENABLED
+#define SCHEDULER_BUDGET_ENABLED 1
+#endif
+
+// Scheduler_setBudget() flags
+#define SCHEDULER_BUDGET_THROTTLE   0x01   // Double the period on each overrun
+#define SCHEDULER_MAX_THROTTLE      3      // Up to 8 times the requested period
+
+// Deepest low-power mode a module can forbid with Scheduler_holdLpm
+#define SCHEDULER_LPM0          0      // Keep SMCLK and the FLL running
+#define SCHEDULER_LPM3          1      // Keep ACLK running
+
+// Runs to completion in main-loop context
+typedef void (*Scheduler_task)(void);
+
+typedef struct
+{
+    uint32_t budget;                   // SMCLK cycles per run, 0 = none
+    uint32_t last;                     // Cycles of the last run
+    uint32_t worst;
+    uint32_t runs;
+    uint32_t period;                   // Timer ticks as requested, 0 for event tasks
+    uint16_t overruns;                 // Saturating
+    uint8_t flags;                     // SCHEDULER_BUDGET_xxx
+    uint8_t throttle;                  // The period is period << throttle
+} SchedulerTaskStats;
+
+// Static RAM of the task table, timers and statistics
+extern const uint16_t Scheduler_ramSize;
+
+extern uint8_t Scheduler_addTask(Scheduler_task task, uint16_t periodMs);
+extern void Scheduler_setPeriod(uint8_t id, uint16_t periodMs);
+extern void Scheduler_setPeriodTicks(uint8_t id, uint32_t ticks);
+extern void Scheduler_signal(uint8_t id);
+extern void Scheduler_setBudget(uint8_t id, uint32_t cycles, uint8_t flags);
+extern const SchedulerTaskStats *Scheduler_getStats(uint8_t id);
+extern uint8_t Scheduler_getTaskCount(void);
+extern uint8_t Scheduler_getWorstTask(void);
+extern void Scheduler_resetStats(void);
+extern void Scheduler_holdLpm(uint8_t level);
+extern void Scheduler_releaseLpm(uint8_t level);
+extern void Scheduler_sleep(void);
+extern void Scheduler_run(void);
+
+#endif /* HAL_SCHEDULER_H */
@@ -0,0 +1,619 @@
+/*******************************************************************************
+ *
+ *  HAL_SdBench.c - SD card throughput and latency benchmark
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_SdBench.c
+ * @addtogroup HAL_SdBench
+ * @{
+ *
+ * Throughput and per operation latency of the SD card path through
+ * SDCard_readFrame() and SDCard_sendFrame(), at a range of UCB1 dividers.
+ *
+ * Tests cover sequential and random single block transfers and multi block
+ * streams (CMD18/CMD25) of different lengths, reading and writing. Each
+ * operation is timed with HAL_Cycles; the time spent polling the card for a
+ * read data token or the end of write programming is reported separately as
+ * busy time.
+ *
+ * SDCard_readFrame() and SDCard_sendFrame() keep interrupts disabled for a
+ * whole frame. At slow dividers a 512 byte block takes longer than one TA1
+ * period, and HAL_Cycles then counts two overflows as one. Operation times
+ * are therefore checked against the HAL_Timer tick count, which a block
+ * transfer cannot wrap, and the missed TA1 periods are added back.
+ *
+ * The tests overwrite SDBENCH_AREA_BLOCKS blocks from the first block given
+ * to SdBench_begin(). UCB1 is shared with the display; SdBench_end() puts
+ * back the configuration found by SdBench_begin().
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_Cycles.h"
+#include "HAL_SDCard.h"
+#include "HAL_Timer.h"
+#include "HAL_UCS.h"
+#include "HAL_SdBench.h"
+
+// SPI mode commands
+#define CMD_GO_IDLE_STATE           0
+#define CMD_SEND_IF_COND            8
+#define CMD_SEND_CSD                9
+#define CMD_STOP_TRANSMISSION       12
+#define CMD_SET_BLOCKLEN            16
+#define CMD_READ_SINGLE_BLOCK       17
+#define CMD_READ_MULTIPLE_BLOCK     18
+#define CMD_WRITE_BLOCK             24
+#define CMD_WRITE_MULTIPLE_BLOCK    25
+#define CMD_APP_CMD                 55
+#define CMD_READ_OCR                58
+#define ACMD_SD_SEND_OP_COND        41
+
+#define R1_IDLE                     0x01
+#define OCR_CCS                     0x40       // In the first OCR byte
+#define ACMD41_HCS                  0x40000000UL
+
+#define TOKEN_START_BLOCK           0xFE
+#define TOKEN_START_MULTI_WRITE     0xFC
+#define TOKEN_STOP_MULTI_WRITE      0xFD
+#define DATA_RESPONSE_MASK          0x1F
+#define DATA_RESPONSE_ACCEPTED      0x05
+
+#define COMMAND_RETRIES             8          // Bytes polled for an R1 response
+#define INIT_TIMEOUT_MS             1000
+#define READ_TIMEOUT_MS             100
+#define WRITE_TIMEOUT_MS            250
+
+// Test flags
+#define TEST_READ                   0x01
+#define TEST_RANDOM                 0x02
+
+typedef struct
+{
+    const char *name;
+    uint8_t flags;
+    uint8_t blocksPerOp;
+    uint8_t ops;
+} SdBenchTest;
+
+static const SdBenchTest tests[] = {
+    { "seq_read",     TEST_READ,               1, 32 },
+    { "seq_write",    0,                       1, 32 },
+    { "rand_read",    TEST_READ + TEST_RANDOM, 1, 32 },
+    { "rand_write",   TEST_RANDOM,             1, 32 },
+    { "multi_read",   TEST_READ,               8,  4 },
+    { "multi_write",  0,                       8,  4 },
+    { "stream_read",  TEST_READ,              32,  2 },
+    { "stream_write", 0,                      32,  2 },
+};
+
+#define NUM_TESTS       (sizeof(tests) / sizeof(tests[0]))
+
+// Candidate UCB1BRW values; those faster than the card allows are skipped
+static const uint16_t dividers[] = { 1, 2, 3, 4, 6, 8, 16, 32, 64 };
+
+#define NUM_DIVIDERS    (sizeof(dividers) / sizeof(dividers[0]))
+
+static uint8_t buffer[SDBENCH_BLOCK_SIZE];
+static uint32_t samples[SDBENCH_MAX_OPS];
+const uint16_t SdBench_ramSize = sizeof(buffer) + sizeof(samples);
+
+static uint32_t areaStart;
+static uint8_t blockAddressing;        // SDHC: block numbers, else byte offsets
+static uint8_t firstDivider;           // Index of the fastest legal divider
+
+// UCB1 configuration before SdBench_begin()
+static uint8_t savedCtl0, savedCtl1, savedBr0, savedBr1;
+
+// Forward declared functions
+static uint32_t SdBench_msToCycles(uint16_t ms);
+static uint8_t SdBench_receive(void);
+static void SdBench_deselect(void);
+static uint8_t SdBench_command(uint8_t index, uint32_t argument);
+static uint8_t SdBench_waitToken(uint32_t *pBusy);
+static uint8_t SdBench_waitReady(uint32_t *pBusy);
+static uint32_t SdBench_readCapacity(void);
+static uint8_t SdBench_identify(uint32_t *pBlocks);
+static uint8_t SdBench_readBlocks(uint32_t block, uint8_t count, uint32_t *pBusy);
+static uint8_t SdBench_writeBlocks(uint32_t block, uint8_t count, uint32_t *pBusy);
+
+/***************************************************************************//**
+ * @brief  Convert a timeout to cycles at the current SMCLK
+ * @param  ms  Milliseconds
+ * @return Cycles
+ ******************************************************************************/
+
+static uint32_t SdBench_msToCycles(uint16_t ms)
+{
+    return UCS_getSmclkFrequency() / 1000 * ms;
+}
+
+/***************************************************************************//**
+ * @brief  Clock in one byte from the card
+ * @param  none
+ * @return Byte received
+ ******************************************************************************/
+
+static uint8_t SdBench_receive(void)
+{
+    uint8_t data;
+
+    SDCard_readFrame(&data, 1);
+    return data;
+}
+
+/***************************************************************************//**
+ * @brief  Release chip select and give the card the clocks it needs to let
+ *         go of SOMI
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void SdBench_deselect(void)
+{
+    SDCard_setCSHigh();
+    SdBench_receive();
+}
+
+/***************************************************************************//**
+ * @brief  Send a command and wait for its R1 response. Chip select must be low.
+ * @param  index     Command index
+ * @param  argument  Command argument
+ * @return R1, 0xFF if the card did not answer
+ ******************************************************************************/
+
+static uint8_t SdBench_command(uint8_t index, uint32_t argument)
+{
+    uint8_t frame[6];
+    uint8_t response;
+    uint8_t retries = COMMAND_RETRIES;
+
+    frame[0] = 0x40 | index;
+    frame[1] = argument >> 24;
+    frame[2] = argument >> 16;
+    frame[3] = argument >> 8;
+    frame[4] = argument;
+    // Only CMD0 and CMD8 are CRC checked in SPI mode
+    frame[5] = index == CMD_GO_IDLE_STATE ? 0x95 : (index == CMD_SEND_IF_COND ? 0x87 : 0xFF);
+    SDCard_sendFrame(frame, sizeof(frame));
+
+    // A read stream may still be clocking out data: skip the stuff byte
+    if (index == CMD_STOP_TRANSMISSION)
+        SdBench_receive();
+
+    do
+    {
+        response = SdBench_receive();
+    } while ((response & 0x80) && --retries);
+
+    return response;
+}
+
+/***************************************************************************//**
+ * @brief  Wait for a data start token
+ * @param  pBusy  Cycles spent waiting are added here
+ * @return 1 if TOKEN_START_BLOCK arrived, 0 on an error token or timeout
+ ******************************************************************************/
+
+static uint8_t SdBench_waitToken(uint32_t *pBusy)
+{
+    uint32_t start = Cycles_now();
+    uint32_t timeout = SdBench_msToCycles(READ_TIMEOUT_MS);
+    uint32_t elapsed;
+    uint8_t token;
+
+    do
+    {
+        token = SdBench_receive();
+        elapsed = Cycles_now() - start;
+    } while (token == 0xFF && elapsed < timeout);
+
+    *pBusy += elapsed;
+    return token == TOKEN_START_BLOCK;
+}
+
+/***************************************************************************//**
+ * @brief  Wait while the card holds SOMI low (programming)
+ * @param  pBusy  Cycles spent waiting are added here
+ * @return 1 when ready, 0 on timeout
+ ******************************************************************************/
+
+static uint8_t SdBench_waitReady(uint32_t *pBusy)
+{
+    uint32_t start = Cycles_now();
+    uint32_t timeout = SdBench_msToCycles(WRITE_TIMEOUT_MS);
+    uint32_t elapsed;
+    uint8_t data;
+
+    do
+    {
+        data = SdBench_receive();
+        elapsed = Cycles_now() - start;
+    } while (data != 0xFF && elapsed < timeout);
+
+    *pBusy += elapsed;
+    return data == 0xFF;
+}
+
+/***************************************************************************//**
+ * @brief  Read the CSD and compute the capacity. Chip select must be low.
+ * @param  none
+ * @return Capacity in 512 byte blocks, 0 on error
+ ******************************************************************************/
+
+static uint32_t SdBench_readCapacity(void)
+{
+    uint8_t csd[18];                   // 16 bytes and the CRC
+    uint32_t busy = 0;
+    uint32_t size;
+    uint8_t shift;
+
+    if (SdBench_command(CMD_SEND_CSD, 0) != 0 || !SdBench_waitToken(&busy))
+        return 0;
+    SDCard_readFrame(csd, sizeof(csd));
+
+    if ((csd[0] >> 6) == 1)
+    {
+        // CSD version 2.0: C_SIZE in 512 KByte units
+        size = ((uint32_t)(csd[7] & 0x3F) << 16) | ((uint16_t)csd[8] << 8) | csd[9];
+        return (size + 1) << 10;
+    }
+
+    // CSD version 1.0: (C_SIZE + 1) << (C_SIZE_MULT + 2 + READ_BL_LEN) bytes
+    size = ((uint16_t)(csd[6] & 0x03) << 10) | ((uint16_t)csd[7] << 2) | (csd[8] >> 6);
+    shift = (((csd[9] & 0x03) << 1) | (csd[10] >> 7)) + 2 + (csd[5] & 0x0F);
+    return (size + 1) << (shift - 9);
+}
+
+/***************************************************************************//**
+ * @brief  Put the card in SPI mode and bring it out of the idle state
+ * @param  pBlocks  Receives the capacity in blocks
+ * @return SDBENCH_OK, SDBENCH_ERR_NO_CARD or SDBENCH_ERR_INIT
+ ******************************************************************************/
+
+static uint8_t SdBench_identify(uint32_t *pBlocks)
+{
+    uint8_t data[10];
+    uint8_t response, i;
+    uint8_t version2 = 0;
+    uint32_t start, timeout;
+
+    // At least 74 clocks with chip select high
+    for (i = 0; i < sizeof(data); i++)
+        data[i] = 0xFF;
+    SDCard_setCSHigh();
+    SDCard_sendFrame(data, sizeof(data));
+
+    SDCard_setCSLow();
+    i = COMMAND_RETRIES;
+    do
+    {
+        response = SdBench_command(CMD_GO_IDLE_STATE, 0);
+    } while (response != R1_IDLE && --i);
+    if (response != R1_IDLE)
+    {
+        SdBench_deselect();
+        return SDBENCH_ERR_NO_CARD;
+    }
+
+    // Version 2 cards echo the check pattern, older ones reject CMD8
+    if (SdBench_command(CMD_SEND_IF_COND, 0x1AA) == R1_IDLE)
+    {
+        SDCard_readFrame(data, 4);
+        version2 = data[3] == 0xAA;
+    }
+
+    start = Cycles_now();
+    timeout = SdBench_msToCycles(INIT_TIMEOUT_MS);
+    do
+    {
+        SdBench_command(CMD_APP_CMD, 0);
+        response = SdBench_command(ACMD_SD_SEND_OP_COND, version2 ? ACMD41_HCS : 0);
+    } while (response == R1_IDLE && Cycles_now() - start < timeout);
+    if (response != 0)
+    {
+        SdBench_deselect();
+        return SDBENCH_ERR_INIT;
+    }
+
+    blockAddressing = 0;
+    if (version2 && SdBench_command(CMD_READ_OCR, 0) == 0)
+    {
+        SDCard_readFrame(data, 4);
+        blockAddressing = (data[0] & OCR_CCS) != 0;
+    }
+    if (!blockAddressing)
+        SdBench_command(CMD_SET_BLOCKLEN, SDBENCH_BLOCK_SIZE);
+
+    *pBlocks = SdBench_readCapacity();
+    SdBench_deselect();
+
+    return SDBENCH_OK;
+}
+
+/***************************************************************************//**
+ * @brief  Read consecutive blocks, CMD18 for more than one
+ * @param  block  First block
+ * @param  count  Number of blocks
+ * @param  pBusy  Cycles spent waiting for data tokens are added here
+ * @return 1 on success
+ ******************************************************************************/
+
+static uint8_t SdBench_readBlocks(uint32_t block, uint8_t count, uint32_t *pBusy)
+{
+    uint32_t address = blockAddressing ? block : block * SDBENCH_BLOCK_SIZE;
+    uint8_t crc[2];
+    uint8_t ok;
+    uint8_t i;
+
+    SDCard_setCSLow();
+    ok = SdBench_command(count > 1 ? CMD_READ_MULTIPLE_BLOCK : CMD_READ_SINGLE_BLOCK, address) == 0;
+    for (i = 0; ok && i < count; i++)
+    {
+        ok = SdBench_waitToken(pBusy);
+        if (ok)
+        {
+            SDCard_readFrame(buffer, SDBENCH_BLOCK_SIZE);
+            SDCard_readFrame(crc, sizeof(crc));
+        }
+    }
+
+    if (count > 1)
+    {
+        // R1b: busy after the response
+        SdBench_command(CMD_STOP_TRANSMISSION, 0);
+        if (!SdBench_waitReady(pBusy))
+            ok = 0;
+    }
+    SdBench_deselect();
+
+    return ok;
+}
+
+/***************************************************************************//**
+ * @brief  Write consecutive blocks, CMD25 for more than one
+ * @param  block  First block
+ * @param  count  Number of blocks
+ * @param  pBusy  Cycles spent waiting for programming are added here
+ * @return 1 on success
+ ******************************************************************************/
+
+static uint8_t SdBench_writeBlocks(uint32_t block, uint8_t count, uint32_t *pBusy)
+{
+    uint32_t address = blockAddressing ? block : block * SDBENCH_BLOCK_SIZE;
+    uint8_t header[2];
+    uint8_t crc[2] = { 0xFF, 0xFF };
+    uint8_t response = 0xFF;
+    uint8_t ok, retries;
+    uint8_t i;
+    uint16_t j;
+
+    SDCard_setCSLow();
+    ok = SdBench_command(count > 1 ? CMD_WRITE_MULTIPLE_BLOCK : CMD_WRITE_BLOCK, address) == 0;
+
+    // One byte gap, then the start token
+    header[0] = 0xFF;
+    header[1] = count > 1 ? TOKEN_START_MULTI_WRITE : TOKEN_START_BLOCK;
+    for (i = 0; ok && i < count; i++)
+    {
+        for (j = 0; j < SDBENCH_BLOCK_SIZE; j++)
+            buffer[j] = j ^ (block + i);
+
+        SDCard_sendFrame(header, sizeof(header));
+        SDCard_sendFrame(buffer, SDBENCH_BLOCK_SIZE);
+        SDCard_sendFrame(crc, sizeof(crc));
+
+        retries = COMMAND_RETRIES;
+        do
+        {
+            response = SdBench_receive();
+        } while (response == 0xFF && --retries);
+
+        ok = (response & DATA_RESPONSE_MASK) == DATA_RESPONSE_ACCEPTED && SdBench_waitReady(pBusy);
+    }
+
+    if (count > 1 && ok)
+    {
+        header[1] = TOKEN_STOP_MULTI_WRITE;
+        SDCard_sendFrame(header, sizeof(header));
+        SdBench_receive();             // Busy starts one byte after the token
+        ok = SdBench_waitReady(pBusy);
+    }
+    SdBench_deselect();
+
+    return ok;
+}
+
+/***************************************************************************//**
+ * @brief  Take over UCB1 and initialize the card for the benchmark
+ * @param  firstBlock  Start of the SDBENCH_AREA_BLOCKS blocks that the write
+ *                     tests overwrite
+ * @return SDBENCH_OK or SDBENCH_ERR_xxx; call SdBench_end() in any case
+ ******************************************************************************/
+
+uint8_t SdBench_begin(uint32_t firstBlock)
+{
+    uint32_t blocks;
+    uint16_t minimum;
+    uint8_t status;
+
+    savedCtl0 = UCB1CTL0;
+    savedCtl1 = UCB1CTL1;
+    savedBr0 = UCB1BR0;
+    savedBr1 = UCB1BR1;
+
+    SDCard_init();
+    status = SdBench_identify(&blocks);
+    if (status != SDBENCH_OK)
+        return status;
+    if (firstBlock + SDBENCH_AREA_BLOCKS > blocks)
+        return SDBENCH_ERR_AREA;
+
+    areaStart = firstBlock;
+
+    // The fastest divider allowed after identification
+    minimum = SDCard_setDivider(1);
+    for (firstDivider = 0; firstDivider < NUM_DIVIDERS - 1; firstDivider++)
+    {
+        if (dividers[firstDivider] >= minimum)
+            break;
+    }
+
+    return SDBENCH_OK;
+}
+
+/***************************************************************************//**
+ * @brief  Restore the UCB1 configuration found by SdBench_begin()
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void SdBench_end(void)
+{
+    SDCard_setCSHigh();
+
+    UCB1CTL1 |= UCSWRST;
+    UCB1CTL0 = savedCtl0;
+    UCB1BR0 = savedBr0;
+    UCB1BR1 = savedBr1;
+    UCB1CTL1 = savedCtl1;
+    UCB1IFG &= ~UCRXIFG;
+}
+
+/***************************************************************************//**
+ * @brief  Get the number of dividers the card can be run at
+ * @param  none
+ * @return Valid dividerIndex values for SdBench_run(), after SdBench_begin()
+ ******************************************************************************/
+
+uint8_t SdBench_getDividerCount(void)
+{
+    return NUM_DIVIDERS - firstDivider;
+}
+
+/***************************************************************************//**
+ * @brief  Get the number of tests
+ * @param  none
+ * @return Valid test values for SdBench_run()
+ ******************************************************************************/
+
+uint8_t SdBench_getTestCount(void)
+{
+    return NUM_TESTS;
+}
+
+/***************************************************************************//**
+ * @brief  Run one test at one divider
+ * @param  dividerIndex  0 (fastest) ... SdBench_getDividerCount() - 1
+ * @param  test          0 ... SdBench_getTestCount() - 1
+ * @param  pResult       Receives the results
+ * @return none
+ ******************************************************************************/
+
+void SdBench_run(uint8_t dividerIndex, uint8_t test, SdBenchResult *pResult)
+{
+    const SdBenchTest *pTest = &tests[test];
+    uint32_t random = 12345;
+    uint32_t block, start, startTicks, total, opStart, opTicks, cycles, busy, opBusy, busyMax, micros;
+    uint8_t i, j, n = 0;
+    uint8_t ok;
+
+    pResult->name = pTest->name;
+    pResult->divider = SDCard_setDivider(dividers[firstDivider + dividerIndex]);
+    pResult->spiKhz = UCS_getSmclkFrequency() / pResult->divider / 1000;
+    pResult->blocksPerOp = pTest->blocksPerOp;
+    pResult->ops = pTest->ops;
+    pResult->errors = 0;
+
+    busy = busyMax = 0;
+    startTicks = Timer_now();
+    start = Cycles_now();
+    for (i = 0; i < pTest->ops; i++)
+    {
+        if (pTest->flags & TEST_RANDOM)
+        {
+            random = random * 1103515245UL + 12345;
+            block = areaStart + (random >> 8) % (SDBENCH_AREA_BLOCKS - pTest->blocksPerOp + 1);
+        }
+        else
+        {
+            block = areaStart + (uint32_t)i * pTest->blocksPerOp;
+        }
+
+        opBusy = 0;
+        opTicks = Timer_now();
+        opStart = Cycles_now();
+        if (pTest->flags & TEST_READ)
+            ok = SdBench_readBlocks(block, pTest->blocksPerOp, &opBusy);
+        else
+            ok = SdBench_writeBlocks(block, pTest->blocksPerOp, &opBusy);
+        cycles = Cycles_elapsed(opStart, opTicks);
+
+        if (!ok)
+        {
+            pResult->errors++;
+            continue;
+        }
+
+        busy += opBusy;
+        if (opBusy > busyMax)
+            busyMax = opBusy;
+
+        // Insertion sort, for the percentiles
+        for (j = n; j > 0 && samples[j - 1] > cycles; j--)
+            samples[j] = samples[j - 1];
+        samples[j] = cycles;
+        n++;
+    }
+    total = Cycles_elapsed(start, startTicks);
+
+    micros = Cycles_toMicroseconds(total);
+    pResult->bytesPerSecond = micros ? (uint64_t)n * pTest->blocksPerOp * SDBENCH_BLOCK_SIZE * 1000000 / micros : 0;
+    if (n)
+    {
+        pResult->p50Us = Cycles_toMicroseconds(samples[(n - 1) / 2]);
+        pResult->p90Us = Cycles_toMicroseconds(samples[(n * 9 - 1) / 10]);
+        pResult->maxUs = Cycles_toMicroseconds(samples[n - 1]);
+        pResult->busyAvgUs = Cycles_toMicroseconds(busy / n);
+        pResult->busyMaxUs = Cycles_toMicroseconds(busyMax);
+    }
+    else
+    {
+        pResult->p50Us = pResult->p90Us = pResult->maxUs = 0;
+        pResult->busyAvgUs = pResult->busyMaxUs = 0;
+    }
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
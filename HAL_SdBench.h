@@ -0,0 +1,80 @@
+/*******************************************************************************
+ *
+ *  HAL_SdBench.h
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef HAL_SDBENCH_H
+#define HAL_SDBENCH_H
+
+#include <stdint.h>
+
+#define SDBENCH_BLOCK_SIZE      512
+#define SDBENCH_AREA_BLOCKS     1024   // Blocks overwritten from the first block on
+#define SDBENCH_MAX_OPS         32     // Operations per test
+
+// SdBench_begin() status
+#define SDBENCH_OK              0
+#define SDBENCH_ERR_NO_CARD     1      // No answer to CMD0
+#define SDBENCH_ERR_INIT        2      // Card did not leave the idle state
+#define SDBENCH_ERR_AREA        3      // Test area beyond the card's capacity
+
+// Header of the result table, one SdBenchResult per line below it
+#define SDBENCH_COLUMNS "test divider spi_khz blocks ops errors kbyte_s p50_us p90_us max_us busy_avg_us busy_max_us"
+
+typedef struct
+{
+    const char *name;
+    uint16_t divider;                  // UCB1BRW
+    uint32_t spiKhz;
+    uint8_t blocksPerOp;
+    uint8_t ops;
+    uint8_t errors;                    // Operations the card rejected or timed out
+    uint32_t bytesPerSecond;           // Over the whole test
+    uint32_t p50Us;                    // Per operation latency
+    uint32_t p90Us;
+    uint32_t maxUs;
+    uint32_t busyAvgUs;                // Per operation time the card held off: read
+    uint32_t busyMaxUs;                // access time, write programming time
+} SdBenchResult;
+
+// Static RAM of the block buffer and the latency samples
+extern const uint16_t SdBench_ramSize;
+
+extern uint8_t SdBench_begin(uint32_t firstBlock);
+extern void SdBench_end(void);
+extern uint8_t SdBench_getDividerCount(void);
+extern uint8_t SdBench_getTestCount(void);
+extern void SdBench_run(uint8_t dividerIndex, uint8_t test, SdBenchResult *pResult);
+
+#endif /* HAL_SDBENCH_H */
@@ -0,0 +1,1263 @@
+/*******************************************************************************
+ *
+ *  HAL_Shell.c - Line-oriented command interpreter on the Application UART
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_Shell.c
+ * @addtogroup HAL_Shell
+ * @{
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_Adc.h"
+#include "HAL_AppUart.h"
+#include "HAL_BusTrace.h"
+#include "HAL_Cma3000.h"
+#include "HAL_Cycles.h"
+#include "HAL_Dogs102x6.h"
+#include "HAL_Energy.h"
+#include "HAL_EventLatency.h"
+#include "HAL_Latency.h"
+#include "HAL_LcdBench.h"
+#include "HAL_Profile.h"
+#include "HAL_Scheduler.h"
+#include "HAL_SdBench.h"
+#include "HAL_Stack.h"
+#include "HAL_Timer.h"
+#include "HAL_UCS.h"
+#include "HAL_Wheel.h"
+#include "HAL_Shell.h"
+
+#define BENCH_DEFAULT_RUNS  8
+
+#define CHAR_BACKSPACE      0x08
+#define CHAR_DELETE         0x7F
+
+typedef struct
+{
+    const char *name;
+    void (*handler)(uint8_t argc, char **argv);
+    const char *help;
+} ShellCommand;
+
+typedef struct
+{
+    const char *name;
+    int32_t (*get)(void);
+    uint8_t (*set)(uint32_t value);             // Returns 0 if value rejected; 0 = read-only
+} ShellTunable;
+
+typedef struct
+{
+    const char *name;
+    uint8_t (*ready)(void);                     // Returns 0 if it cannot run now
+    void (*run)(void);
+} ShellBenchmark;
+
+typedef struct
+{
+    const char *name;
+    const uint16_t *pSize;                      // Bytes, sizeof() in the owning module
+} ShellBuffer;
+
+static char line[SHELL_LINE_SIZE];
+static uint8_t lineLength = 0;
+
+// Forward declared functions
+static void Shell_execute(void);
+static uint8_t Shell_parseNumber(const char *text, uint32_t *value);
+static uint8_t Shell_equals(const char *a, const char *b);
+static void Shell_help(uint8_t argc, char **argv);
+static void Shell_peek(uint8_t argc, char **argv);
+static void Shell_poke(uint8_t argc, char **argv);
+static void Shell_get(uint8_t argc, char **argv);
+static void Shell_set(uint8_t argc, char **argv);
+static void Shell_bench(uint8_t argc, char **argv);
+static void Shell_lcdBench(uint8_t argc, char **argv);
+static void Shell_sdBench(uint8_t argc, char **argv);
+static void Shell_prof(uint8_t argc, char **argv);
+static void Shell_printLatency(const char *kind, const LatencyEntry *pEntry);
+static void Shell_lat(uint8_t argc, char **argv);
+static void Shell_e2e(uint8_t argc, char **argv);
+static void Shell_busTrace(uint8_t argc, char **argv);
+static void Shell_energy(uint8_t argc, char **argv);
+static void Shell_stack(uint8_t argc, char **argv);
+static void Shell_tasks(uint8_t argc, char **argv);
+
+/****************************TUNABLES******************************************/
+
+static int32_t Shell_getContrast(void)
+{
+    return Dogs102x6_getContrast();
+}
+
+static uint8_t Shell_setContrast(uint32_t value)
+{
+    if (value > 31)
+        return 0;
+    Dogs102x6_setContrast(value);
+    return 1;
+}
+
+static int32_t Shell_getBacklight(void)
+{
+    return Dogs102x6_getBacklight();
+}
+
+static uint8_t Shell_setBacklight(uint32_t value)
+{
+    if (value > 11)
+        return 0;
+    Dogs102x6_setBacklight(value);
+    return 1;
+}
+
+static int32_t Shell_getWheelHysteresis(void)
+{
+    return Wheel_getHysteresis();
+}
+
+static uint8_t Shell_setWheelHysteresis(uint32_t value)
+{
+    if (value > 0x0FFF)
+        return 0;
+    Wheel_setHysteresis(value);
+    return 1;
+}
+
+static int32_t Shell_getDetents(void)
+{
+    return Wheel_getDetents();
+}
+
+static uint8_t Shell_setDetents(uint32_t value)
+{
+    if (value < 2 || value > WHEEL_MAX_DETENTS)
+        return 0;
+    Wheel_setDetents(value);
+    return 1;
+}
+
+static int32_t Shell_getAccelRate(void)
+{
+    return Cma3000_getSampleRate();
+}
+
+static uint8_t Shell_setAccelRate(uint32_t value)
+{
+    return Cma3000_setSampleRate(value);
+}
+
+static int32_t Shell_getAccelFrames(void)
+{
+    return EventLatency_getAccelFrames();
+}
+
+static uint8_t Shell_setAccelFrames(uint32_t value)
+{
+    if (value > 0xFF)
+        return 0;
+    return EventLatency_setAccelFrames(value);
+}
+
+static int32_t Shell_getBaud(void)
+{
+    return AppUart_getBaudRate();
+}
+
+static uint8_t Shell_setBaud(uint32_t value)
+{
+    // The reply is sent at the new rate; SMCLK can carry the higher rates
+    while (AppUart_txFree() != APPUART_TX_BUFFER_SIZE) ;
+    return AppUart_configure(value > 9600 ? APPUART_CLOCK_SMCLK : APPUART_CLOCK_ACLK,
+                             value) == APPUART_CONFIG_OK;
+}
+
+static int32_t Shell_getWheelRate(void)
+{
+    return Adc_getRate(ADC_CHANNEL_WHEEL);
+}
+
+static uint8_t Shell_setWheelRate(uint32_t value)
+{
+    if (value > ADC_TICK_RATE)
+        return 0;
+    Adc_setRate(ADC_CHANNEL_WHEEL, value);
+    return 1;
+}
+
+static int32_t Shell_getTempRate(void)
+{
+    return Adc_getRate(ADC_CHANNEL_TEMP);
+}
+
+static uint8_t Shell_setTempRate(uint32_t value)
+{
+    if (value > ADC_TICK_RATE)
+        return 0;
+    Adc_setRate(ADC_CHANNEL_TEMP, value);
+    return 1;
+}
+
+static int32_t Shell_getVccRate(void)
+{
+    return Adc_getRate(ADC_CHANNEL_VCC);
+}
+
+static uint8_t Shell_setVccRate(uint32_t value)
+{
+    if (value > ADC_TICK_RATE)
+        return 0;
+    Adc_setRate(ADC_CHANNEL_VCC, value);
+    return 1;
+}
+
+static int32_t Shell_getProfile(void)
+{
+    return UCS_getProfile();
+}
+
+static uint8_t Shell_setProfile(uint32_t value)
+{
+    // The UART divider is recomputed, so let pending output finish first
+    while (AppUart_txFree() != APPUART_TX_BUFFER_SIZE) ;
+    return UCS_selectProfile(value) == UCS_STATUS_OK;
+}
+
+static int32_t Shell_getMclk(void)
+{
+    return UCS_getMclkFrequency();
+}
+
+static int32_t Shell_getTemperature(void)
+{
+    return Adc_getTemperature();
+}
+
+static int32_t Shell_getSupplyVoltage(void)
+{
+    return Adc_getSupplyVoltage();
+}
+
+static const ShellTunable tunables[] = {
+    { "contrast",    Shell_getContrast,        Shell_setContrast        },
+    { "backlight",   Shell_getBacklight,       Shell_setBacklight       },
+    { "wheelhyst",   Shell_getWheelHysteresis, Shell_setWheelHysteresis },
+    { "detents",     Shell_getDetents,         Shell_setDetents         },
+    { "accelrate",   Shell_getAccelRate,       Shell_setAccelRate       },
+    { "accelframes", Shell_getAccelFrames,     Shell_setAccelFrames     },  // Samples per frame, e2e accel
+    { "baud",        Shell_getBaud,            Shell_setBaud            },
+    { "wheelrate",   Shell_getWheelRate,       Shell_setWheelRate       },
+    { "temprate",    Shell_getTempRate,        Shell_setTempRate        },
+    { "vccrate",     Shell_getVccRate,         Shell_setVccRate         },
+    { "profile",     Shell_getProfile,         Shell_setProfile         },  // UCS_PROFILE_xxx
+    { "mclk",        Shell_getMclk,            0                        },  // Hz
+    { "temp",        Shell_getTemperature,     0                        },  // 0.1 C
+    { "vcc",         Shell_getSupplyVoltage,   0                        },  // mV
+};
+
+/****************************BENCHMARKS****************************************/
+
+static uint8_t Shell_lcdReady(void)
+{
+    return !(UCB1CTL1 & UCSWRST);
+}
+
+static void Shell_benchLcdClear(void)
+{
+    Dogs102x6_clearScreen();
+}
+
+static void Shell_benchLcdText(void)
+{
+    Dogs102x6_stringDraw(7, 0, "0123456789ABCDEF", DOGS102x6_DRAW_NORMAL);
+}
+
+static uint8_t Shell_accelReady(void)
+{
+    return Cma3000_initPoll() == CMA3000_INIT_OK;
+}
+
+static void Shell_benchAccel(void)
+{
+    Cma3000_readAccel();
+}
+
+static uint8_t Shell_wheelReady(void)
+{
+    return Adc_getRate(ADC_CHANNEL_WHEEL) != 0;
+}
+
+static void Shell_benchWheel(void)
+{
+    Wheel_getValue();
+}
+
+static const ShellBenchmark benchmarks[] = {
+    { "lcdclear", Shell_lcdReady,   Shell_benchLcdClear },
+    { "lcdtext",  Shell_lcdReady,   Shell_benchLcdText  },
+    { "accel",    Shell_accelReady, Shell_benchAccel    },
+    { "wheel",    Shell_wheelReady, Shell_benchWheel    },
+};
+
+/****************************STATIC BUFFERS************************************/
+
+static const uint16_t lineSize = sizeof(line);
+
+static const ShellBuffer buffers[] = {
+    { "lcd_frame",      &Dogs102x6_ramSize    },
+    { "sdbench",        &SdBench_ramSize      },
+    { "e2e",            &EventLatency_ramSize },
+    { "bustrace",       &BusTrace_ramSize     },
+    { "profile",        &Profile_ramSize      },
+    { "latency",        &Latency_ramSize      },
+    { "scheduler",      &Scheduler_ramSize    },
+    { "uart_rings",     &AppUart_ramSize      },
+    { "adc",            &Adc_ramSize          },
+    { "shell_line",     &lineSize             },
+};
+
+/****************************COMMANDS******************************************/
+
+static const ShellCommand commands[] = {
+    { "help",     Shell_help,      "help" },
+    { "peek",     Shell_peek,      "peek <addr> [8|16]" },
+    { "poke",     Shell_poke,      "poke <addr> <value> [8|16]" },
+    { "get",      Shell_get,       "get [name]" },
+    { "set",      Shell_set,       "set <name> <value>" },
+    { "bench",    Shell_bench,     "bench [name] [runs]" },
+    { "lcdbench", Shell_lcdBench,  "lcdbench" },
+    { "sdbench",  Shell_sdBench,   "sdbench <first block> (overwrites 1024 blocks)" },
+    { "prof",     Shell_prof,      "prof [reset]" },
+    { "lat",      Shell_lat,       "lat [reset]" },
+    { "e2e",      Shell_e2e,       "e2e [reset | accel <hz>]" },
+    { "bustrace", Shell_busTrace,  "bustrace [reset | stop | start]" },
+    { "energy",   Shell_energy,    "energy [reset | current <name> <uA>]" },
+    { "stack",    Shell_stack,     "stack [reset]" },
+    { "tasks",    Shell_tasks,     "tasks [reset | budget|throttle <id> <cycles>]" },
+};
+
+#define NUM_ITEMS(array)    (sizeof(array) / sizeof(array[0]))
+
+/***************************************************************************//**
+ * @brief  Initialize the shell and print the prompt. AppUart_init() must have
+ *         been called.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Shell_init(void)
+{
+    lineLength = 0;
+    Shell_print("\r\n> ");
+}
+
+/***************************************************************************//**
+ * @brief  Consume received characters and execute complete lines.
+ *
+ *         Never waits for input; call it from the main loop.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Shell_process(void)
+{
+    uint8_t c;
+
+    while (AppUart_read(&c, 1))
+    {
+        if (c == '\r' || c == '\n')
+        {
+            if (lineLength == 0 && c == '\n')
+                continue;                       // Second half of CR LF
+
+            Shell_newLine();
+            line[lineLength] = '\0';
+            Shell_execute();
+            lineLength = 0;
+            Shell_print("> ");
+        }
+        else if (c == CHAR_BACKSPACE || c == CHAR_DELETE)
+        {
+            if (lineLength)
+            {
+                lineLength--;
+                Shell_print("\b \b");
+            }
+        }
+        else if (c >= ' ' && lineLength < SHELL_LINE_SIZE - 1)
+        {
+            line[lineLength++] = c;
+            AppUart_putChar(c);                 // Echo
+        }
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Split the current line into arguments and run the matching command
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Shell_execute(void)
+{
+    char *argv[SHELL_MAX_ARGS];
+    uint8_t argc = 0;
+    uint8_t i;
+    char *p = line;
+
+    while (*p && argc < SHELL_MAX_ARGS)
+    {
+        while (*p == ' ')
+            *p++ = '\0';
+        if (*p)
+            argv[argc++] = p;
+        while (*p && *p != ' ')
+            p++;
+    }
+
+    if (argc == 0)
+        return;
+
+    for (i = 0; i < NUM_ITEMS(commands); i++)
+    {
+        if (Shell_equals(argv[0], commands[i].name))
+        {
+            commands[i].handler(argc, argv);
+            return;
+        }
+    }
+    Shell_print("ERR unknown command\r\n");
+}
+
+/****************************OUTPUT********************************************/
+
+/***************************************************************************//**
+ * @brief  Print a string
+ * @param  text  Zero-terminated string
+ * @return none
+ ******************************************************************************/
+
+void Shell_print(const char *text)
+{
+    while (*text)
+        AppUart_putChar(*text++);
+}
+
+/***************************************************************************//**
+ * @brief  Print CR LF
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Shell_newLine(void)
+{
+    Shell_print("\r\n");
+}
+
+/***************************************************************************//**
+ * @brief  Print an unsigned number in decimal
+ * @param  value  Number to print
+ * @return none
+ ******************************************************************************/
+
+void Shell_printUnsigned(uint32_t value)
+{
+    char digits[10];
+    uint8_t count = 0;
+
+    do
+    {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+
+    while (count)
+        AppUart_putChar(digits[--count]);
+}
+
+/***************************************************************************//**
+ * @brief  Print a signed number in decimal
+ * @param  value  Number to print
+ * @return none
+ ******************************************************************************/
+
+void Shell_printSigned(int32_t value)
+{
+    if (value < 0)
+    {
+        AppUart_putChar('-');
+        Shell_printUnsigned(-(uint32_t)value);
+    }
+    else
+    {
+        Shell_printUnsigned(value);
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Print a number in hexadecimal with 0x prefix
+ * @param  value   Number to print
+ * @param  digits  Number of hex digits (1-4)
+ * @return none
+ ******************************************************************************/
+
+void Shell_printHex(uint16_t value, uint8_t digits)
+{
+    static const char hex[] = "0123456789ABCDEF";
+
+    Shell_print("0x");
+    while (digits--)
+        AppUart_putChar(hex[(value >> (4 * digits)) & 0x0F]);
+}
+
+/****************************PARSING*******************************************/
+
+/***************************************************************************//**
+ * @brief  Compare two strings
+ * @param  a  Zero-terminated string
+ * @param  b  Zero-terminated string
+ * @return 1 if equal, 0 otherwise
+ ******************************************************************************/
+
+static uint8_t Shell_equals(const char *a, const char *b)
+{
+    while (*a && *a == *b)
+    {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+/***************************************************************************//**
+ * @brief  Parse a decimal or 0x-prefixed hexadecimal number
+ * @param  text   Zero-terminated string
+ * @param  value  Place to store the number
+ * @return 1 on success, 0 if text is not a number
+ ******************************************************************************/
+
+static uint8_t Shell_parseNumber(const char *text, uint32_t *value)
+{
+    uint32_t result = 0;
+    uint8_t base = 10;
+    uint8_t digit;
+
+    if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X'))
+    {
+        base = 16;
+        text += 2;
+    }
+    if (!*text)
+        return 0;
+
+    while (*text)
+    {
+        if (*text >= '0' && *text <= '9')
+            digit = *text - '0';
+        else if (base == 16 && *text >= 'a' && *text <= 'f')
+            digit = *text - 'a' + 10;
+        else if (base == 16 && *text >= 'A' && *text <= 'F')
+            digit = *text - 'A' + 10;
+        else
+            return 0;
+
+        result = result * base + digit;
+        text++;
+    }
+
+    *value = result;
+    return 1;
+}
+
+/****************************COMMAND HANDLERS**********************************/
+
+static void Shell_help(uint8_t argc, char **argv)
+{
+    uint8_t i;
+
+    for (i = 0; i < NUM_ITEMS(commands); i++)
+    {
+        Shell_print(commands[i].help);
+        Shell_newLine();
+    }
+}
+
+static void Shell_peek(uint8_t argc, char **argv)
+{
+    uint32_t address, width = 8;
+
+    if (argc < 2 || !Shell_parseNumber(argv[1], &address) ||
+        (argc > 2 && !Shell_parseNumber(argv[2], &width)))
+    {
+        Shell_print("ERR usage: peek <addr> [8|16]\r\n");
+        return;
+    }
+
+    if (width == 16)
+        Shell_printHex(*(volatile uint16_t *)(uint16_t)address, 4);
+    else
+        Shell_printHex(*(volatile uint8_t *)(uint16_t)address, 2);
+    Shell_newLine();
+}
+
+static void Shell_poke(uint8_t argc, char **argv)
+{
+    uint32_t address, value, width = 8;
+
+    if (argc < 3 || !Shell_parseNumber(argv[1], &address) ||
+        !Shell_parseNumber(argv[2], &value) ||
+        (argc > 3 && !Shell_parseNumber(argv[3], &width)))
+    {
+        Shell_print("ERR usage: poke <addr> <value> [8|16]\r\n");
+        return;
+    }
+
+    if (width == 16)
+        *(volatile uint16_t *)(uint16_t)address = value;
+    else
+        *(volatile uint8_t *)(uint16_t)address = value;
+    Shell_print("OK\r\n");
+}
+
+static void Shell_get(uint8_t argc, char **argv)
+{
+    uint8_t i;
+
+    for (i = 0; i < NUM_ITEMS(tunables); i++)
+    {
+        if (argc < 2 || Shell_equals(argv[1], tunables[i].name))
+        {
+            Shell_print(tunables[i].name);
+            Shell_print(" = ");
+            Shell_printSigned(tunables[i].get());
+            Shell_newLine();
+            if (argc >= 2)
+                return;
+        }
+    }
+    if (argc >= 2)
+        Shell_print("ERR unknown tunable\r\n");
+}
+
+static void Shell_set(uint8_t argc, char **argv)
+{
+    uint32_t value;
+    uint8_t i;
+
+    if (argc < 3 || !Shell_parseNumber(argv[2], &value))
+    {
+        Shell_print("ERR usage: set <name> <value>\r\n");
+        return;
+    }
+
+    for (i = 0; i < NUM_ITEMS(tunables); i++)
+    {
+        if (Shell_equals(argv[1], tunables[i].name))
+        {
+            if (tunables[i].set == 0)
+                Shell_print("ERR read-only\r\n");
+            else
+                Shell_print(tunables[i].set(value) ? "OK\r\n" : "ERR value rejected\r\n");
+            return;
+        }
+    }
+    Shell_print("ERR unknown tunable\r\n");
+}
+
+static void Shell_bench(uint8_t argc, char **argv)
+{
+    uint32_t runs = BENCH_DEFAULT_RUNS;
+    uint32_t start, cycles, total, min, max;
+    uint32_t overhead;
+    uint16_t run;
+    uint8_t i;
+
+    if (argc < 2)
+    {
+        for (i = 0; i < NUM_ITEMS(benchmarks); i++)
+        {
+            Shell_print(benchmarks[i].name);
+            Shell_newLine();
+        }
+        return;
+    }
+    if ((argc > 2 && !Shell_parseNumber(argv[2], &runs)) || runs == 0 || runs > 0xFFFF)
+    {
+        Shell_print("ERR usage: bench [name] [runs]\r\n");
+        return;
+    }
+
+    for (i = 0; i < NUM_ITEMS(benchmarks); i++)
+    {
+        if (Shell_equals(argv[1], benchmarks[i].name))
+            break;
+    }
+    if (i == NUM_ITEMS(benchmarks))
+    {
+        Shell_print("ERR unknown benchmark\r\n");
+        return;
+    }
+    if (!benchmarks[i].ready())
+    {
+        Shell_print("ERR not initialized\r\n");
+        return;
+    }
+
+    // Cost of the measurement itself
+    start = Cycles_now();
+    overhead = Cycles_now() - start;
+
+    total = max = 0;
+    min = 0xFFFFFFFF;
+    for (run = 0; run < runs; run++)
+    {
+        start = Cycles_now();
+        benchmarks[i].run();
+        cycles = Cycles_now() - start - overhead;
+
+        total += cycles;
+        if (cycles < min)
+            min = cycles;
+        if (cycles > max)
+            max = cycles;
+    }
+
+    Shell_print(benchmarks[i].name);
+    Shell_print(" cycles min ");
+    Shell_printUnsigned(min);
+    Shell_print(" avg ");
+    Shell_printUnsigned(total / runs);
+    Shell_print(" max ");
+    Shell_printUnsigned(max);
+    Shell_print(" (");
+    Shell_printUnsigned(Cycles_toMicroseconds(total / runs));
+    Shell_print(" us)\r\n");
+}
+
+static void Shell_lcdBench(uint8_t argc, char **argv)
+{
+    LcdBenchResult result;
+    uint8_t i;
+
+    if (!Shell_lcdReady())
+    {
+        Shell_print("ERR not initialized\r\n");
+        return;
+    }
+
+    Shell_print("# " LCDBENCH_COLUMNS "\r\n");
+    for (i = 0; i < LcdBench_getCount(); i++)
+    {
+        LcdBench_run(i, &result);
+
+        Shell_print(result.name);
+        Shell_print(" ");
+        Shell_printUnsigned(result.bytes);
+        Shell_print(" ");
+        Shell_printUnsigned(result.selects);
+        Shell_print(" ");
+        Shell_printUnsigned(result.addressSets);
+        Shell_print(" ");
+        Shell_printUnsigned(result.wireMicroseconds);
+        Shell_print(" ");
+        Shell_printUnsigned(result.cycles);
+        Shell_print(" ");
+        Shell_printUnsigned(Cycles_toMicroseconds(result.cycles));
+        Shell_newLine();
+    }
+}
+
+static void Shell_sdBench(uint8_t argc, char **argv)
+{
+    static const char * const errors[] = { "", "ERR no card\r\n", "ERR card init\r\n", "ERR area beyond card\r\n" };
+    SdBenchResult result;
+    uint32_t firstBlock;
+    uint8_t status, divider, test;
+
+    if (argc != 2 || !Shell_parseNumber(argv[1], &firstBlock))
+    {
+        Shell_print("ERR usage: sdbench <first block>\r\n");
+        return;
+    }
+
+    status = SdBench_begin(firstBlock);
+    if (status != SDBENCH_OK)
+    {
+        SdBench_end();
+        Shell_print(errors[status]);
+        return;
+    }
+
+    Shell_print("# " SDBENCH_COLUMNS "\r\n");
+    for (divider = 0; divider < SdBench_getDividerCount(); divider++)
+    {
+        for (test = 0; test < SdBench_getTestCount(); test++)
+        {
+            SdBench_run(divider, test, &result);
+
+            Shell_print(result.name);
+            Shell_print(" ");
+            Shell_printUnsigned(result.divider);
+            Shell_print(" ");
+            Shell_printUnsigned(result.spiKhz);
+            Shell_print(" ");
+            Shell_printUnsigned(result.blocksPerOp);
+            Shell_print(" ");
+            Shell_printUnsigned(result.ops);
+            Shell_print(" ");
+            Shell_printUnsigned(result.errors);
+            Shell_print(" ");
+            Shell_printUnsigned(result.bytesPerSecond / 1024);
+            Shell_print(" ");
+            Shell_printUnsigned(result.p50Us);
+            Shell_print(" ");
+            Shell_printUnsigned(result.p90Us);
+            Shell_print(" ");
+            Shell_printUnsigned(result.maxUs);
+            Shell_print(" ");
+            Shell_printUnsigned(result.busyAvgUs);
+            Shell_print(" ");
+            Shell_printUnsigned(result.busyMaxUs);
+            Shell_newLine();
+        }
+    }
+
+    SdBench_end();
+}
+
+static void Shell_prof(uint8_t argc, char **argv)
+{
+    const ProfileProbe *pProbe;
+    const char *name;
+    uint32_t mean;
+    uint8_t id, bin;
+
+    if (argc > 1)
+    {
+        if (!Shell_equals(argv[1], "reset"))
+        {
+            Shell_print("ERR usage: prof [reset]\r\n");
+            return;
+        }
+        Profile_reset();
+        return;
+    }
+
+    for (id = 0; id < PROFILE_MAX_PROBES; id++)
+    {
+        pProbe = Profile_getProbe(id);
+        if (pProbe->count == 0)
+            continue;
+
+        name = Profile_getName(id);
+        if (name)
+        {
+            Shell_print(name);
+        }
+        else
+        {
+            Shell_print("probe");
+            Shell_printUnsigned(id);
+        }
+        mean = pProbe->total / pProbe->count;
+
+        Shell_print(" n ");
+        Shell_printUnsigned(pProbe->count);
+        Shell_print(" cycles min ");
+        Shell_printUnsigned(pProbe->min);
+        if (pProbe->total == PROFILE_TOTAL_SATURATED)
+        {
+            // Reset the probe to get a mean again
+            Shell_print(" avg sat max ");
+            Shell_printUnsigned(pProbe->max);
+            Shell_print(" hist");
+        }
+        else
+        {
+            Shell_print(" avg ");
+            Shell_printUnsigned(mean);
+            Shell_print(" max ");
+            Shell_printUnsigned(pProbe->max);
+            Shell_print(" (");
+            Shell_printUnsigned(Cycles_toMicroseconds(mean));
+            Shell_print(" us) hist");
+        }
+        for (bin = 0; bin < PROFILE_HISTOGRAM_BINS; bin++)
+        {
+            Shell_print(" ");
+            Shell_printUnsigned(pProbe->histogram[bin]);
+        }
+        Shell_newLine();
+    }
+}
+
+static void Shell_printLatency(const char *kind, const LatencyEntry *pEntry)
+{
+    Shell_print(kind);
+    if (pEntry->site == LATENCY_SITE_NONE)
+    {
+        Shell_print(" other");
+    }
+    else
+    {
+        Shell_print(" ");
+        Shell_print(Latency_getFileName(pEntry->site));
+        Shell_print(":");
+        Shell_printUnsigned(LATENCY_SITE_LINE(pEntry->site));
+    }
+    Shell_print(" n ");
+    Shell_printUnsigned(pEntry->count);
+    Shell_print(" worst ");
+    Shell_printUnsigned(pEntry->worst);
+    Shell_print(" (");
+    Shell_printUnsigned(Cycles_toMicroseconds(pEntry->worst));
+    Shell_print(" us)\r\n");
+}
+
+static void Shell_lat(uint8_t argc, char **argv)
+{
+    const LatencyEntry *pEntry;
+    uint8_t i;
+
+    if (argc > 1)
+    {
+        if (!Shell_equals(argv[1], "reset"))
+        {
+            Shell_print("ERR usage: lat [reset]\r\n");
+            return;
+        }
+        Latency_reset();
+        return;
+    }
+
+    Shell_print("probes ");
+    Shell_printUnsigned(Latency_getProbeCount());
+    Shell_newLine();
+    for (i = 0; i < LATENCY_WORST_N; i++)
+    {
+        if ((pEntry = Latency_getCritical(i)) != 0)
+            Shell_printLatency("crit", pEntry);
+    }
+    for (i = 0; i < LATENCY_WORST_N; i++)
+    {
+        if ((pEntry = Latency_getIsr(i)) != 0)
+            Shell_printLatency("isr", pEntry);
+    }
+}
+
+static void Shell_e2e(uint8_t argc, char **argv)
+{
+    static const uint16_t percentiles[] = { 500, 900, 990, 999 };
+    static const char * const labels[] = { " p50 ", " p90 ", " p99 ", " p999 " };
+    const EventLatencyStats *pStats;
+    uint32_t rate;
+    uint8_t source, i;
+
+    if (argc == 2 && Shell_equals(argv[1], "reset"))
+    {
+        EventLatency_reset();
+        return;
+    }
+    if (argc == 3 && Shell_equals(argv[1], "accel") && Shell_parseNumber(argv[2], &rate) &&
+        rate <= 1000)
+    {
+        if (!EventLatency_startAccel(rate))
+        {
+            Shell_print("ERR accelerometer\r\n");
+            return;
+        }
+        // The rate the timer can actually run at
+        Shell_print("OK period_us ");
+        Shell_printUnsigned(EventLatency_toMicroseconds(EventLatency_getAccelPeriod()));
+        Shell_newLine();
+        return;
+    }
+    if (argc > 1)
+    {
+        Shell_print("ERR usage: e2e [reset | accel <hz>]\r\n");
+        return;
+    }
+
+    for (source = 0; source < EVENTLATENCY_NUM_SOURCES; source++)
+    {
+        pStats = EventLatency_getStats(source);
+        if (pStats->count == 0)
+            continue;
+
+        Shell_print(EventLatency_getName(source));
+        Shell_print(" n ");
+        Shell_printUnsigned(pStats->count);
+        for (i = 0; i < NUM_ITEMS(percentiles); i++)
+        {
+            Shell_print(labels[i]);
+            Shell_printUnsigned(EventLatency_toMicroseconds(EventLatency_getPercentile(source, percentiles[i])));
+        }
+        Shell_print(" max ");
+        Shell_printUnsigned(EventLatency_toMicroseconds(pStats->max));
+        Shell_print(" us\r\n");
+    }
+}
+
+static void Shell_busTrace(uint8_t argc, char **argv)
+{
+    const BusTraceEntry *pEntry;
+    uint32_t total;
+    uint8_t running, count, i;
+
+    if (argc == 2 && Shell_equals(argv[1], "reset"))
+    {
+        BusTrace_reset();
+        return;
+    }
+    if (argc == 2 && (Shell_equals(argv[1], "stop") || Shell_equals(argv[1], "start")))
+    {
+        BusTrace_setRunning(Shell_equals(argv[1], "start"));
+        return;
+    }
+    if (argc > 1)
+    {
+        Shell_print("ERR usage: bustrace [reset | stop | start]\r\n");
+        return;
+    }
+
+    // Hold the ring still while it is printed
+    running = BusTrace_setRunning(0);
+    total = BusTrace_getTotal();
+    count = BusTrace_getCount();
+
+    Shell_print("# bustrace smclk_hz ");
+    Shell_printUnsigned(UCS_getSmclkFrequency());
+    Shell_print(" aclk_hz ");
+    Shell_printUnsigned(Timer_getFrequency());
+    Shell_print(" total ");
+    Shell_printUnsigned(total);
+    Shell_print("\r\n# " BUSTRACE_COLUMNS "\r\n");
+
+    for (i = 0; i < count; i++)
+    {
+        pEntry = BusTrace_getEntry(i);
+
+        Shell_printUnsigned(total - count + i);
+        Shell_print(" ");
+        Shell_print(BusTrace_getDeviceName(pEntry->device));
+        Shell_print(" ");
+        Shell_print(BusTrace_getBusName(pEntry->device));
+        Shell_print(pEntry->direction == BUSTRACE_TX ? " tx " : " rx ");
+        Shell_printUnsigned(pEntry->bytes);
+        Shell_print(" ");
+        Shell_printUnsigned(pEntry->tick);
+        Shell_print(" ");
+        Shell_printUnsigned(pEntry->start);
+        Shell_print(" ");
+        Shell_printUnsigned(pEntry->cycles);
+        Shell_newLine();
+    }
+    Shell_print("# end\r\n");
+
+    BusTrace_setRunning(running);
+}
+
+static void Shell_energy(uint8_t argc, char **argv)
+{
+    uint32_t elapsed, ms, charge, total = 0;
+    uint32_t microamps;
+    uint8_t account;
+
+    if (argc == 2 && Shell_equals(argv[1], "reset"))
+    {
+        Energy_reset();
+        return;
+    }
+    if (argc == 4 && Shell_equals(argv[1], "current") && Shell_parseNumber(argv[3], &microamps))
+    {
+        for (account = 0; account < ENERGY_NUM_ACCOUNTS; account++)
+        {
+            if (Shell_equals(argv[2], Energy_getName(account)))
+                break;
+        }
+        Shell_print(Energy_setCurrent(account, microamps) ? "OK\r\n" : "ERR account or current\r\n");
+        return;
+    }
+    if (argc > 1)
+    {
+        Shell_print("ERR usage: energy [reset | current <name> <uA>]\r\n");
+        return;
+    }
+
+    elapsed = Energy_toMilliseconds(Energy_getElapsed());
+
+    // Time share in permille of the elapsed time, the current configured
+    // (uA per MHz for active) and the estimated charge
+    Shell_print("# name ms permille ua uc\r\n");
+    for (account = 0; account < ENERGY_NUM_ACCOUNTS; account++)
+    {
+        ms = Energy_toMilliseconds(Energy_getTicks(account));
+        charge = Energy_getCharge(account);
+        total += charge;
+
+        Shell_print(Energy_getName(account));
+        Shell_print(" ");
+        Shell_printUnsigned(ms);
+        Shell_print(" ");
+        Shell_printUnsigned(elapsed ? (uint64_t)ms * 1000 / elapsed : 0);
+        Shell_print(" ");
+        Shell_printUnsigned(Energy_getCurrent(account));
+        Shell_print(" ");
+        Shell_printUnsigned(charge);
+        Shell_newLine();
+    }
+
+    // Average current over the elapsed time, for battery life estimates
+    Shell_print("total ");
+    Shell_printUnsigned(elapsed);
+    Shell_print(" ms ");
+    Shell_printUnsigned(total);
+    Shell_print(" uC avg ");
+    Shell_printUnsigned(elapsed ? (uint64_t)total * 1000 / elapsed : 0);
+    Shell_print(" uA\r\n");
+}
+
+static void Shell_stack(uint8_t argc, char **argv)
+{
+    uint16_t total = 0;
+    uint8_t i;
+
+    if (argc == 2 && Shell_equals(argv[1], "reset"))
+    {
+        Stack_reset();
+        return;
+    }
+    if (argc > 1)
+    {
+        Shell_print("ERR usage: stack [reset]\r\n");
+        return;
+    }
+
+    Shell_print("# stack size ");
+    Shell_printUnsigned(Stack_getSize());
+    Shell_print(" high_water ");
+    Shell_printUnsigned(Stack_getHighWater());
+    Shell_print(" now ");
+    Shell_printUnsigned(Stack_getDepth());
+    Shell_print(Stack_getHighWater() >= Stack_getSize() ? " OVERFLOW\r\n" : "\r\n");
+
+    // Deepest stack each ISR was entered with
+    Shell_print("# isr depth\r\n");
+    for (i = 0; i < STACK_NUM_ISRS; i++)
+    {
+        Shell_print(Stack_getIsrName(i));
+        Shell_print(" ");
+        Shell_printUnsigned(Stack_getIsrDepth(i));
+        Shell_newLine();
+    }
+
+    Shell_print("# buffer bytes\r\n");
+    for (i = 0; i < NUM_ITEMS(buffers); i++)
+    {
+        Shell_print(buffers[i].name);
+        Shell_print(" ");
+        Shell_printUnsigned(*buffers[i].pSize);
+        Shell_newLine();
+        total += *buffers[i].pSize;
+    }
+    Shell_print("# buffers ");
+    Shell_printUnsigned(total);
+    Shell_print(" stack ");
+    Shell_printUnsigned(Stack_getSize());
+    Shell_print(" ram ");
+    Shell_printUnsigned(STACK_RAM_SIZE);
+    Shell_print("\r\n");
+}
+
+static void Shell_tasks(uint8_t argc, char **argv)
+{
+    const SchedulerTaskStats *pStats;
+    uint32_t id, cycles;
+    uint8_t worst;
+
+    if (argc == 2 && Shell_equals(argv[1], "reset"))
+    {
+        Scheduler_resetStats();
+        return;
+    }
+    if (argc == 4 && (Shell_equals(argv[1], "budget") || Shell_equals(argv[1], "throttle")) &&
+        Shell_parseNumber(argv[2], &id) && Shell_parseNumber(argv[3], &cycles) &&
+        id < Scheduler_getTaskCount())
+    {
+        Scheduler_setBudget(id, cycles, Shell_equals(argv[1], "throttle") ? SCHEDULER_BUDGET_THROTTLE : 0);
+        return;
+    }
+    if (argc > 1)
+    {
+        Shell_print("ERR usage: tasks [reset | budget|throttle <id> <cycles>]\r\n");
+        return;
+    }
+
+    // Cycles are SMCLK; the period includes any throttling
+    Shell_print("# task period_us budget runs overruns last worst throttle\r\n");
+    for (id = 0; id < Scheduler_getTaskCount(); id++)
+    {
+        pStats = Scheduler_getStats(id);
+
+        Shell_printUnsigned(id);
+        Shell_print(" ");
+        Shell_printUnsigned((uint64_t)(pStats->period << pStats->throttle) * 1000000 / Timer_getFrequency());
+        Shell_print(" ");
+        Shell_printUnsigned(pStats->budget);
+        Shell_print(" ");
+        Shell_printUnsigned(pStats->runs);
+        Shell_print(" ");
+        Shell_printUnsigned(pStats->overruns);
+        Shell_print(" ");
+        Shell_printUnsigned(pStats->last);
+        Shell_print(" ");
+        Shell_printUnsigned(pStats->worst);
+        Shell_print(" ");
+        Shell_printUnsigned(pStats->throttle);
+        Shell_newLine();
+    }
+
+    worst = Scheduler_getWorstTask();
+    if (worst != SCHEDULER_INVALID_TASK)
+    {
+        Shell_print("# worst ");
+        Shell_printUnsigned(worst);
+        Shell_newLine();
+    }
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
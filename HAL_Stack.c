@@ -0,0 +1,189 @@
+/*******************************************************************************
+ *
+ *  HAL_Stack.c - Stack depth and RAM usage monitor
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_Stack.c
+ * @addtogroup HAL_Stack
+ * @{
+ *
+ * Stack high-water mark by painting and the stack depth each ISR starts at.
+ *
+ * Stack_init() fills the stack below the current SP with STACK_PAINT; the
+ * high-water mark is the deepest word that no longer holds the pattern. An
+ * ISR that uses STACK_ISR_SAMPLE() records the depth of the interrupted
+ * context plus its own frame, so the ISR that lands on the deepest main
+ * loop path shows up as the worst case. The stack bounds come from the
+ * linker symbols __STACK_END and __STACK_SIZE.
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_Stack.h"
+
+extern uint16_t __STACK_END;           // Linker: one past the top of the stack
+extern uint16_t __STACK_SIZE;          // Linker: the address is the size
+
+#define STACK_TOP           ((uint16_t)&__STACK_END)
+#define STACK_BYTES         ((uint16_t)&__STACK_SIZE)
+#define STACK_BOTTOM        ((uint16_t *)(STACK_TOP - STACK_BYTES))
+
+static uint16_t isrDepths[STACK_NUM_ISRS];
+
+static const char * const isrNames[STACK_NUM_ISRS] = {
+    "appuart",
+    "port1",
+    "port2",
+    "cycles",
+    "dma",
+    "timer_compare",
+    "timer_overflow",
+};
+
+/***************************************************************************//**
+ * @brief  Paint the unused stack; call first thing in main()
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Stack_init(void)
+{
+    Stack_reset();
+}
+
+/***************************************************************************//**
+ * @brief  Repaint the unused stack and clear the ISR samples, restarting the
+ *         high-water mark from the current depth
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Stack_reset(void)
+{
+    uint16_t gie = __get_SR_register() & GIE;   // Store current GIE state
+    uint16_t *pWord = STACK_BOTTOM;
+    uint16_t *pEnd;
+    uint8_t i;
+
+    __disable_interrupt();
+
+    // Nothing below the SP is in use while interrupts are disabled
+    pEnd = (uint16_t *)(__get_SP_register() - STACK_PAINT_GUARD);
+    while (pWord < pEnd)
+        *pWord++ = STACK_PAINT;
+
+    for (i = 0; i < STACK_NUM_ISRS; i++)
+        isrDepths[i] = 0;
+
+    __bis_SR_register(gie);                     // Restore original GIE state
+}
+
+/***************************************************************************//**
+ * @brief  Record the stack depth at ISR entry; use STACK_ISR_SAMPLE()
+ * @param  isr  STACK_ISR_APPUART ... STACK_ISR_TIMER_OVERFLOW
+ * @param  sp   Stack pointer in the ISR
+ * @return none
+ ******************************************************************************/
+
+void Stack_sampleIsr(uint8_t isr, uint16_t sp)
+{
+    uint16_t depth = STACK_TOP - sp;
+
+    if (isr < STACK_NUM_ISRS && depth > isrDepths[isr])
+        isrDepths[isr] = depth;
+}
+
+/***************************************************************************//**
+ * @brief  Get the size of the stack reserved by the linker
+ * @param  none
+ * @return Bytes
+ ******************************************************************************/
+
+uint16_t Stack_getSize(void)
+{
+    return STACK_BYTES;
+}
+
+/***************************************************************************//**
+ * @brief  Get the current stack depth
+ * @param  none
+ * @return Bytes in use at the caller
+ ******************************************************************************/
+
+uint16_t Stack_getDepth(void)
+{
+    return STACK_TOP - __get_SP_register();
+}
+
+/***************************************************************************//**
+ * @brief  Get the deepest stack use since the last paint
+ * @param  none
+ * @return Bytes; Stack_getSize() if the bottom word was overwritten, i.e.
+ *         the stack may have overflowed
+ ******************************************************************************/
+
+uint16_t Stack_getHighWater(void)
+{
+    const uint16_t *pWord = STACK_BOTTOM;
+
+    while (pWord < (const uint16_t *)STACK_TOP && *pWord == STACK_PAINT)
+        pWord++;
+
+    return STACK_TOP - (uint16_t)pWord;
+}
+
+/***************************************************************************//**
+ * @brief  Get the deepest stack an ISR was entered with
+ * @param  isr  STACK_ISR_APPUART ... STACK_ISR_TIMER_OVERFLOW
+ * @return Bytes, 0 if it has not run since the last reset
+ ******************************************************************************/
+
+uint16_t Stack_getIsrDepth(uint8_t isr)
+{
+    return isr < STACK_NUM_ISRS ? isrDepths[isr] : 0;
+}
+
+/***************************************************************************//**
+ * @brief  Get the name of a sampled ISR
+ * @param  isr  STACK_ISR_APPUART ... STACK_ISR_TIMER_OVERFLOW
+ * @return Name, "?" if unknown
+ ******************************************************************************/
+
+const char *Stack_getIsrName(uint8_t isr)
+{
+    return isr < STACK_NUM_ISRS ? isrNames[isr] : "?";
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
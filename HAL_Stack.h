@@ -0,0 +1,77 @@
+/*******************************************************************************
+ *
+ *  HAL_Stack.h
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef HAL_STACK_H
+#define HAL_STACK_H
+
+#include <stdint.h>
+
+// Set to 0 to compile the ISR stack samples out
+#ifndef STACK_ENABLED
+#define STACK_ENABLED           1
+#endif
+
+#define STACK_RAM_SIZE          8192   // MSP430F5529 RAM, USB RAM not counted
+#define STACK_PAINT             0xA55A // Fill pattern of unused stack words
+#define STACK_PAINT_GUARD       16     // Bytes below the SP left unpainted
+
+// ISRs sampled with STACK_ISR_SAMPLE()
+#define STACK_ISR_APPUART       0
+#define STACK_ISR_PORT1         1
+#define STACK_ISR_PORT2         2
+#define STACK_ISR_CYCLES        3
+#define STACK_ISR_DMA           4
+#define STACK_ISR_TIMER_COMPARE 5
+#define STACK_ISR_TIMER_OVERFLOW 6
+#define STACK_NUM_ISRS          7
+
+#if STACK_ENABLED
+// First statement of an ISR: records the stack depth the ISR starts at
+#define STACK_ISR_SAMPLE(isr)   Stack_sampleIsr((isr), __get_SP_register())
+#else
+#define STACK_ISR_SAMPLE(isr)
+#endif
+
+extern void Stack_init(void);
+extern void Stack_reset(void);
+extern void Stack_sampleIsr(uint8_t isr, uint16_t sp);
+extern uint16_t Stack_getSize(void);
+extern uint16_t Stack_getDepth(void);
+extern uint16_t Stack_getHighWater(void);
+extern uint16_t Stack_getIsrDepth(uint8_t isr);
+extern const char *Stack_getIsrName(uint8_t isr);
+
+#endif /* HAL_STACK_H */
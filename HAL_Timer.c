@@ -0,0 +1,447 @@
+/*******************************************************************************
+ *
+ *  HAL_Timer.c - Tickless software timers on the free-running TA2
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_Timer.c
+ * @addtogroup HAL_Timer
+ * @{
+ *
+ * Any number of one-shot and periodic software timers share TA2 CCR0. The
+ * active timers are kept in a list sorted by deadline and only the nearest
+ * deadline is programmed into the compare register, so the CPU only wakes
+ * when a timer expires (and on the counter overflow every 2^16 ticks, which
+ * extends the count to 32 bits).
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_UCS.h"
+#include "HAL_Energy.h"
+#include "HAL_Profile.h"
+#include "HAL_Stack.h"
+#include "HAL_Timer.h"
+
+#define TIMER_CTL           TA2CTL
+#define TIMER_EX0           TA2EX0
+#define TIMER_R             TA2R
+#define TIMER_IV            TA2IV
+#define TIMER_CCTL          TA2CCTL0
+#define TIMER_CCR           TA2CCR0
+
+static SoftTimer *timerList = 0;
+static volatile uint16_t timerHigh = 0;         // Counter overflows
+static uint32_t timerFrequency = 32768;
+static uint8_t initialized = 0;
+
+// Forward declared functions
+static void Timer_insert(SoftTimer *pTimer);
+static void Timer_remove(SoftTimer *pTimer);
+static void Timer_program(void);
+static void Timer_sleep(uint32_t ticks, uint16_t lpmBits);
+
+/***************************************************************************//**
+ * @brief  Start TA2 as a free-running ACLK timebase unless it is already
+ *         running, and determine its input frequency.
+ *
+ *         Safe to call from every module that uses timers.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Timer_init(void)
+{
+    uint32_t clock;
+
+    if (initialized)
+        return;
+    initialized = 1;
+
+    if (!(TIMER_CTL & MC_3))
+    {
+        TIMER_CTL = TASSEL__ACLK + MC__CONTINOUS + TACLR;
+    }
+    TIMER_CTL |= TAIE;                         // Extend the count to 32 bits
+
+    // Derive the tick rate from TA2's actual input clock
+    if ((TIMER_CTL & TASSEL_3) == TASSEL__SMCLK)
+        clock = UCS_getSmclkFrequency();
+    else
+        clock = UCS_getAclkFrequency();
+    clock >>= (TIMER_CTL & ID_3) >> 6;
+    clock /= (TIMER_EX0 & TAIDEX_7) + 1;
+    timerFrequency = clock;
+}
+
+/***************************************************************************//**
+ * @brief  Get the timer's tick rate
+ * @param  none
+ * @return Ticks per second
+ ******************************************************************************/
+
+uint32_t Timer_getFrequency(void)
+{
+    return timerFrequency;
+}
+
+/***************************************************************************//**
+ * @brief  Convert milliseconds to timer ticks
+ * @param  ms  Interval in milliseconds
+ * @return Ticks, at least 1
+ ******************************************************************************/
+
+uint32_t Timer_msToTicks(uint16_t ms)
+{
+    uint32_t ticks = timerFrequency * ms / 1000;
+
+    return ticks ? ticks : 1;
+}
+
+/***************************************************************************//**
+ * @brief  Get the low-power mode bits that must stay clear for the timer to
+ *         keep counting
+ * @param  none
+ * @return OSCOFF when clocked by ACLK, SCG1 + SCG0 + OSCOFF for SMCLK
+ ******************************************************************************/
+
+uint16_t Timer_getWakeBits(void)
+{
+    if ((TIMER_CTL & TASSEL_3) == TASSEL__SMCLK)
+        return SCG1 + SCG0 + OSCOFF;
+    return OSCOFF;
+}
+
+/***************************************************************************//**
+ * @brief  Read the 32-bit tick count
+ * @param  none
+ * @return Ticks since Timer_init()
+ ******************************************************************************/
+
+uint32_t Timer_now(void)
+{
+    uint16_t gie = __get_SR_register() & GIE;   // Store current GIE state
+    uint16_t high, low;
+
+    __disable_interrupt();
+
+    low = TIMER_R;
+    high = timerHigh;
+    if ((TIMER_CTL & TAIFG) && low < 0x8000)
+        high++;                                 // Wrapped before TAR was read
+
+    __bis_SR_register(gie);                     // Restore original GIE state
+
+    return ((uint32_t)high << 16) | low;
+}
+
+/***************************************************************************//**
+ * @brief  Prepare a timer for use
+ * @param  pTimer   Timer, usually static storage of the owning module
+ * @param  handler  Called in interrupt context on expiry, or 0 to only wake
+ *                  the CPU
+ * @return none
+ ******************************************************************************/
+
+void Timer_create(SoftTimer *pTimer, Timer_handler handler)
+{
+    pTimer->next = 0;
+    pTimer->handler = handler;
+    pTimer->active = 0;
+    pTimer->expired = 0;
+}
+
+/***************************************************************************//**
+ * @brief  (Re)start a timer
+ * @param  pTimer  Timer set up with Timer_create()
+ * @param  ticks   Ticks until the first expiry
+ * @param  period  Ticks between following expiries, 0 for a one-shot timer
+ * @return none
+ ******************************************************************************/
+
+void Timer_start(SoftTimer *pTimer, uint32_t ticks, uint32_t period)
+{
+    uint16_t gie = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+    if (pTimer->active)
+        Timer_remove(pTimer);
+
+    pTimer->deadline = Timer_now() + ticks;
+    pTimer->period = period;
+    pTimer->expired = 0;
+    Timer_insert(pTimer);
+    Timer_program();
+    __bis_SR_register(gie);
+}
+
+/***************************************************************************//**
+ * @brief  Stop a timer; nothing happens if it is not running
+ * @param  pTimer  Timer set up with Timer_create()
+ * @return none
+ ******************************************************************************/
+
+void Timer_stop(SoftTimer *pTimer)
+{
+    uint16_t gie = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+    if (pTimer->active)
+    {
+        Timer_remove(pTimer);
+        Timer_program();
+    }
+    __bis_SR_register(gie);
+}
+
+/***************************************************************************//**
+ * @brief  Wait for a number of ticks in a low-power mode.
+ *
+ *         With interrupts disabled it has to poll the counter instead.
+ * @param  ticks    Ticks to wait; the wait is between ticks - 1 and ticks
+ * @param  lpmBits  Low-power mode to wait in
+ * @return none
+ ******************************************************************************/
+
+static void Timer_sleep(uint32_t ticks, uint16_t lpmBits)
+{
+    SoftTimer delayTimer;
+    uint32_t start;
+
+    if (!(__get_SR_register() & GIE))
+    {
+        start = Timer_now();
+        while (Timer_now() - start < ticks) ;
+        return;
+    }
+
+    Timer_create(&delayTimer, 0);
+    Timer_start(&delayTimer, ticks, 0);
+
+    __disable_interrupt();
+    while (!delayTimer.expired)
+    {
+        ENERGY_SLEEP(lpmBits);                  // Timer ISR will force exit
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+}
+
+/***************************************************************************//**
+ * @brief  Wait for a number of ticks in the deepest low-power mode that keeps
+ *         the timer running
+ * @param  ticks  Ticks to wait; the wait is between ticks - 1 and ticks
+ * @return none
+ ******************************************************************************/
+
+void Timer_delay(uint32_t ticks)
+{
+    if (Timer_getWakeBits() == OSCOFF)
+        Timer_sleep(ticks, LPM3_bits);
+    else
+        Timer_sleep(ticks, LPM0_bits);
+}
+
+/***************************************************************************//**
+ * @brief  Wait for a number of ticks in LPM0, which keeps SMCLK and the FLL
+ *         running, e.g. while the DCO settles
+ * @param  ticks  Ticks to wait; the wait is between ticks - 1 and ticks
+ * @return none
+ ******************************************************************************/
+
+void Timer_delayActive(uint32_t ticks)
+{
+    Timer_sleep(ticks, LPM0_bits);
+}
+
+/***************************************************************************//**
+ * @brief  Wait for at least a number of microseconds
+ * @param  us  Microseconds to wait
+ * @return none
+ ******************************************************************************/
+
+void Timer_delayUs(uint16_t us)
+{
+    // Round up and add a tick for the partial tick already elapsed
+    Timer_delay((timerFrequency * us + 999999UL) / 1000000UL + 1);
+}
+
+/***************************************************************************//**
+ * @brief  Wait for at least a number of milliseconds
+ * @param  ms  Milliseconds to wait
+ * @return none
+ ******************************************************************************/
+
+void Timer_delayMs(uint16_t ms)
+{
+    Timer_delay(Timer_msToTicks(ms) + 1);
+}
+
+/***************************************************************************//**
+ * @brief  Insert a timer into the sorted list, after timers with the same
+ *         deadline. Must be called with interrupts disabled.
+ * @param  pTimer  Timer to insert
+ * @return none
+ ******************************************************************************/
+
+static void Timer_insert(SoftTimer *pTimer)
+{
+    SoftTimer **ppLink = &timerList;
+
+    while (*ppLink && (int32_t)((*ppLink)->deadline - pTimer->deadline) <= 0)
+        ppLink = &(*ppLink)->next;
+
+    pTimer->next = *ppLink;
+    *ppLink = pTimer;
+    pTimer->active = 1;
+}
+
+/***************************************************************************//**
+ * @brief  Remove a timer from the list. Must be called with interrupts
+ *         disabled.
+ * @param  pTimer  Timer to remove
+ * @return none
+ ******************************************************************************/
+
+static void Timer_remove(SoftTimer *pTimer)
+{
+    SoftTimer **ppLink = &timerList;
+
+    while (*ppLink && *ppLink != pTimer)
+        ppLink = &(*ppLink)->next;
+
+    if (*ppLink)
+        *ppLink = pTimer->next;
+    pTimer->next = 0;
+    pTimer->active = 0;
+}
+
+/***************************************************************************//**
+ * @brief  Program the compare register for the nearest deadline.
+ *
+ *         Deadlines more than one counter period away are left to the
+ *         overflow interrupt. Must be called with interrupts disabled.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Timer_program(void)
+{
+    int32_t remaining;
+
+    if (!timerList)
+    {
+        TIMER_CCTL = 0;
+        return;
+    }
+
+    remaining = timerList->deadline - Timer_now();
+    if (remaining >= 0x10000)
+    {
+        TIMER_CCTL = 0;                        // Overflow ISR will come back
+        return;
+    }
+
+    TIMER_CCR = (uint16_t)timerList->deadline;
+    TIMER_CCTL = CCIE;
+
+    // The counter may have passed the deadline before CCR was written
+    if ((int32_t)(timerList->deadline - Timer_now()) <= 0)
+        TIMER_CCTL = CCIE + CCIFG;
+}
+
+/***************************************************************************//**
+ * @brief  Handles Timer2_A0 interrupts - runs the expired timers.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+#pragma vector = TIMER2_A0_VECTOR
+__interrupt void Timer_compare_ISR(void)
+{
+    SoftTimer *pTimer;
+    uint16_t wakeBits = 0;
+
+    STACK_ISR_SAMPLE(STACK_ISR_TIMER_COMPARE);
+    PROFILE_ENTER(PROFILE_ISR_TIMER);
+
+    while (timerList && (int32_t)(timerList->deadline - Timer_now()) <= 0)
+    {
+        pTimer = timerList;
+        Timer_remove(pTimer);
+        pTimer->expired = 1;
+
+        if (pTimer->period)
+        {
+            pTimer->deadline += pTimer->period;  // Drift-free
+            Timer_insert(pTimer);
+        }
+
+        if (pTimer->handler)
+            wakeBits |= pTimer->handler(pTimer);
+        else
+            wakeBits |= LPM4_bits;
+    }
+
+    Timer_program();
+    PROFILE_EXIT(PROFILE_ISR_TIMER);
+    __bic_SR_register_on_exit(wakeBits);
+}
+
+/***************************************************************************//**
+ * @brief  Handles Timer2_A1 interrupts - counts overflows and programs
+ *         deadlines that have come within one counter period.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+#pragma vector = TIMER2_A1_VECTOR
+__interrupt void Timer_overflow_ISR(void)
+{
+    STACK_ISR_SAMPLE(STACK_ISR_TIMER_OVERFLOW);
+
+    switch (__even_in_range(TIMER_IV, TA2IV_TAIFG))
+    {
+        // Vector TA2IV_TAIFG: Timer overflow
+        case TA2IV_TAIFG:
+            timerHigh++;
+            Timer_program();
+            break;
+
+        default:
+            break;
+    }
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
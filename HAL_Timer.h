@@ -0,0 +1,71 @@
+/*******************************************************************************
+ *
+ *  HAL_Timer.h
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef HAL_TIMER_H
+#define HAL_TIMER_H
+
+#include <stdint.h>
+
+typedef struct SoftTimer SoftTimer;
+
+// Called from the TA2 ISR when a timer expires. Returns the status register
+// bits to clear on exit, e.g. LPM3_bits to wake the CPU.
+typedef uint16_t (*Timer_handler)(SoftTimer *pTimer);
+
+struct SoftTimer
+{
+    SoftTimer *next;                   // Managed by HAL_Timer
+    uint32_t deadline;
+    uint32_t period;                   // Ticks, 0 = one-shot
+    Timer_handler handler;             // 0 = just wake the CPU
+    volatile uint8_t active;
+    volatile uint8_t expired;          // Set on each expiry, cleared by start
+};
+
+extern void Timer_init(void);
+extern uint32_t Timer_getFrequency(void);
+extern uint32_t Timer_msToTicks(uint16_t ms);
+extern uint16_t Timer_getWakeBits(void);
+extern uint32_t Timer_now(void);
+extern void Timer_create(SoftTimer *pTimer, Timer_handler handler);
+extern void Timer_start(SoftTimer *pTimer, uint32_t ticks, uint32_t period);
+extern void Timer_stop(SoftTimer *pTimer);
+extern void Timer_delay(uint32_t ticks);
+extern void Timer_delayActive(uint32_t ticks);
+extern void Timer_delayUs(uint16_t us);
+extern void Timer_delayMs(uint16_t ms);
+
+#endif /* HAL_TIMER_H */
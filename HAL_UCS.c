@@ -0,0 +1,494 @@
+/*******************************************************************************
+ *
+ *  HAL_UCS.c - Unified Clock System helpers
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_UCS.c
+ * @addtogroup HAL_UCS
+ * @{
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_PMM.h"
+#include "HAL_Timer.h"
+#include "HAL_UCS.h"
+
+#define XT1_PORT_SEL        P5SEL
+#define XT1_PINS            (BIT4 + BIT5)
+
+#define XT1_STARTUP_POLLS   50000U     // Fault flag polls before falling back to REFO
+#define DCO_FAULT_POLLS     1000U
+#define FLL_REFERENCE       32768UL    // XT1 or REFO, FLLREFDIV = 1
+#define FLL_SETTLE_CYCLES   (32UL * 32 * 2)  // Reference cycles, n x 32 x 32 with FLLD = 2
+
+// Field masks and shifts of the UCS control registers
+#define DCO_TAP_STEP        0x0100     // UCSCTL0 DCOx LSB, about 8 % of DCOCLK
+#define FLLN_MASK           0x03FF     // UCSCTL2 FLLN
+#define FLLD_SHIFT          12         // UCSCTL2 FLLD
+#define FLLREFDIV_MASK      0x0007     // UCSCTL3 FLLREFDIV
+#define SELREF_SHIFT        4          // UCSCTL3 SELREF
+#define SELM_SHIFT          0          // UCSCTL4 SELM, UCSCTL5 DIVM
+#define SELS_SHIFT          4          // UCSCTL4 SELS, UCSCTL5 DIVS
+#define SELA_SHIFT          8          // UCSCTL4 SELA, UCSCTL5 DIVA
+
+// Clock source encodings shared by SELREF/SELA/SELS/SELM
+#define SOURCE_XT1CLK       0
+#define SOURCE_VLOCLK       1
+#define SOURCE_REFOCLK      2
+#define SOURCE_DCOCLK       3
+#define SOURCE_DCOCLKDIV    4
+#define SOURCE_XT2CLK       5
+
+// MCLK = SMCLK, ACLK from the watch crystal in every profile so the
+// HAL_Timer timebase is not affected by profile changes
+const UCS_Profile UCS_profiles[UCS_NUM_PROFILES] = {
+    { UCS_MAX_FREQUENCY, DIVS__1, SELA__XT1CLK },   // UCS_PROFILE_BURST
+    { 8000000UL,         DIVS__1, SELA__XT1CLK },   // UCS_PROFILE_NORMAL
+    { 1000000UL,         DIVS__1, SELA__XT1CLK }    // UCS_PROFILE_IDLE
+};
+
+static uint8_t xt1Running = 0;
+static uint8_t currentProfile = UCS_PROFILE_CUSTOM;
+static uint16_t settledTap[UCS_NUM_PROFILES];   // UCSCTL0 after locking, 0 = unknown
+static UCS_clockCallback clockCallbacks[UCS_MAX_CALLBACKS];
+static uint8_t numClockCallbacks = 0;
+
+// Forward declared functions
+static uint16_t UCS_getDcoRange(uint32_t dcoFrequency);
+static uint8_t UCS_clearDcoFault(void);
+static uint8_t UCS_settleFll(void);
+static uint8_t UCS_program(const UCS_Profile *pProfile, uint16_t dcoTap);
+static void UCS_notifyClockChange(void);
+static uint32_t UCS_getFllReferenceFrequency(void);
+static uint32_t UCS_getSourceFrequency(uint8_t source);
+static uint32_t UCS_getClockFrequency(uint8_t shift);
+
+/***************************************************************************//**
+ * @brief  Select the DCO range for a DCOCLK frequency, keeping the FLL near
+ *         the middle of the range
+ * @param  dcoFrequency  DCOCLK in Hz
+ * @return DCORSEL_0 ... DCORSEL_7
+ ******************************************************************************/
+
+static uint16_t UCS_getDcoRange(uint32_t dcoFrequency)
+{
+    // Upper limit of DCORSEL_0 ... DCORSEL_6 in kHz
+    static const uint16_t rangeLimit[] = { 630, 1250, 2500, 5000, 10000, 20000, 40000 };
+    uint16_t kHz = dcoFrequency / 1000;
+    uint8_t range = 0;
+
+    while (range < sizeof(rangeLimit) / sizeof(rangeLimit[0]) && kHz > rangeLimit[range])
+        range++;
+
+    return range * DCORSEL_1;
+}
+
+/***************************************************************************//**
+ * @brief  Clear the DCO fault flag once the DCO is within its range, then the
+ *         oscillator fault flag if no other fault is pending.
+ * @param  none
+ * @return UCS_STATUS_OK or UCS_STATUS_ERR_DCO
+ ******************************************************************************/
+
+static uint8_t UCS_clearDcoFault(void)
+{
+    uint16_t polls = DCO_FAULT_POLLS;
+
+    do
+    {
+        UCSCTL7 &= ~DCOFFG;
+    } while ((UCSCTL7 & DCOFFG) && --polls);
+
+    if (!(UCSCTL7 & (XT2OFFG + XT1LFOFFG + DCOFFG)))
+        SFRIFG1 &= ~OFIFG;
+
+    return (UCSCTL7 & DCOFFG) ? UCS_STATUS_ERR_DCO : UCS_STATUS_OK;
+}
+
+/***************************************************************************//**
+ * @brief  Wait for the DCO to settle after the FLL was reprogrammed, then
+ *         clear the oscillator fault flags.
+ *
+ *         There is no lock flag, so the worst case of n x 32 x 32 reference
+ *         cycles is waited for. The CPU sleeps in LPM0 meanwhile because the
+ *         FLL stops in deeper modes.
+ * @param  none
+ * @return UCS_STATUS_OK or UCS_STATUS_ERR_DCO
+ ******************************************************************************/
+
+static uint8_t UCS_settleFll(void)
+{
+    Timer_init();
+    Timer_delayActive(FLL_SETTLE_CYCLES * Timer_getFrequency() / FLL_REFERENCE + 1);
+
+    return UCS_clearDcoFault();
+}
+
+/***************************************************************************//**
+ * @brief  Let the registered drivers recompute their clock dividers
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void UCS_notifyClockChange(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < numClockCallbacks; i++)
+        clockCallbacks[i]();
+}
+
+/***************************************************************************//**
+ * @brief  Start the XT1 watch crystal and select it for ACLK and as the FLL
+ *         reference. Falls back to REFO if it does not start.
+ *
+ *         Call once before UCS_setProfile() and before Timer_init().
+ * @param  none
+ * @return UCS_STATUS_OK or UCS_STATUS_ERR_XT1
+ ******************************************************************************/
+
+uint8_t UCS_init(void)
+{
+    uint16_t polls = XT1_STARTUP_POLLS;
+
+    XT1_PORT_SEL |= XT1_PINS;
+
+    // Start in LF mode at maximum drive for a fast startup
+    UCSCTL6 = (UCSCTL6 & ~(XT1OFF + XTS)) | XCAP_3 | XT1DRIVE_3;
+
+    do
+    {
+        UCSCTL7 &= ~XT1LFOFFG;
+    } while ((UCSCTL7 & XT1LFOFFG) && --polls);
+
+    if (UCSCTL7 & XT1LFOFFG)
+    {
+        UCSCTL6 |= XT1OFF;
+        xt1Running = 0;
+        SELECT_ACLK(SELA__REFOCLK);
+        SELECT_FLLREF(SELREF__REFOCLK);
+        return UCS_STATUS_ERR_XT1;
+    }
+
+    // Lowest drive once running
+    UCSCTL6 &= ~XT1DRIVE_3;
+    xt1Running = 1;
+    SELECT_ACLK(SELA__XT1CLK);
+    SELECT_FLLREF(SELREF__XT1CLK);
+    if (!(UCSCTL7 & (XT2OFFG + DCOFFG)))
+        SFRIFG1 &= ~OFIFG;
+
+    return UCS_STATUS_OK;
+}
+
+/***************************************************************************//**
+ * @brief  Apply a clock profile.
+ *
+ *         VCore is raised before MCLK goes up and lowered after it came down.
+ *         The DCO restarts from its lowest tap and climbs to the new
+ *         frequency, so the registered drivers are notified as soon as the
+ *         new settings are programmed: dividers computed for the target are
+ *         safe while the FLL settles.
+ * @param  pProfile  Clock profile, e.g. &UCS_profiles[UCS_PROFILE_BURST]
+ * @return UCS_STATUS_OK, UCS_STATUS_ERR_RANGE or UCS_STATUS_ERR_VCORE
+ *         (clocks unchanged), or UCS_STATUS_ERR_DCO
+ ******************************************************************************/
+
+uint8_t UCS_setProfile(const UCS_Profile *pProfile)
+{
+    return UCS_program(pProfile, 0x0000);
+}
+
+/***************************************************************************//**
+ * @brief  Program the clocks for a profile, see UCS_setProfile().
+ * @param  pProfile  Clock profile
+ * @param  dcoTap    UCSCTL0 to start the DCO from: 0 to climb from the lowest
+ *                   tap and wait for the FLL to settle, or a tap just below
+ *                   the lock point of the profile to only wait for the DCO
+ *                   fault flag to clear
+ * @return Status as UCS_setProfile()
+ ******************************************************************************/
+
+static uint8_t UCS_program(const UCS_Profile *pProfile, uint16_t dcoTap)
+{
+    uint32_t frequency = pProfile->mclkFrequency;
+    uint16_t aclkSource = pProfile->aclkSource;
+    uint8_t level = PMM_LEVEL_FOR(frequency);
+    uint16_t multiplier = frequency / FLL_REFERENCE;
+
+    if (frequency > UCS_MAX_FREQUENCY || multiplier < 2 || multiplier > FLLN_MASK + 1)
+        return UCS_STATUS_ERR_RANGE;
+
+    if (level > PMM_getVCore() && PMM_setVCore(level) != PMM_STATUS_OK)
+    {
+        PMM_setVCore(PMM_LEVEL_FOR(UCS_getMclkFrequency()));
+        return UCS_STATUS_ERR_VCORE;
+    }
+
+    if (aclkSource == SELA__XT1CLK && !xt1Running)
+        aclkSource = SELA__REFOCLK;
+
+    __bis_SR_register(SCG0);                   // Disable the FLL control loop
+    UCSCTL0 = dcoTap;                          // MCLK ramps up from here
+    UCSCTL1 = UCS_getDcoRange(2 * frequency);
+    UCSCTL2 = FLLD__2 + (multiplier - 1);      // DCOCLKDIV = multiplier x reference
+    UCSCTL3 = (xt1Running ? SELREF__XT1CLK : SELREF__REFOCLK) + FLLREFDIV__1;
+    UCSCTL4 = aclkSource + SELS__DCOCLKDIV + SELM__DCOCLKDIV;
+    UCSCTL5 = (UCSCTL5 & ~DIVS_7) | pProfile->smclkDivider;
+    __bic_SR_register(SCG0);                   // Enable the FLL control loop
+
+    currentProfile = UCS_PROFILE_CUSTOM;
+    UCS_notifyClockChange();
+
+    if ((dcoTap ? UCS_clearDcoFault() : UCS_settleFll()) != UCS_STATUS_OK)
+        return UCS_STATUS_ERR_DCO;
+
+    if (level < PMM_getVCore())
+        PMM_setVCore(level);
+
+    return UCS_STATUS_OK;
+}
+
+/***************************************************************************//**
+ * @brief  Switch to one of the performance profiles, e.g. UCS_PROFILE_BURST
+ *         around a display refresh or SD transfer and UCS_PROFILE_IDLE after.
+ *
+ *         The first switch to a profile waits for the FLL to settle (about
+ *         63 ms) in LPM0 and remembers the DCO tap it locked at. Later
+ *         switches start one tap below it, so MCLK cannot overshoot if the DCO
+ *         drifted, and only wait for the DCO fault flag to clear; the FLL
+ *         closes the remaining few percent within a few milliseconds.
+ * @param  profile  UCS_PROFILE_BURST, UCS_PROFILE_NORMAL or UCS_PROFILE_IDLE
+ * @return Status of UCS_setProfile(), UCS_STATUS_OK if already selected
+ ******************************************************************************/
+
+uint8_t UCS_selectProfile(uint8_t profile)
+{
+    uint16_t dcoTap;
+    uint8_t status;
+
+    if (profile >= UCS_NUM_PROFILES)
+        return UCS_STATUS_ERR_RANGE;
+    if (profile == currentProfile)
+        return UCS_STATUS_OK;
+
+    dcoTap = settledTap[profile];
+    if (dcoTap >= DCO_TAP_STEP)
+        dcoTap -= DCO_TAP_STEP;
+
+    status = UCS_program(&UCS_profiles[profile], dcoTap);
+    if (status == UCS_STATUS_OK)
+    {
+        currentProfile = profile;
+        if (!settledTap[profile])
+            settledTap[profile] = UCSCTL0;
+    }
+    else if (status == UCS_STATUS_ERR_DCO)
+    {
+        settledTap[profile] = 0;               // Settle fully next time
+    }
+    return status;
+}
+
+/***************************************************************************//**
+ * @brief  Get the selected performance profile
+ * @param  none
+ * @return UCS_PROFILE_xxx, or UCS_PROFILE_CUSTOM
+ ******************************************************************************/
+
+uint8_t UCS_getProfile(void)
+{
+    return currentProfile;
+}
+
+/***************************************************************************//**
+ * @brief  Register a driver to be notified of clock changes. Registering the
+ *         same callback again has no effect.
+ * @param  callback  Function recomputing the driver's clock dividers
+ * @return 1 if registered, 0 if the table is full
+ ******************************************************************************/
+
+uint8_t UCS_addClockCallback(UCS_clockCallback callback)
+{
+    uint8_t i;
+
+    for (i = 0; i < numClockCallbacks; i++)
+    {
+        if (clockCallbacks[i] == callback)
+            return 1;
+    }
+
+    if (numClockCallbacks == UCS_MAX_CALLBACKS)
+        return 0;
+
+    clockCallbacks[numClockCallbacks++] = callback;
+    return 1;
+}
+
+/***************************************************************************//**
+ * @brief  Get the smallest SMCLK divider that keeps a peripheral clock at or
+ *         below a limit, e.g. for USCI bit clock dividers (UCBRx)
+ * @param  maxFrequency  Highest allowed clock in Hz
+ * @return Divider, at least 1
+ ******************************************************************************/
+
+uint16_t UCS_getSmclkDivider(uint32_t maxFrequency)
+{
+    uint32_t divider = (UCS_getSmclkFrequency() + maxFrequency - 1) / maxFrequency;
+
+    if (divider == 0)
+        return 1;
+    if (divider > 0xFFFF)
+        return 0xFFFF;
+    return divider;
+}
+
+/***************************************************************************//**
+ * @brief  Get the frequency of the FLL reference after FLLREFDIV
+ * @param  none
+ * @return Reference frequency in Hz
+ ******************************************************************************/
+
+static uint32_t UCS_getFllReferenceFrequency(void)
+{
+    // FLLREFDIV encodes /1, /2, /4, /8, /12 and /16
+    static const uint8_t refDivider[] = { 1, 2, 4, 8, 12, 16, 16, 16 };
+    uint32_t reference;
+
+    // SELREF 5..7 all select XT2CLK on this device (when available)
+    if (((UCSCTL3 >> SELREF_SHIFT) & 0x07) >= SOURCE_XT2CLK)
+        reference = XT2_FREQUENCY;
+    else if (((UCSCTL3 >> SELREF_SHIFT) & 0x07) == SOURCE_REFOCLK)
+        reference = REFO_FREQUENCY;
+    else
+        reference = XT1_FREQUENCY;
+
+    return reference / refDivider[UCSCTL3 & FLLREFDIV_MASK];
+}
+
+/***************************************************************************//**
+ * @brief  Get the frequency of one of the UCS clock sources
+ * @param  source  SELx encoding of the source (0 = XT1CLK ... 5 = XT2CLK)
+ * @return Source frequency in Hz
+ ******************************************************************************/
+
+static uint32_t UCS_getSourceFrequency(uint8_t source)
+{
+    uint32_t dcoclkdiv;
+
+    switch (source)
+    {
+        case SOURCE_XT1CLK:
+            return XT1_FREQUENCY;
+
+        case SOURCE_VLOCLK:
+            return VLO_FREQUENCY;
+
+        case SOURCE_REFOCLK:
+            return REFO_FREQUENCY;
+
+        case SOURCE_XT2CLK:
+            return XT2_FREQUENCY;
+
+        default:
+            // f(DCOCLKDIV) = (FLLN + 1) * f(FLLREFCLK) / FLLREFDIV
+            dcoclkdiv = ((UCSCTL2 & FLLN_MASK) + 1) * UCS_getFllReferenceFrequency();
+
+            if (source == SOURCE_DCOCLK)
+            {
+                // f(DCOCLK) = FLLD * f(DCOCLKDIV)
+                return dcoclkdiv << ((UCSCTL2 >> FLLD_SHIFT) & 0x07);
+            }
+            return dcoclkdiv;
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Get the frequency of MCLK, SMCLK or ACLK from the live UCS settings
+ * @param  shift  Position of the clock's SELx/DIVx field (SELM/SELS/SELA_SHIFT)
+ * @return Clock frequency in Hz
+ ******************************************************************************/
+
+static uint32_t UCS_getClockFrequency(uint8_t shift)
+{
+    uint8_t source = (UCSCTL4 >> shift) & 0x07;
+    uint8_t divider = (UCSCTL5 >> shift) & 0x07;
+
+    // Encodings 6 and 7 select XT2CLK, or DCOCLKDIV when XT2 is not present
+    if (source > SOURCE_XT2CLK)
+        source = SOURCE_XT2CLK;
+
+    // DIVx encodes /1, /2, /4, /8, /16 and /32
+    if (divider > 5)
+        divider = 5;
+
+    return UCS_getSourceFrequency(source) >> divider;
+}
+
+/***************************************************************************//**
+ * @brief  Get the current MCLK frequency
+ * @param  none
+ * @return MCLK frequency in Hz
+ ******************************************************************************/
+
+uint32_t UCS_getMclkFrequency(void)
+{
+    return UCS_getClockFrequency(SELM_SHIFT);
+}
+
+/***************************************************************************//**
+ * @brief  Get the current SMCLK frequency
+ * @param  none
+ * @return SMCLK frequency in Hz
+ ******************************************************************************/
+
+uint32_t UCS_getSmclkFrequency(void)
+{
+    return UCS_getClockFrequency(SELS_SHIFT);
+}
+
+/***************************************************************************//**
+ * @brief  Get the current ACLK frequency
+ * @param  none
+ * @return ACLK frequency in Hz
+ ******************************************************************************/
+
+uint32_t UCS_getAclkFrequency(void)
+{
+    return UCS_getClockFrequency(SELA_SHIFT);
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
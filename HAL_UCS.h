@@ -0,0 +1,100 @@
+/*******************************************************************************
+ *
+ *  HAL_UCS.h
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef HAL_UCS_H
+#define HAL_UCS_H
+
+#include <stdint.h>
+
+// Crystal and internal oscillator frequencies of the experimenter's board
+#define XT1_FREQUENCY       32768UL    // LFXT1 watch crystal
+#define XT2_FREQUENCY       4000000UL  // XT2 crystal
+#define REFO_FREQUENCY      32768UL    // Internal trimmed reference
+#define VLO_FREQUENCY       10000UL    // Internal very-low-power oscillator (typical)
+
+// Select source for FLLREF    e.g. SELECT_FLLREF(SELREF__XT1CLK)
+#define SELECT_FLLREF(source)  do { UCSCTL3 = (UCSCTL3 & ~(SELREF_7)) | (source); } while (0)
+// Select source for ACLK      e.g. SELECT_ACLK(SELA__XT1CLK)
+#define SELECT_ACLK(source)    do { UCSCTL4 = (UCSCTL4 & ~(SELA_7)) | (source); } while (0)
+// Select source for MCLK      e.g. SELECT_MCLK(SELM__XT2CLK)
+#define SELECT_MCLK(source)    do { UCSCTL4 = (UCSCTL4 & ~(SELM_7)) | (source); } while (0)
+// Select source for SMCLK     e.g. SELECT_SMCLK(SELS__XT2CLK)
+#define SELECT_SMCLK(source)   do { UCSCTL4 = (UCSCTL4 & ~(SELS_7)) | (source); } while (0)
+
+#define UCS_MAX_FREQUENCY   25000000UL // MCLK limit at core voltage level 3
+
+// UCS_init() / UCS_setProfile() status
+#define UCS_STATUS_OK           0
+#define UCS_STATUS_ERR_XT1      1      // XT1 did not start, REFO used instead
+#define UCS_STATUS_ERR_RANGE    2      // Frequency not reachable
+#define UCS_STATUS_ERR_VCORE    3      // DVCC too low for the needed core voltage
+#define UCS_STATUS_ERR_DCO      4      // DCO at the end of its range (fault)
+
+// Clock configuration: MCLK runs from DCOCLKDIV, FLL-locked to the 32768 Hz
+// reference, SMCLK is derived from it
+typedef struct
+{
+    uint32_t mclkFrequency;            // Hz, up to UCS_MAX_FREQUENCY
+    uint16_t smclkDivider;             // DIVS__1 ... DIVS__32
+    uint16_t aclkSource;               // SELA__XT1CLK, SELA__REFOCLK or SELA__VLOCLK
+} UCS_Profile;
+
+// Performance profiles for UCS_selectProfile()
+#define UCS_PROFILE_BURST       0      // 25 MHz for display refreshes, SD transfers
+#define UCS_PROFILE_NORMAL      1      // 8 MHz
+#define UCS_PROFILE_IDLE        2      // 1 MHz
+#define UCS_NUM_PROFILES        3
+#define UCS_PROFILE_CUSTOM      0xFF   // Set with UCS_setProfile()
+
+#define UCS_MAX_CALLBACKS       8
+
+// Called in the caller's context after the clocks were changed, so drivers
+// can recompute dividers from the UCS_getXxxFrequency() queries
+typedef void (*UCS_clockCallback)(void);
+
+extern const UCS_Profile UCS_profiles[UCS_NUM_PROFILES];
+
+extern uint8_t UCS_init(void);
+extern uint8_t UCS_setProfile(const UCS_Profile *pProfile);
+extern uint8_t UCS_selectProfile(uint8_t profile);
+extern uint8_t UCS_getProfile(void);
+extern uint8_t UCS_addClockCallback(UCS_clockCallback callback);
+extern uint16_t UCS_getSmclkDivider(uint32_t maxFrequency);
+extern uint32_t UCS_getMclkFrequency(void);
+extern uint32_t UCS_getSmclkFrequency(void);
+extern uint32_t UCS_getAclkFrequency(void);
+
+#endif /* HAL_UCS_H */
@@ -40,6 +40,7 @@
  * @{
  ******************************************************************************/
 #include "msp430.h"
+#include "HAL_Adc.h"
 #include "HAL_Wheel.h"
 
 #define WHEEL_PORT_DIR P8DIR
@@ -48,11 +49,58 @@
 #define ADC_PORT_SEL  P6SEL
 #define ADC_INPUT_A5  BIT5
 
-uint16_t positionData;
+#define WHEEL_SAMPLE_RATE  ADC_TICK_RATE                // Averaged results per second
+#define WHEEL_SPEED_WINDOW 16                           // Samples per speed measurement
+#define WHEEL_NOISE_SHIFT  4                            // Noise estimate time constant (2^n)
+
+// Calibration record in information memory segment D
+#define WHEEL_CAL_ADDRESS  0x1800
+#define WHEEL_CAL_MAGIC    0x57CA
+
+typedef struct
+{
+    uint16_t magic;
+    uint16_t min;
+    uint16_t max;
+} WheelCalibration;
+
+volatile uint16_t positionData;
 uint16_t positionDataOld;
+uint16_t wheelHysteresis = 10;                          // Minimum fluctuation threshold in
+                                                        // ADC counts
+// Decoder configuration
+static uint8_t wheelDetents = WHEEL_DEFAULT_DETENTS;
+static uint16_t wheelMin = 0;                           // Calibrated ADC span
+static uint16_t wheelMax = 4095;
+static uint16_t detentWidth;                            // ADC counts per detent
+
+// Decoder state, updated by Wheel_update()
+static volatile uint8_t detent = 0;
+static volatile int16_t detentDelta = 0;                // Detents moved since last read
+static volatile uint16_t detentSpeed = 0;               // Detents per second
+static uint16_t noiseLevel = 0;                         // Sample-to-sample noise, x 2^NOISE_SHIFT
+static uint16_t activeHysteresis;
+static uint16_t lastValue = 0;
+static uint8_t windowSamples = 0;
+static uint8_t windowMoves = 0;
+static uint8_t primed = 0;                              // Detent set from first result
+
+// Calibration sweep
+static uint8_t calibrating = 0;
+static uint16_t calibrationMin, calibrationMax;
+
+// Forward declared functions
+static void Wheel_update(uint8_t channel, uint16_t value);
+static void Wheel_updateDetentWidth(void);
+static void Wheel_loadCalibration(void);
+static void Wheel_saveCalibration(void);
 
 /***************************************************************************//**
  * @brief   Set up the wheel
+ *
+ *          The wheel is sampled in the background by the ADC acquisition
+ *          engine; Wheel_update() receives each averaged result. A stored
+ *          calibration is loaded from information memory if present.
  * @param   None
  * @return  None
  ******************************************************************************/
@@ -61,65 +109,198 @@ void Wheel_init(void)
 {
     WHEEL_PORT_DIR |= WHEEL_ENABLE;
     WHEEL_PORT_OUT |= WHEEL_ENABLE;                    // Enable wheel
-
-    ADC12CTL0 = ADC12SHT02 + ADC12ON;                  // Sampling time, ADC12 on
-    ADC12CTL1 = ADC12SHP;                              // Use sampling timer
-    ADC12MCTL0 = ADC12INCH_5;                          // Use A5 (wheel) as input
-    ADC12CTL0 |= ADC12ENC;                             // Enable conversions
     ADC_PORT_SEL |= ADC_INPUT_A5;                      // P6.5 ADC option select (A5)
+
+    Wheel_loadCalibration();
+    Wheel_updateDetentWidth();
+
+    positionData = positionDataOld = 0;
+    primed = 0;
+    detentDelta = 0;
+    detentSpeed = 0;
+    Adc_init();
+    Adc_subscribe(ADC_CHANNEL_WHEEL, Wheel_update);
+    Adc_setRate(ADC_CHANNEL_WHEEL, WHEEL_SAMPLE_RATE);
 }
 
 /***************************************************************************//**
  * @brief   Determine the wheel's position
  * @param   None
- * @return  Wheel position (0~7)
+ * @return  Wheel position (0 ~ number of detents - 1)
  ******************************************************************************/
 
 uint8_t Wheel_getPosition(void)
 {
-    uint8_t position = 0;
-
-    Wheel_getValue();
-    //determine which position the wheel is in
-    if (positionData > 0x0806)
-        position = 7 - (positionData - 0x0806) / 260;  //scale the data for 8 different positions
-    else
-        position = positionData / 260;
-
-    return position;
+    return detent;
 }
 
 /***************************************************************************//**
- * @brief   Determine the raw voltage value across the potentiometer
+ * @brief   Get the filtered voltage value across the potentiometer
+ *
+ *          Returns the value published by the last wheel result;
+ *          does not start a conversion or wait.
  * @param   None
  * @return  Value
  ******************************************************************************/
 
 uint16_t Wheel_getValue(void)
 {
-    //measure ADC value
-    ADC12IE = 0x01;                                    // Enable interrupt
-    ADC12CTL0 |= ADC12SC;                              // Start sampling/conversion
-    __bis_SR_register(LPM0_bits + GIE);                // LPM0, ADC12_ISR will force exit
-    ADC12IE = 0x00;                                    // Disable interrupt
+    return positionData;
+}
 
-    //add hysteresis on wheel to remove fluctuations
-    if (positionData > positionDataOld)
-        if ((positionData - positionDataOld) > 10)
-            positionDataOld = positionData;            //use new data if change is beyond
-                                                       // fluctuation threshold
-        else
-            positionData = positionDataOld;            //use old data if change is not beyond
-                                                       // fluctuation threshold
-    else
-    if ((positionDataOld - positionData) > 10)
-        positionDataOld = positionData;                //use new data if change is beyond
-                                                       // fluctuation threshold
-    else
-        positionData = positionDataOld;                //use old data if change is not beyond
-                                                       // fluctuation threshold
+/***************************************************************************//**
+ * @brief   Get the number of detents moved since the last call
+ * @param   None
+ * @return  Signed detent count, positive when the value increases
+ ******************************************************************************/
 
-    return positionData;
+int16_t Wheel_getDelta(void)
+{
+    int16_t delta;
+    uint16_t gie = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+    delta = detentDelta;
+    detentDelta = 0;
+    __bis_SR_register(gie);
+
+    return delta;
+}
+
+/***************************************************************************//**
+ * @brief   Get the rotation speed
+ * @param   None
+ * @return  Detents per second, averaged over the last ~250 ms
+ ******************************************************************************/
+
+uint16_t Wheel_getSpeed(void)
+{
+    return detentSpeed;
+}
+
+/***************************************************************************//**
+ * @brief   Set the number of detents the calibrated span is divided into
+ * @param   detents  2 ~ WHEEL_MAX_DETENTS
+ * @return  None
+ ******************************************************************************/
+
+void Wheel_setDetents(uint8_t detents)
+{
+    uint16_t gie = __get_SR_register() & GIE;
+
+    if (detents < 2 || detents > WHEEL_MAX_DETENTS)
+        return;
+
+    __disable_interrupt();
+    wheelDetents = detents;
+    Wheel_updateDetentWidth();
+    primed = 0;
+    __bis_SR_register(gie);
+}
+
+/***************************************************************************//**
+ * @brief   Get the number of detents
+ * @param   None
+ * @return  Number of detents
+ ******************************************************************************/
+
+uint8_t Wheel_getDetents(void)
+{
+    return wheelDetents;
+}
+
+/***************************************************************************//**
+ * @brief   Set the ADC span of the wheel and store it in information memory
+ * @param   min  ADC value at one end stop
+ * @param   max  ADC value at the other end stop
+ * @return  1 if accepted, 0 if the span is too small for the detent count
+ ******************************************************************************/
+
+uint8_t Wheel_setCalibration(uint16_t min, uint16_t max)
+{
+    uint16_t gie = __get_SR_register() & GIE;
+
+    if (max > 4095 || max <= min || (max - min) < 4 * WHEEL_MAX_DETENTS)
+        return 0;
+
+    __disable_interrupt();
+    wheelMin = min;
+    wheelMax = max;
+    Wheel_updateDetentWidth();
+    primed = 0;
+    __bis_SR_register(gie);
+
+    Wheel_saveCalibration();
+    return 1;
+}
+
+/***************************************************************************//**
+ * @brief   Get the ADC span of the wheel
+ * @param   pMin  Place to store the lower end
+ * @param   pMax  Place to store the upper end
+ * @return  None
+ ******************************************************************************/
+
+void Wheel_getCalibration(uint16_t *pMin, uint16_t *pMax)
+{
+    *pMin = wheelMin;
+    *pMax = wheelMax;
+}
+
+/***************************************************************************//**
+ * @brief   Start a calibration sweep; turn the wheel to both end stops, then
+ *          call Wheel_calibrateEnd()
+ * @param   None
+ * @return  None
+ ******************************************************************************/
+
+void Wheel_calibrateStart(void)
+{
+    uint16_t gie = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+    calibrationMin = 0xFFFF;
+    calibrationMax = 0;
+    calibrating = 1;
+    __bis_SR_register(gie);
+}
+
+/***************************************************************************//**
+ * @brief   Finish a calibration sweep and apply the span that was seen
+ * @param   None
+ * @return  1 if the span was accepted, 0 otherwise
+ ******************************************************************************/
+
+uint8_t Wheel_calibrateEnd(void)
+{
+    calibrating = 0;
+
+    return Wheel_setCalibration(calibrationMin, calibrationMax);
+}
+
+/***************************************************************************//**
+ * @brief   Set the minimum hysteresis applied to the raw wheel value
+ *
+ *          The hysteresis in use grows above this floor with the measured
+ *          noise of the wheel reading.
+ * @param   counts  Minimum change in ADC counts before a new value is used
+ * @return  None
+ ******************************************************************************/
+
+void Wheel_setHysteresis(uint16_t counts)
+{
+    wheelHysteresis = counts;
+}
+
+/***************************************************************************//**
+ * @brief   Get the minimum hysteresis applied to the raw wheel value
+ * @param   None
+ * @return  Minimum change in ADC counts before a new value is used
+ ******************************************************************************/
+
+uint16_t Wheel_getHysteresis(void)
+{
+    return wheelHysteresis;
 }
 
 /***************************************************************************//**
@@ -131,8 +312,8 @@ uint16_t Wheel_getValue(void)
 void Wheel_disable(void)
 {
     WHEEL_PORT_OUT &= ~WHEEL_ENABLE;                   //disable wheel
-    ADC12CTL0 &= ~ADC12ENC;                            // Disable conversions
-    ADC12CTL0 &= ~ADC12ON;                             // ADC12 off
+    Adc_setRate(ADC_CHANNEL_WHEEL, 0);                 // Stop sampling
+    detentSpeed = 0;
 }
 
 /***************************************************************************//**
@@ -143,105 +324,149 @@ void Wheel_disable(void)
 
 void Wheel_enable(void)
 {
-    WHEEL_PORT_OUT |= WHEEL_ENABLE;                    //disable wheel
-    ADC12CTL0 |= ADC12ON;                              // ADC12 on
-    ADC12CTL0 |= ADC12ENC;                             // Enable conversions
+    WHEEL_PORT_OUT |= WHEEL_ENABLE;                    //enable wheel
+    Adc_setRate(ADC_CHANNEL_WHEEL, WHEEL_SAMPLE_RATE); // Resume sampling
 }
 
 /***************************************************************************//**
- * @brief Handles ADC interrupts.
+ * @brief   Recompute the detent width after a detent or span change
+ * @param   None
+ * @return  None
+ ******************************************************************************/
+
+static void Wheel_updateDetentWidth(void)
+{
+    detentWidth = (wheelMax - wheelMin + 1) / wheelDetents;
+}
+
+/***************************************************************************//**
+ * @brief   Decode a new wheel result
  *
- *        Stores result of single ADC conversion for reading position of the scroll wheel.
- * @param  none
- * @return none
+ *          Tracks the noise of the reading to adapt the hysteresis, moves the
+ *          detent only once the value is clearly past a detent boundary and
+ *          accumulates the detent delta and rotation speed.
+ * @param   channel  ADC_CHANNEL_WHEEL
+ * @param   value    Averaged ADC result
+ * @return  None
  ******************************************************************************/
 
-#pragma vector = ADC12_VECTOR
-__interrupt void ADC12_ISR(void)
+static void Wheel_update(uint8_t channel, uint16_t value)
 {
-    switch (__even_in_range(ADC12IV, ADC12IV_ADC12IFG15))
+    uint16_t change;
+    uint16_t center;
+    uint16_t offset;
+    uint8_t newDetent;
+
+    if (calibrating)
+    {
+        if (value < calibrationMin)
+            calibrationMin = value;
+        if (value > calibrationMax)
+            calibrationMax = value;
+    }
+
+    // Estimate noise from small sample-to-sample changes only, so turning
+    // the wheel does not inflate it
+    change = (value > lastValue) ? value - lastValue : lastValue - value;
+    lastValue = value;
+    if (change < (detentWidth >> 2))
+        noiseLevel += change - (noiseLevel >> WHEEL_NOISE_SHIFT);
+
+    // Twice the noise, but never below the floor or up to half a detent
+    activeHysteresis = noiseLevel >> (WHEEL_NOISE_SHIFT - 1);
+    if (activeHysteresis < wheelHysteresis)
+        activeHysteresis = wheelHysteresis;
+    if (activeHysteresis > (detentWidth >> 1) - 1)
+        activeHysteresis = (detentWidth >> 1) - 1;
+
+    //add hysteresis on wheel to remove fluctuations
+    if (value > positionDataOld)
+    {
+        if ((value - positionDataOld) > activeHysteresis)
+            positionDataOld = value;                   //use new data if change is beyond
+                                                       // fluctuation threshold
+    }
+    else if ((positionDataOld - value) > activeHysteresis)
+        positionDataOld = value;
+    positionData = positionDataOld;
+
+    // Leave the current detent only when past its edge by the hysteresis
+    if (value < wheelMin)
+        value = wheelMin;
+    if (value > wheelMax)
+        value = wheelMax;
+    offset = value - wheelMin;
+    if (!primed)
     {
-        // Vector  ADC12IV_NONE:  No interrupt
-        case  ADC12IV_NONE:
-            break;
-
-        // Vector  ADC12IV_ADC12OVIFG:  ADC overflow
-        case  ADC12IV_ADC12OVIFG:
-            break;
-
-        // Vector  ADC12IV_ADC12TOVIFG:  ADC timing overflow
-        case  ADC12IV_ADC12TOVIFG:
-            break;
-
-        // Vector  ADC12IV_ADC12IFG0: ADC12IFG0:
-        case  ADC12IV_ADC12IFG0:
-            positionData = ADC12MEM0;                  // ADC12MEM = A0 > 0.5AVcc?
-            __bic_SR_register_on_exit(LPM0_bits);      // Exit active CPU
-            break;
-
-        // Vector  ADC12IV_ADC12IFG1:  ADC12IFG1
-        case  ADC12IV_ADC12IFG1:
-            break;
-
-        // Vector ADC12IV_ADC12IFG2:  ADC12IFG2
-        case ADC12IV_ADC12IFG2:
-            break;
-
-        // Vector ADC12IV_ADC12IFG3:  ADC12IFG3
-        case ADC12IV_ADC12IFG3:
-            break;
-
-        // Vector ADC12IV_ADC12IFG4:  ADC12IFG4
-        case ADC12IV_ADC12IFG4:
-            break;
-
-        // Vector ADC12IV_ADC12IFG5:  ADC12IFG5
-        case ADC12IV_ADC12IFG5:
-            break;
-
-        // Vector ADC12IV_ADC12IFG6:  ADC12IFG6
-        case ADC12IV_ADC12IFG6:
-            break;
-
-        // Vector ADC12IV_ADC12IFG7:  ADC12IFG7
-        case ADC12IV_ADC12IFG7:
-            break;
-
-        // Vector ADC12IV_ADC12IFG8:  ADC12IFG8
-        case ADC12IV_ADC12IFG8:
-            break;
-
-        // Vector ADC12IV_ADC12IFG9:  ADC12IFG9
-        case ADC12IV_ADC12IFG9:
-            break;
-
-        // Vector ADC12IV_ADC12IFG10:  ADC12IFG10
-        case ADC12IV_ADC12IFG10:
-            break;
-
-        // Vector ADC12IV_ADC12IFG11:  ADC12IFG11
-        case ADC12IV_ADC12IFG11:
-            break;
-
-        // Vector ADC12IV_ADC12IFG12:  ADC12IFG12
-        case ADC12IV_ADC12IFG12:
-            break;
-
-        // Vector ADC12IV_ADC12IFG13:  ADC12IFG13
-        case ADC12IV_ADC12IFG13:
-            break;
-
-        // Vector ADC12IV_ADC12IFG14:  ADC12IFG14
-        case ADC12IV_ADC12IFG14:
-            break;
-
-        // Vector ADC12IV_ADC12IFG15:  ADC12IFG15
-        case ADC12IV_ADC12IFG15:
-            break;
-
-        default:
-            break;
+        // Start at the current detent without reporting a movement
+        detent = offset / detentWidth;
+        if (detent >= wheelDetents)
+            detent = wheelDetents - 1;
+        primed = 1;
     }
+    center = detent * detentWidth + (detentWidth >> 1);
+    change = (offset > center) ? offset - center : center - offset;
+    if (change > (detentWidth >> 1) + activeHysteresis)
+    {
+        newDetent = offset / detentWidth;
+        if (newDetent >= wheelDetents)
+            newDetent = wheelDetents - 1;
+
+        detentDelta += (int16_t)newDetent - detent;
+        windowMoves += (newDetent > detent) ? newDetent - detent : detent - newDetent;
+        detent = newDetent;
+    }
+
+    // Speed over a window of samples, smoothed over two windows
+    if (++windowSamples == WHEEL_SPEED_WINDOW)
+    {
+        detentSpeed = (detentSpeed + (uint16_t)windowMoves * WHEEL_SAMPLE_RATE /
+                       WHEEL_SPEED_WINDOW) >> 1;
+        windowSamples = 0;
+        windowMoves = 0;
+    }
+}
+
+/***************************************************************************//**
+ * @brief   Load the span from information memory, if a valid record exists
+ * @param   None
+ * @return  None
+ ******************************************************************************/
+
+static void Wheel_loadCalibration(void)
+{
+    const WheelCalibration *pCal = (const WheelCalibration *)WHEEL_CAL_ADDRESS;
+
+    if (pCal->magic == WHEEL_CAL_MAGIC && pCal->max <= 4095 &&
+        pCal->max > pCal->min && (pCal->max - pCal->min) >= 4 * WHEEL_MAX_DETENTS)
+    {
+        wheelMin = pCal->min;
+        wheelMax = pCal->max;
+    }
+}
+
+/***************************************************************************//**
+ * @brief   Erase information memory segment D and write the span to it
+ * @param   None
+ * @return  None
+ ******************************************************************************/
+
+static void Wheel_saveCalibration(void)
+{
+    uint16_t *pFlash = (uint16_t *)WHEEL_CAL_ADDRESS;
+    uint16_t gie = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+    FCTL3 = FWKEY;                                     // Unlock flash
+    FCTL1 = FWKEY + ERASE;                             // Segment erase
+    *pFlash = 0;                                       // Dummy write starts the erase
+    FCTL1 = FWKEY + WRT;                               // Word write
+    pFlash[0] = WHEEL_CAL_MAGIC;
+    pFlash[1] = wheelMin;
+    pFlash[2] = wheelMax;
+    FCTL1 = FWKEY;
+    FCTL3 = FWKEY + LOCK;                              // Lock flash
+    __bis_SR_register(gie);
 }
 
 /***************************************************************************//**
@@ -39,10 +39,23 @@
 
 #include <stdint.h>
 
+#define WHEEL_DEFAULT_DETENTS   8
+#define WHEEL_MAX_DETENTS       32
+
 extern void Wheel_init(void);
 extern uint8_t Wheel_getPosition(void);
 extern uint16_t Wheel_getValue(void);
 extern void Wheel_disable(void);
 extern void Wheel_enable(void);
+extern void Wheel_setHysteresis(uint16_t counts);
+extern uint16_t Wheel_getHysteresis(void);
+extern int16_t Wheel_getDelta(void);
+extern uint16_t Wheel_getSpeed(void);
+extern void Wheel_setDetents(uint8_t detents);
+extern uint8_t Wheel_getDetents(void);
+extern uint8_t Wheel_setCalibration(uint16_t min, uint16_t max);
+extern void Wheel_getCalibration(uint16_t *pMin, uint16_t *pMax);
+extern void Wheel_calibrateStart(void);
+extern uint8_t Wheel_calibrateEnd(void);
 
 #endif /* HAL_WHEEL_H */
@@ -0,0 +1,185 @@
+/*******************************************************************************
+ *
+ *  HAL_Work.c - Deferred work queue from interrupt to main-loop context
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       HAL_Work.c
+ * @addtogroup HAL_Work
+ * @{
+ ******************************************************************************/
+#include "msp430.h"
+#include "HAL_EventLatency.h"
+#include "HAL_Timer.h"
+#include "HAL_Work.h"
+
+#define WORK_MASK           (WORK_QUEUE_SIZE - 1)
+
+#if (WORK_QUEUE_SIZE & WORK_MASK)
+#error WORK_QUEUE_SIZE must be a power of two
+#endif
+
+typedef struct
+{
+    Work_handler handler;
+    uint16_t arg;
+#if EVENTLATENCY_ENABLED
+    uint32_t stamp;                    // Timer_now() of the event behind it
+#endif
+} WorkItem;
+
+volatile uint16_t Work_overflows = 0;
+
+static WorkItem queue[WORK_QUEUE_SIZE];
+static volatile uint16_t head = 0;     // Written by producers only
+static volatile uint16_t tail = 0;     // Written by the dispatcher only
+static uint32_t currentStamp;          // Stamp of the item being dispatched
+
+/***************************************************************************//**
+ * @brief  Queue a handler to run from the main loop.
+ *
+ *         Takes constant time and may be called from ISRs. An ISR that posts
+ *         work must also wake the CPU, e.g. __bic_SR_register_on_exit(LPM3_bits),
+ *         so the main loop gets to dispatch it.
+ * @param  handler  Function to run
+ * @param  arg      Argument passed to handler
+ * @return 1 if queued, 0 if the queue was full (counted in Work_overflows)
+ ******************************************************************************/
+
+uint8_t Work_post(Work_handler handler, uint16_t arg)
+{
+#if EVENTLATENCY_ENABLED
+    return Work_postStamped(handler, arg, Timer_now());
+#else
+    return Work_postStamped(handler, arg, 0);
+#endif
+}
+
+/***************************************************************************//**
+ * @brief  Queue a handler together with the time of the event it handles.
+ *
+ *         Like Work_post(); the handler gets the stamp from Work_getStamp().
+ *         The stamp is dropped if EVENTLATENCY_ENABLED is 0.
+ * @param  handler  Function to run
+ * @param  arg      Argument passed to handler
+ * @param  stamp    Timer_now() when the event happened
+ * @return 1 if queued, 0 if the queue was full (counted in Work_overflows)
+ ******************************************************************************/
+
+uint8_t Work_postStamped(Work_handler handler, uint16_t arg, uint32_t stamp)
+{
+    uint16_t gie = __get_SR_register() & GIE;
+    uint8_t queued = 0;
+
+    // Not lock-free: the MSP430 has no compare-and-swap, and the main loop
+    // (scheduler tasks) posts too, so an ISR can post between reading head
+    // and publishing the new value. ISRs do not nest, so this is the only
+    // race; the window is a few instructions and GIE is already clear when
+    // an ISR posts. The consumer side needs no lock.
+    __disable_interrupt();
+    if ((uint16_t)(head - tail) < WORK_QUEUE_SIZE)
+    {
+        queue[head & WORK_MASK].handler = handler;
+        queue[head & WORK_MASK].arg = arg;
+#if EVENTLATENCY_ENABLED
+        queue[head & WORK_MASK].stamp = stamp;
+#endif
+        head++;
+        queued = 1;
+    }
+    else
+    {
+        Work_overflows++;
+    }
+    __bis_SR_register(gie);
+
+    return queued;
+}
+
+/***************************************************************************//**
+ * @brief  Get the number of queued work items
+ * @param  none
+ * @return Number of items waiting
+ ******************************************************************************/
+
+uint16_t Work_pending(void)
+{
+    return head - tail;
+}
+
+/***************************************************************************//**
+ * @brief  Run all queued work items in the order they were posted.
+ *
+ *         Items posted while dispatching are run as well. Call from the main
+ *         loop only.
+ * @param  none
+ * @return Number of items run
+ ******************************************************************************/
+
+uint16_t Work_dispatch(void)
+{
+    uint16_t count = 0;
+    WorkItem item;
+
+    while (tail != head)
+    {
+        item = queue[tail & WORK_MASK];
+        tail++;                        // Frees the slot for producers
+#if EVENTLATENCY_ENABLED
+        currentStamp = item.stamp;
+#endif
+        item.handler(item.arg);
+        count++;
+    }
+
+    return count;
+}
+
+/***************************************************************************//**
+ * @brief  Get the stamp of the work item being run
+ *
+ *         Call from a work handler. Items queued with Work_post() carry the
+ *         time they were posted.
+ * @param  none
+ * @return Timer_now() of the event, 0 if EVENTLATENCY_ENABLED is 0
+ ******************************************************************************/
+
+uint32_t Work_getStamp(void)
+{
+    return currentStamp;
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
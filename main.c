@@ -1,101 +1,97 @@
 #include <msp430.h>
 #include "font.h"
+#include "HAL_AppUart.h"
+#include "HAL_Buttons.h"
+#include "HAL_BusTrace.h"
+#include "HAL_Cycles.h"
+#include "HAL_Energy.h"
+#include "HAL_EventLatency.h"
+#include "HAL_Latency.h"
+#include "HAL_Profile.h"
+#include "HAL_Scheduler.h"
+#include "HAL_Shell.h"
+#include "HAL_Stack.h"
+#include "HAL_Timer.h"
+#include "HAL_UCS.h"
 
 #define TAxCCR_05Hz 0xffff /* timer upper bound count value */
-#define BUTTON_DELAY 0x0300
+#define LCD_SPI_FREQUENCY 12500000UL /* highest LCD SPI clock */
 
 int current_number = 3184;
 int current_adder = -591;
 
-unsigned short int button_halt = 0;
 unsigned short int screen_state = 0;
 
-unsigned int glitch_counters[] = { 0, 0 };
+unsigned char shell_task;
 
 void writeCommand(unsigned char *sCmd, unsigned char i);
 void writeData(unsigned char *sData, unsigned char i);
 void setPosition(unsigned char page, unsigned char col);
 void printNumber(int num);
 void printSymbol(int index, unsigned char page, unsigned int col);
+void handleButton(uint16_t event);
+void shellReceived(void);
+void setLcdDivider(void);
+void lcdClockChanged(void);
 
 #define SET_INVERSE_DISPLAY		0xA6
-#pragma vector = PORT1_VECTOR
-__interrupt void S1_handler(void){
-	if(P1IFG & BIT7){
-//		if (~button_halt & BIT7){
-		if (glitch_counters[0] == 0){
-			if(P1IES & BIT7){
-				current_number += current_adder;
-				printNumber(current_number);
-
-//				TA2CCR1 = TA2R + BUTTON_DELAY;
-//				TA2CCTL1 = (TA2CCTL1 & (~0x010)) | CCIE;
-//				button_halt |= BIT7;
-			}
-			P1IES ^= BIT7;
-		}
 
-		++glitch_counters[0];
-		TA2CCR1 = TA2R + BUTTON_DELAY;
-		TA2CCTL1 = (TA2CCTL1 & (~0x010)) | CCIE;
+// Runs from the main loop via the deferred work queue, never in an ISR
+void handleButton(uint16_t event){
+	if (BUTTON_EVENT_TYPE(event) != BUTTON_EVENT_PRESS)
+		return;
 
-		P1IFG &= ~BIT7;
-	}
-}
+	if (BUTTON_EVENT_BUTTON(event) == BUTTON_S1){
+		current_number += current_adder;
+		printNumber(current_number);
+	} else if (BUTTON_EVENT_BUTTON(event) == BUTTON_S2){
+		unsigned char cmd[1] = {SET_INVERSE_DISPLAY};
+		cmd[0] = (cmd[0] & (~0x01)) | (screen_state & 0x01);
+		writeCommand(cmd, 1);
 
-#pragma vector = PORT2_VECTOR
-__interrupt void S2_handler(void){
-	if(P2IFG & BIT2){
-//		if(~button_halt & BIT2){
-		if(glitch_counters[1] == 0){
-
-			if(P2IES & BIT2){
-				unsigned char cmd[1] = {SET_INVERSE_DISPLAY};
-				cmd[0] = (cmd[0] & (~0x01)) | (screen_state & 0x01);
-				writeCommand(cmd, 1);
+		screen_state ^= BIT0;
+	} else {
+		return;
+	}
 
-				screen_state ^= BIT0;
+	// The LCD writes above are complete: the press is on the screen
+	EventLatency_record(EVENTLATENCY_BUTTON, Work_getStamp());
+}
 
-//				TA2CCR2 = TA2R + BUTTON_DELAY;
-//				TA2CCTL2 = (TA2CCTL2 & (~0x010)) | CCIE;
-//				button_halt |= BIT2;
-			}
-			P2IES ^= BIT2;
-		}
+// Called from the USCI_A1 ISR for every received character
+void shellReceived(void){
+	Scheduler_signal(shell_task);
+}
 
-		++glitch_counters[1];
-		TA2CCR2 = TA2R + BUTTON_DELAY;
-		TA2CCTL2 = (TA2CCTL2 & (~0x010)) | CCIE;
+// Program the UCB1 divider for the LCD; the state machine must be in reset
+void setLcdDivider(void){
+	unsigned int divider = UCS_getSmclkDivider(LCD_SPI_FREQUENCY);
 
-		P2IFG &= ~BIT2;
-	}
+	UCB1BR0 = divider & 0xFF;
+	UCB1BR1 = divider >> 8;
 }
 
-#pragma vector = TIMER2_A1_VECTOR
-__interrupt void TA2_handler(void){
-	switch(TA2IV){
-		case TA2IV_TACCR1:
-			// S1
-//			button_halt &= ~BIT7;
-			glitch_counters[0] = 0;
-			TA2CCTL1 = (TA2CCTL1 & (~0x010)) | (~CCIE & (0x010)); // & ~CCIE;
-			break;
-		case TA2IV_TACCR2:
-			// S2
-//			button_halt &= ~BIT2;
-			glitch_counters[1] = 0;
-			TA2CCTL2 = (TA2CCTL2 & (~0x010)) | (~CCIE & (0x010)); // & ~CCIE;
-			break;
-		default:
-			break;
-	}
+// Called by HAL_UCS after a clock profile change. UCB1 is shared with the
+// SD card, which runs it with UCCKPL set: leave the bus alone then.
+void lcdClockChanged(void){
+	if ((UCB1CTL1 & UCSWRST) || (UCB1CTL0 & UCCKPL))
+		return;
+
+	// Let the current byte finish
+	while (UCB1STAT & UCBUSY) ;
+	UCB1CTL1 |= UCSWRST;
+	setLcdDivider();
+	UCB1CTL1 &= ~UCSWRST;
+	UCB1IFG &= ~UCRXIFG;
 }
 
 void writeCommand(unsigned char *sCmd, unsigned char i) {
     // Store current GIE state
     unsigned int gie = __get_SR_register() & GIE;
+    BUSTRACE_DECLARE(trace);
     // Make this operation atomic
     __disable_interrupt();
+    BUSTRACE_BEGIN(trace, BUSTRACE_LCD, BUSTRACE_TX, i);
     // CS Low
     P7OUT &= ~BIT4;
     // CD Low
@@ -117,6 +113,7 @@ void writeCommand(unsigned char *sCmd, unsigned char i) {
     UCB1RXBUF;
     // CS High
     P7OUT |= BIT4;
+    BUSTRACE_END(trace);
     // Restore original GIE state
     __bis_SR_register(gie);
 }
@@ -124,8 +121,10 @@ void writeCommand(unsigned char *sCmd, unsigned char i) {
 void writeData(unsigned char *sData, unsigned char i) {
     // Store current GIE state
     unsigned int gie = __get_SR_register() & GIE;
+    BUSTRACE_DECLARE(trace);
     // Make this operation atomic
     __disable_interrupt();
+    BUSTRACE_BEGIN(trace, BUSTRACE_LCD, BUSTRACE_TX, i);
       // CS Low
       P7OUT &= ~BIT4;
       //CD High
@@ -146,6 +145,7 @@ void writeData(unsigned char *sData, unsigned char i) {
       UCB1RXBUF;
       // CS High
       P7OUT |= BIT4;
+      BUSTRACE_END(trace);
 
     // Restore original GIE state
     __bis_SR_register(gie);
@@ -197,44 +197,26 @@ void printSymbol(int index, unsigned char page, unsigned int col){
 
 int main(void) {
     WDTCTL = WDTPW | WDTHOLD;	// Stop watchdog timer
+    Stack_init();		// Paint the unused stack for the high-water mark
     __bis_SR_register(GIE);
 
-	P1SEL &= ~BIT7;
-	P1DIR &= ~BIT7;
-	P1OUT |= BIT7;
-	P1REN |= BIT7;
-	P1IES |= BIT7;
-	P1IFG &= ~BIT7;
-	P1IE |= BIT7;
-
-	P2SEL &= ~BIT2;
-	P2DIR &= ~BIT2;
-	P2OUT |= BIT2;
-	P2REN |= BIT2;
-	P2IES |= BIT2;
-	P2IFG &= ~BIT2;
-	P2IE |= BIT2;
-
-	UCSCTL3 = (UCSCTL3 & (~0x070)) | SELREF__XT1CLK;
-	UCSCTL3 = (UCSCTL3 & (~0x07)) | FLLREFDIV__2;
-	UCSCTL2 = (UCSCTL2 & (~0x0cff)) | ((8 - 1) & (0x0cff)); // FLLN multiplier
-	UCSCTL2 = (UCSCTL2 & (~0x07000)) | FLLD__8; // FLLD divider
-	UCSCTL1 = (UCSCTL1 & (~0x070)) | DCORSEL_1;
-
-	UCSCTL4 = (UCSCTL4 & (~0x070)) | SELS__DCOCLKDIV;
-	UCSCTL5 = (UCSCTL5 & (~0x070)) | DIVS__1;
-
-	TA2CTL = (TA2CTL & (~0x0300)) | TASSEL__SMCLK;
-	TA2CTL = (TA2CTL & (~0x030)) | MC__CONTINOUS;
-	TA2CTL = (TA2CTL & (~0x0c0)) | ID__4;
-	TA2CTL |= TACLR;
-	TA2CCTL1 = (TA2CCTL1 & (~0x0100)) & ~CAP;
-	TA2CCTL2 = (TA2CCTL2 & (~0x0100)) & ~CAP;
-	TA2CCTL1 = (TA2CCTL1 & (~0x010)) & ~CCIE;
-	TA2CCTL2 = (TA2CCTL2 & (~0x010)) & ~CCIE;
+	// XT1 for ACLK, then MCLK = SMCLK = 25 MHz with VCore raised to match.
+	// Drivers derive their dividers from the resulting frequencies.
+	UCS_init();
+	UCS_selectProfile(UCS_PROFILE_BURST);
+
+	// TA2 free-running from ACLK, shared by the button service and scheduler
+	Timer_init();
 
+	// S1 and S2, debounced on a TA2 software timer
+	PADIR &= ~BUTTON_ALL;
+	Buttons_init(BUTTON_ALL);
+	Buttons_setEventHandler(handleButton);
+	Buttons_interruptEnable(BUTTON_ALL);
+
+	// The LCD SPI is polled; no USCI_B1 interrupts
 	UCB1IFG = (UCB1IFG & (~0x03)) | ((~UCTXIFG & (0x02)) | (~UCRXIFG & (0x01)));
-	UCB1IE = (UCB1IE & (~0x03)) | UCTXIE | UCRXIE;
+	UCB1IE &= ~(UCTXIE | UCRXIE);
 
 
 	// LCD and UART initialization
@@ -272,11 +254,11 @@ int main(void) {
 	// MSB
 	// Use SMCLK, keep RESET
 	UCB1CTL1 = UCSSEL_2 + UCSWRST;
-	UCB1BR0 = 0x02;
-	UCB1BR1 = 0;
+	setLcdDivider();
 	// Release USCI state machine
 	UCB1CTL1 &= ~UCSWRST;
 	UCB1IFG &= ~UCRXIFG;
+	UCS_addClockCallback(lcdClockChanged);
 
 
 #define SET_SCROLL_LINE		0x40
@@ -335,5 +317,18 @@ int main(void) {
 
 	cmd[3] = (cmd[3] & (~0x01)) | (~BIT0 & (0x01));
 	writeCommand(cmd + 3, 1);
+
+	// Command shell on the application UART, run when characters arrive
+	Cycles_init();
+	Profile_init();
+	Latency_init();
+	Energy_init();
+	AppUart_init();
+	Shell_init();
+	shell_task = Scheduler_addTask(Shell_process, 0);
+	AppUart_setRxCallback(shellReceived);
+
+	// Button events and tasks run from here; sleeps when idle
+	Scheduler_run();
 	return 0;
 }
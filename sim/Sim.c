@@ -0,0 +1,1247 @@
+/*******************************************************************************
+ *
+ *  Sim.c - Register-level MSP430F5529 peripheral model for host builds
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       Sim.c
+ * @addtogroup Sim
+ * @{
+ *
+ * Register-level model of the parts of the MSP430F5529 the HAL drives:
+ * UCS clocks, Timer_A/B counters, USCI SPI/UART shift engines, digital I/O
+ * with P1/P2 edge interrupts, PMM status and a single-shot ADC12 stub.
+ *
+ * Time advances only through register accesses and intrinsics, each
+ * charged in MCLK cycles at the clock the UCS registers select. Entering an
+ * LPM skips ahead to the next enabled timer, USCI or port event. ISRs of
+ * the HAL modules linked into the build are called when their flags are
+ * pending and GIE is set; DMA is not modeled.
+ ******************************************************************************/
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "msp430.h"
+#include "Sim.h"
+#include "SimModels.h"
+
+#define PS_PER_SECOND       1000000000000ULL
+#define XT1_FREQUENCY       32768UL
+#define REFO_FREQUENCY      32768UL
+#define VLO_FREQUENCY       10000UL
+#define XT2_FREQUENCY       4000000UL
+
+#define TIMER_NUM           4
+#define MAX_ISR_NESTING     4
+#define UART_BUFFER_SIZE    4096
+#define DELAY_CHUNK_CYCLES  1000       // __delay_cycles() granularity
+#define NO_DEVICE           0xFF
+
+// Board wiring
+#define LCD_CS_PORT         7
+#define LCD_CS              BIT4
+#define LCD_CD_PORT         5
+#define LCD_CD              BIT6
+#define LCD_RST             BIT7
+#define SD_CS_PORT          3
+#define SD_CS               BIT7
+#define ACCEL_PORT          3
+#define ACCEL_CS            BIT5
+#define ACCEL_PWR           BIT6
+#define ACCEL_INT_PORT      2
+#define ACCEL_INT           BIT5
+
+typedef void (*Sim_isr)(void);
+
+typedef struct
+{
+    uint8_t shifting;                  // A byte is in the shift register
+    uint8_t buffered;                  // TXBUF holds the next byte
+    uint8_t txByte;
+    uint8_t rxByte;                    // Shifted in with the current byte
+    uint8_t device;                    // SIM_DEVICE_xxx or NO_DEVICE
+    uint8_t inReset;                   // Last seen UCSWRST
+    uint64_t donePs;                   // End of the current byte
+} UsciEngine;
+
+// ISRs of the HAL modules, the ones not linked in stay masked
+extern void Cycles_ISR(void) __attribute__((weak));
+extern void Port1_ISR(void) __attribute__((weak));
+extern void AppUart_ISR(void) __attribute__((weak));
+extern void Timer_compare_ISR(void) __attribute__((weak));
+extern void Timer_overflow_ISR(void) __attribute__((weak));
+extern void Port2_ISR(void) __attribute__((weak));
+
+SimRegisters simRegs;
+
+static const uint8_t timerCcrs[TIMER_NUM] = { 5, 3, 3, 7 };
+static const uint8_t refDividers[8] = { 1, 2, 4, 8, 12, 16, 16, 16 };
+static const uint8_t deviceModes[SIM_DEVICE_NUM] = {
+    UCCKPH + UCMSB,                    // SIM_DEVICE_LCD
+    UCCKPL + UCMSB,                    // SIM_DEVICE_SD
+    UCCKPH + UCMSB                     // SIM_DEVICE_ACCEL
+};
+
+static uint16_t sr;
+static uint16_t srStack[MAX_ISR_NESTING];
+static uint8_t isrDepth;
+static void *pPendingWrite;
+static uint64_t nowPs;
+static uint64_t timerAccum[TIMER_NUM];  // Partial tick, in ps x Hz
+static UsciEngine usci[SIM_USCI_NUM];
+static uint8_t selected[SIM_DEVICE_NUM];
+static uint8_t accelPowered;
+static uint8_t lcdInReset;
+static uint8_t inputs[9];
+static uint16_t adcInputs[16];
+
+static uint8_t uartOut[UART_BUFFER_SIZE];
+static uint16_t uartOutCount;
+static uint8_t uartIn[UART_BUFFER_SIZE];
+static uint16_t uartInHead, uartInCount;
+static uint64_t uartRxPs;
+
+static SimStats stats;
+static uint64_t statsStartPs;
+static uint64_t sleepPs;
+
+// Forward declared functions
+static uint32_t Sim_sourceFrequency(uint8_t source);
+static uint32_t Sim_clockFrequency(uint8_t shift);
+static uint64_t Sim_cyclesToPs(uint64_t cycles);
+static void Sim_charge(uint32_t cycles);
+static void Sim_advance(uint64_t ps);
+static uint32_t Sim_timerClock(uint8_t timer, uint32_t *pDivider);
+static void Sim_timerAdvance(uint8_t timer, uint64_t ps);
+static uint64_t Sim_timerNextPs(uint8_t timer);
+static uint16_t Sim_timerVector(uint8_t timer, uint8_t clear);
+static uint64_t Sim_usciByteTime(uint8_t module);
+static void Sim_usciStart(uint8_t module, uint64_t startPs);
+static uint8_t Sim_spiExchange(uint8_t module, uint8_t byte);
+static void Sim_usciUpdate(void);
+static void Sim_syncPins(void);
+static uint64_t Sim_nextEventPs(void);
+static Sim_isr Sim_nextIsr(void);
+static void Sim_dispatch(void);
+static void Sim_flush(void);
+static void Sim_readHook(void *pRegister);
+static void Sim_adcConvert(void);
+
+
+/***************************************************************************//**
+ * @brief  Frequency of a UCS clock source.
+ * @param  source  SELx field value, SELM__XT1CLK to SELM__XT2CLK
+ * @return Frequency in Hz
+ ******************************************************************************/
+
+static uint32_t Sim_sourceFrequency(uint8_t source)
+{
+    uint16_t ctl2 = simRegs.UCSCTL[2];
+    uint16_t ctl3 = simRegs.UCSCTL[3];
+    uint32_t reference, dcoclkdiv;
+
+    switch (source)
+    {
+        case 0:
+            return XT1_FREQUENCY;
+
+        case 1:
+            return VLO_FREQUENCY;
+
+        case 2:
+            return REFO_FREQUENCY;
+
+        case 3:
+        case 4:
+            switch (ctl3 & SELREF_7)
+            {
+                case SELREF__REFOCLK:
+                    reference = REFO_FREQUENCY;
+                    break;
+
+                case SELREF__XT2CLK:
+                    reference = XT2_FREQUENCY;
+                    break;
+
+                default:
+                    reference = XT1_FREQUENCY;
+                    break;
+            }
+            reference /= refDividers[ctl3 & 0x07];
+            dcoclkdiv = ((ctl2 & 0x03FF) + 1) * reference;
+            if (source == 4)
+                return dcoclkdiv;
+            return dcoclkdiv << ((ctl2 >> 12) & 0x07);
+
+        default:
+            return XT2_FREQUENCY;
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Frequency of MCLK, SMCLK or ACLK after its divider.
+ * @param  shift  0 for MCLK, 4 for SMCLK, 8 for ACLK
+ * @return Frequency in Hz
+ ******************************************************************************/
+
+static uint32_t Sim_clockFrequency(uint8_t shift)
+{
+    uint8_t source = (simRegs.UCSCTL[4] >> shift) & 0x07;
+    uint8_t divider = (simRegs.UCSCTL[5] >> shift) & 0x07;
+
+    return Sim_sourceFrequency(source) >> divider;
+}
+
+/***************************************************************************//**
+ * @brief  Convert MCLK cycles to simulated time.
+ * @param  cycles  MCLK cycles
+ * @return Picoseconds
+ ******************************************************************************/
+
+static uint64_t Sim_cyclesToPs(uint64_t cycles)
+{
+    return (unsigned __int128)cycles * PS_PER_SECOND / Sim_clockFrequency(0);
+}
+
+/***************************************************************************//**
+ * @brief  Let the CPU execute for a number of MCLK cycles.
+ * @param  cycles  MCLK cycles
+ * @return none
+ ******************************************************************************/
+
+static void Sim_charge(uint32_t cycles)
+{
+    stats.cycles += cycles;
+    Sim_advance(Sim_cyclesToPs(cycles));
+}
+
+/***************************************************************************//**
+ * @brief  Advance simulated time and update all peripherals. Does not
+ *         dispatch interrupts.
+ * @param  ps  Time step in picoseconds
+ * @return none
+ ******************************************************************************/
+
+static void Sim_advance(uint64_t ps)
+{
+    uint8_t timer;
+
+    for (timer = 0; timer < TIMER_NUM; timer++)
+        Sim_timerAdvance(timer, ps);
+
+    nowPs += ps;
+    Sim_usciUpdate();
+    Sim_syncPins();
+}
+
+/***************************************************************************//**
+ * @brief  Input clock of a timer, taking gating by the LPM bits into
+ *         account.
+ * @param  timer     Index into simRegs.T[]
+ * @param  pDivider  Receives the ID x IDEX input divider
+ * @return Source clock in Hz, 0 if the timer does not count
+ ******************************************************************************/
+
+static uint32_t Sim_timerClock(uint8_t timer, uint32_t *pDivider)
+{
+    SimTimerRegs *pRegs = &simRegs.T[timer];
+
+    *pDivider = (1 << ((pRegs->CTL >> 6) & 0x03)) * ((pRegs->EX0 & TAIDEX_7) + 1);
+
+    if (!(pRegs->CTL & MC_3))
+        return 0;
+
+    switch (pRegs->CTL & TASSEL_3)
+    {
+        case TASSEL__ACLK:
+            return (sr & OSCOFF) ? 0 : Sim_clockFrequency(8);
+
+        case TASSEL__SMCLK:
+            return (sr & SCG1) ? 0 : Sim_clockFrequency(4);
+
+        default:
+            return 0;                  // No external clocks are modeled
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Count a timer forward, setting the compare and overflow flags it
+ *         passes. Up/down mode is counted like up mode.
+ * @param  timer  Index into simRegs.T[]
+ * @param  ps     Time step in picoseconds
+ * @return none
+ ******************************************************************************/
+
+static void Sim_timerAdvance(uint8_t timer, uint64_t ps)
+{
+    SimTimerRegs *pRegs = &simRegs.T[timer];
+    uint32_t divider, period, distance, old;
+    uint32_t clock = Sim_timerClock(timer, &divider);
+    uint64_t unit = PS_PER_SECOND * divider;
+    unsigned __int128 total;
+    uint64_t ticks;
+    uint8_t i;
+
+    if (!clock)
+        return;
+
+    total = (unsigned __int128)ps * clock + timerAccum[timer];
+    ticks = total / unit;
+    timerAccum[timer] = total % unit;
+    if (!ticks)
+        return;
+
+    period = ((pRegs->CTL & MC_3) == MC__CONTINUOUS) ? 0x10000UL : pRegs->CCR[0] + 1UL;
+    old = pRegs->R % period;
+
+    for (i = 0; i < timerCcrs[timer]; i++)
+    {
+        if ((pRegs->CCTL[i] & CAP) || pRegs->CCR[i] >= period)
+            continue;
+
+        distance = (pRegs->CCR[i] + period - old) % period;
+        if (distance == 0)
+            distance = period;
+        if (distance <= ticks)
+            pRegs->CCTL[i] |= CCIFG;
+    }
+
+    if (period - old <= ticks)
+        pRegs->CTL |= TAIFG;
+
+    pRegs->R = (old + ticks) % period;
+}
+
+/***************************************************************************//**
+ * @brief  Time of the next enabled interrupt flag a timer will set.
+ * @param  timer  Index into simRegs.T[]
+ * @return Absolute time in picoseconds, SIM_NEVER if none
+ ******************************************************************************/
+
+static uint64_t Sim_timerNextPs(uint8_t timer)
+{
+    SimTimerRegs *pRegs = &simRegs.T[timer];
+    uint32_t divider, period, distance, old;
+    uint32_t clock = Sim_timerClock(timer, &divider);
+    uint32_t ticks = 0xFFFFFFFFUL;
+    unsigned __int128 needed;
+    uint8_t i;
+
+    if (!clock)
+        return SIM_NEVER;
+
+    period = ((pRegs->CTL & MC_3) == MC__CONTINUOUS) ? 0x10000UL : pRegs->CCR[0] + 1UL;
+    old = pRegs->R % period;
+
+    for (i = 0; i < timerCcrs[timer]; i++)
+    {
+        if ((pRegs->CCTL[i] & (CAP + CCIE + CCIFG)) != CCIE || pRegs->CCR[i] >= period)
+            continue;
+
+        distance = (pRegs->CCR[i] + period - old) % period;
+        if (distance == 0)
+            distance = period;
+        if (distance < ticks)
+            ticks = distance;
+    }
+
+    if ((pRegs->CTL & (TAIE + TAIFG)) == TAIE && period - old < ticks)
+        ticks = period - old;
+
+    if (ticks == 0xFFFFFFFFUL)
+        return SIM_NEVER;
+
+    needed = (unsigned __int128)ticks * PS_PER_SECOND * divider - timerAccum[timer];
+    return nowPs + (uint64_t)((needed + clock - 1) / clock);
+}
+
+/***************************************************************************//**
+ * @brief  Interrupt vector of a timer's CCR1+ and overflow flags, as read
+ *         from TAxIV.
+ * @param  timer  Index into simRegs.T[]
+ * @param  clear  Clear the flag reported, as a TAxIV read does
+ * @return TAxIV value, 0 if nothing enabled is pending
+ ******************************************************************************/
+
+static uint16_t Sim_timerVector(uint8_t timer, uint8_t clear)
+{
+    SimTimerRegs *pRegs = &simRegs.T[timer];
+    uint8_t i;
+
+    for (i = 1; i < timerCcrs[timer]; i++)
+    {
+        if ((pRegs->CCTL[i] & (CCIE + CCIFG)) == CCIE + CCIFG)
+        {
+            if (clear)
+                pRegs->CCTL[i] &= ~CCIFG;
+            return i * 2;
+        }
+    }
+
+    if ((pRegs->CTL & (TAIE + TAIFG)) == TAIE + TAIFG)
+    {
+        if (clear)
+            pRegs->CTL &= ~TAIFG;
+        return TA1IV_TAIFG;
+    }
+
+    return 0;
+}
+
+/***************************************************************************//**
+ * @brief  Duration of one character on a USCI module.
+ * @param  module  SIM_USCI_xxx
+ * @return Picoseconds, SIM_NEVER if the module has no running clock
+ ******************************************************************************/
+
+static uint64_t Sim_usciByteTime(uint8_t module)
+{
+    SimUsciRegs *pRegs = &simRegs.U[module];
+    uint32_t prescaler = pRegs->BR0 | (pRegs->BR1 << 8);
+    uint32_t clock, clocks;
+    uint8_t bits = (pRegs->CTL0 & UC7BIT) ? 7 : 8;
+
+    switch (pRegs->CTL1 & UCSSEL_3)
+    {
+        case UCSSEL__ACLK:
+            clock = Sim_clockFrequency(8);
+            break;
+
+        case UCSSEL_0:
+            return SIM_NEVER;          // External UCLK is not modeled
+
+        default:
+            clock = Sim_clockFrequency(4);
+            break;
+    }
+
+    if (!prescaler)
+        prescaler = 1;
+
+    if (pRegs->CTL0 & UCSYNC)
+    {
+        clocks = bits * prescaler;
+    }
+    else
+    {
+        // Start, data, parity and stop bits; modulation is ignored
+        bits += 1 + ((pRegs->CTL0 & UCPEN) ? 1 : 0) + ((pRegs->CTL0 & UCSPB) ? 2 : 1);
+        clocks = bits * ((pRegs->MCTL & UCOS16) ? prescaler * 16 : prescaler);
+    }
+
+    return (uint64_t)clocks * PS_PER_SECOND / clock;
+}
+
+/***************************************************************************//**
+ * @brief  Move TXBUF into the shift register if it is free. The receiving
+ *         device sees the byte, and answers, when shifting starts.
+ * @param  module   SIM_USCI_xxx
+ * @param  startPs  Time shifting starts
+ * @return none
+ ******************************************************************************/
+
+static void Sim_usciStart(uint8_t module, uint64_t startPs)
+{
+    UsciEngine *pEngine = &usci[module];
+    SimUsciRegs *pRegs = &simRegs.U[module];
+
+    if (pEngine->shifting || !pEngine->buffered)
+        return;
+
+    pEngine->buffered = 0;
+    pEngine->shifting = 1;
+    pEngine->donePs = startPs + Sim_usciByteTime(module);
+    pRegs->IFG |= UCTXIFG;
+    stats.usciBytes[module]++;
+
+    if (pRegs->CTL0 & UCSYNC)
+    {
+        pEngine->rxByte = Sim_spiExchange(module, pEngine->txByte);
+    }
+    else
+    {
+        // UART: TX only, RX comes from Sim_uartWrite()
+        pEngine->device = NO_DEVICE;
+        if (module == SIM_USCI_A1 && uartOutCount < UART_BUFFER_SIZE)
+            uartOut[uartOutCount++] = pEngine->txByte;
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Route an SPI byte to the selected device(s) and collect the
+ *         answer. Flags a bus error for contention or a clock mode or bit
+ *         order the device does not expect.
+ * @param  module  SIM_USCI_xxx
+ * @param  byte    Byte sent by the master
+ * @return Byte shifted in on SOMI, 0xFF from the pull-up if nobody drives
+ ******************************************************************************/
+
+static uint8_t Sim_spiExchange(uint8_t module, uint8_t byte)
+{
+    UsciEngine *pEngine = &usci[module];
+    uint8_t mode = simRegs.U[module].CTL0 & (UCCKPH + UCCKPL + UCMSB + UC7BIT);
+    uint8_t response = 0xFF;
+    uint8_t device, count = 0;
+
+    pEngine->device = NO_DEVICE;
+
+    for (device = 0; device < SIM_DEVICE_NUM; device++)
+    {
+        if (!selected[device])
+            continue;
+        if ((device == SIM_DEVICE_ACCEL) != (module == SIM_USCI_A0))
+            continue;
+        if (module != SIM_USCI_A0 && module != SIM_USCI_B1)
+            continue;
+
+        count++;
+        pEngine->device = device;
+        stats.deviceBytes[device]++;
+        if (mode != deviceModes[device])
+        {
+            stats.busErrors++;
+            continue;
+        }
+
+        switch (device)
+        {
+            case SIM_DEVICE_LCD:
+                SimLcd_write(byte, simRegs.P[LCD_CD_PORT].POUT & LCD_CD);
+                break;
+
+            case SIM_DEVICE_SD:
+                response &= SimSd_exchange(byte);
+                break;
+
+            default:
+                response &= SimAccel_exchange(byte);
+                break;
+        }
+    }
+
+    if (count > 1)
+        stats.busErrors++;
+
+    return response;
+}
+
+/***************************************************************************//**
+ * @brief  Finish bytes whose shift time is over, deliver injected UART
+ *         bytes and update UCBUSY.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Sim_usciUpdate(void)
+{
+    UsciEngine *pEngine;
+    SimUsciRegs *pRegs;
+    uint8_t module;
+
+    for (module = 0; module < SIM_USCI_NUM; module++)
+    {
+        pEngine = &usci[module];
+        pRegs = &simRegs.U[module];
+
+        while (pEngine->shifting && pEngine->donePs <= nowPs)
+        {
+            pEngine->shifting = 0;
+            if (pRegs->CTL0 & UCSYNC)
+            {
+                if (pRegs->IFG & UCRXIFG)
+                    pRegs->STAT |= UCOE;
+                pRegs->RXBUF = pEngine->rxByte;
+                pRegs->IFG |= UCRXIFG;
+            }
+            Sim_usciStart(module, pEngine->donePs);
+        }
+
+        if (pEngine->shifting || pEngine->buffered)
+            pRegs->STAT |= UCBUSY;
+        else
+            pRegs->STAT &= ~UCBUSY;
+    }
+
+    pRegs = &simRegs.U[SIM_USCI_A1];
+    while (uartInCount && uartRxPs <= nowPs)
+    {
+        if (pRegs->IFG & UCRXIFG)
+            pRegs->STAT |= UCOE;
+        pRegs->RXBUF = uartIn[uartInHead];
+        pRegs->IFG |= UCRXIFG;
+        uartInHead = (uartInHead + 1) % UART_BUFFER_SIZE;
+        uartInCount--;
+        uartRxPs = uartInCount ? uartRxPs + Sim_usciByteTime(SIM_USCI_A1) : SIM_NEVER;
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Update port inputs and edge flags, the chip selects and the
+ *         power and reset lines of the devices.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Sim_syncPins(void)
+{
+    SimPortRegs *pPort;
+    uint8_t port, external, in, rising, falling, device, powered, reset;
+    uint8_t lines[SIM_DEVICE_NUM];
+
+#define DRIVEN_LOW(p, bit)  ((simRegs.P[p].PDIR & (bit)) && !(simRegs.P[p].POUT & (bit)))
+#define DRIVEN_HIGH(p, bit) ((simRegs.P[p].PDIR & (bit)) && (simRegs.P[p].POUT & (bit)))
+
+    powered = DRIVEN_HIGH(ACCEL_PORT, ACCEL_PWR) ? 1 : 0;
+    if (powered != accelPowered)
+    {
+        accelPowered = powered;
+        SimAccel_setPower(powered);
+    }
+
+    reset = DRIVEN_LOW(LCD_CD_PORT, LCD_RST) ? 1 : 0;
+    if (reset && !lcdInReset)
+        SimLcd_reset(0);
+    lcdInReset = reset;
+
+    for (port = 1; port <= 8; port++)
+    {
+        pPort = &simRegs.P[port];
+        external = inputs[port];
+        if (port == ACCEL_INT_PORT)
+            external = (external & ~ACCEL_INT) | (SimAccel_getInt() ? ACCEL_INT : 0);
+
+        in = (pPort->POUT & pPort->PDIR) | (external & ~pPort->PDIR);
+        if (port <= 2)
+        {
+            rising = in & ~pPort->PIN;
+            falling = ~in & pPort->PIN;
+            pPort->PIFG |= (rising & ~pPort->PIES) | (falling & pPort->PIES);
+        }
+        pPort->PIN = in;
+    }
+
+    lines[SIM_DEVICE_LCD] = DRIVEN_LOW(LCD_CS_PORT, LCD_CS);
+    lines[SIM_DEVICE_SD] = DRIVEN_LOW(SD_CS_PORT, SD_CS);
+    lines[SIM_DEVICE_ACCEL] = accelPowered && DRIVEN_LOW(ACCEL_PORT, ACCEL_CS);
+
+#undef DRIVEN_LOW
+#undef DRIVEN_HIGH
+
+    for (device = 0; device < SIM_DEVICE_NUM; device++)
+    {
+        if (lines[device] && !selected[device])
+        {
+            stats.deviceSelects[device]++;
+            if (device == SIM_DEVICE_SD)
+                SimSd_select();
+            else if (device == SIM_DEVICE_ACCEL)
+                SimAccel_select();
+        }
+        else if (!lines[device] && selected[device])
+        {
+            // Released while its byte is still on the wire
+            if (usci[SIM_USCI_B1].shifting && usci[SIM_USCI_B1].device == device)
+                stats.busErrors++;
+            if (usci[SIM_USCI_A0].shifting && usci[SIM_USCI_A0].device == device)
+                stats.busErrors++;
+        }
+        selected[device] = lines[device];
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Earliest future event that can end a low-power mode.
+ * @param  none
+ * @return Absolute time in picoseconds, SIM_NEVER if there is none
+ ******************************************************************************/
+
+static uint64_t Sim_nextEventPs(void)
+{
+    uint64_t next = SIM_NEVER, event;
+    uint8_t i;
+
+    for (i = 0; i < TIMER_NUM; i++)
+    {
+        event = Sim_timerNextPs(i);
+        if (event < next)
+            next = event;
+    }
+
+    for (i = 0; i < SIM_USCI_NUM; i++)
+    {
+        if (usci[i].shifting && usci[i].donePs < next)
+            next = usci[i].donePs;
+    }
+
+    if (uartInCount && uartRxPs < next)
+        next = uartRxPs;
+
+    if (simRegs.P[ACCEL_INT_PORT].PIE & ACCEL_INT)
+    {
+        event = SimAccel_nextIntPs();
+        if (event < next)
+            next = event;
+    }
+
+    if (next != SIM_NEVER && next <= nowPs)
+        next = nowPs + 1;
+
+    return next;
+}
+
+/***************************************************************************//**
+ * @brief  Highest priority pending interrupt with a handler. TA2 CCR0 is a
+ *         single source vector, its flag is cleared as the ISR is taken.
+ * @param  none
+ * @return ISR to call, 0 if none
+ ******************************************************************************/
+
+static Sim_isr Sim_nextIsr(void)
+{
+    SimTimerRegs *pTa2 = &simRegs.T[2];
+
+    if (Cycles_ISR && Sim_timerVector(1, 0))
+        return Cycles_ISR;
+
+    if (Port1_ISR && (simRegs.P[1].PIFG & simRegs.P[1].PIE))
+        return Port1_ISR;
+
+    if (AppUart_ISR && (simRegs.U[SIM_USCI_A1].IFG & simRegs.U[SIM_USCI_A1].IE))
+        return AppUart_ISR;
+
+    if (Timer_compare_ISR && (pTa2->CCTL[0] & (CCIE + CCIFG)) == CCIE + CCIFG)
+    {
+        pTa2->CCTL[0] &= ~CCIFG;
+        return Timer_compare_ISR;
+    }
+
+    if (Timer_overflow_ISR && Sim_timerVector(2, 0))
+        return Timer_overflow_ISR;
+
+    if (Port2_ISR && (simRegs.P[2].PIFG & simRegs.P[2].PIE))
+        return Port2_ISR;
+
+    return 0;
+}
+
+/***************************************************************************//**
+ * @brief  Call the pending ISRs while GIE is set. Like the CPU, entry saves
+ *         SR and clears all bits but SCG0; the ISR can change the saved copy
+ *         with the _on_exit intrinsics.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Sim_dispatch(void)
+{
+    Sim_isr isr;
+
+    while ((sr & GIE) && isrDepth < MAX_ISR_NESTING && (isr = Sim_nextIsr()) != 0)
+    {
+        srStack[isrDepth++] = sr;
+        sr &= SCG0;
+        stats.interrupts++;
+        Sim_charge(SIM_ISR_ENTRY_CYCLES);
+
+        isr();
+
+        Sim_flush();
+        Sim_charge(SIM_ISR_EXIT_CYCLES);
+        sr = srStack[--isrDepth];
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Act on the register accessed last, assuming it was written.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Sim_flush(void)
+{
+    void *pRegister = pPendingWrite;
+    SimUsciRegs *pRegs;
+    uint8_t i;
+
+    if (!pRegister)
+        return;
+    pPendingWrite = 0;
+
+    for (i = 0; i < SIM_USCI_NUM; i++)
+    {
+        pRegs = &simRegs.U[i];
+
+        if (pRegister == &pRegs->TXBUF && !(pRegs->CTL1 & UCSWRST))
+        {
+            pRegs->IFG &= ~UCTXIFG;
+            usci[i].txByte = pRegs->TXBUF;
+            usci[i].buffered = 1;
+            Sim_usciStart(i, nowPs);
+            Sim_usciUpdate();
+        }
+        else if (pRegister == &pRegs->CTL1)
+        {
+            if ((pRegs->CTL1 & UCSWRST) && !usci[i].inReset)
+            {
+                usci[i].shifting = 0;
+                usci[i].buffered = 0;
+                pRegs->IFG = UCTXIFG;
+                pRegs->IE = 0;
+                pRegs->STAT = 0;
+            }
+            usci[i].inReset = pRegs->CTL1 & UCSWRST;
+        }
+    }
+
+    for (i = 0; i < TIMER_NUM; i++)
+    {
+        if (pRegister == &simRegs.T[i].CTL && (simRegs.T[i].CTL & TACLR))
+        {
+            simRegs.T[i].CTL &= ~TACLR;
+            simRegs.T[i].R = 0;
+            timerAccum[i] = 0;
+        }
+    }
+
+    if (pRegister == &simRegs.ADC12CTL0Reg)
+        Sim_adcConvert();
+}
+
+/***************************************************************************//**
+ * @brief  Side effects of reading a register.
+ * @param  pRegister  Register about to be accessed
+ * @return none
+ ******************************************************************************/
+
+static void Sim_readHook(void *pRegister)
+{
+    SimPortRegs *pPort;
+    uint8_t i, pending;
+
+    for (i = 0; i < SIM_USCI_NUM; i++)
+    {
+        if (pRegister == &simRegs.U[i].RXBUF)
+        {
+            simRegs.U[i].IFG &= ~UCRXIFG;
+            simRegs.U[i].STAT &= ~UCOE;
+        }
+        else if (pRegister == &simRegs.U[i].IV)
+        {
+            pending = simRegs.U[i].IFG & simRegs.U[i].IE;
+            simRegs.U[i].IV = (pending & UCRXIFG) ? USCI_UCRXIFG :
+                              (pending & UCTXIFG) ? USCI_UCTXIFG : USCI_NONE;
+        }
+    }
+
+    for (i = 0; i < TIMER_NUM; i++)
+    {
+        if (pRegister == &simRegs.T[i].IV)
+            simRegs.T[i].IV = Sim_timerVector(i, 1);
+    }
+
+    for (i = 1; i <= 2; i++)
+    {
+        pPort = &simRegs.P[i];
+        if (pRegister == &pPort->PIV)
+        {
+            pending = pPort->PIFG & pPort->PIE;
+            pPort->PIV = 0;
+            if (pending)
+            {
+                pending &= -pending;   // Lowest pin has priority
+                pPort->PIFG &= ~pending;
+                while (pending)
+                {
+                    pPort->PIV += 2;
+                    pending >>= 1;
+                }
+            }
+        }
+    }
+
+    // The supply is always good and the supervisors settle at once
+    if (pRegister == &simRegs.PMMIFGReg)
+    {
+        simRegs.PMMIFGReg |= SVSMLDLYIFG + SVSMHDLYIFG + SVMLVLRIFG + SVMHVLRIFG;
+        simRegs.PMMIFGReg &= ~(SVMLIFG + SVMHIFG);
+    }
+
+    // Oscillators never fault
+    if (pRegister == &simRegs.UCSCTL[7])
+        simRegs.UCSCTL[7] &= ~(DCOFFG + XT1LFOFFG + XT1HFOFFG + XT2OFFG);
+}
+
+/***************************************************************************//**
+ * @brief  Software triggered conversion: copy the injected channel values
+ *         into ADC12MEMx and set the flags. Timer triggers are not modeled.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+static void Sim_adcConvert(void)
+{
+    uint16_t ctl0 = simRegs.ADC12CTL0Reg;
+    uint8_t sequence = (simRegs.ADC12CTL1Reg >> 1) & 0x01;
+    uint8_t memory = simRegs.ADC12CTL1Reg >> 12;
+    uint8_t i;
+
+    if ((ctl0 & (ADC12ON + ADC12ENC + ADC12SC)) != ADC12ON + ADC12ENC + ADC12SC)
+        return;
+
+    for (i = 0; i < 16; i++)
+    {
+        simRegs.ADC12MEM[memory] = adcInputs[simRegs.ADC12MCTL[memory] & 0x0F];
+        simRegs.ADC12IFGReg |= 1 << memory;
+        if (!sequence || (simRegs.ADC12MCTL[memory] & ADC12EOS))
+            break;
+        memory = (memory + 1) & 0x0F;
+    }
+
+    simRegs.ADC12CTL0Reg &= ~ADC12SC;
+}
+
+/***************************************************************************//**
+ * @brief  Entry point of every register access made through msp430.h.
+ * @param  pRegister  Field of simRegs
+ * @return pRegister
+ ******************************************************************************/
+
+void *Sim_access(void *pRegister)
+{
+    Sim_flush();
+    stats.accesses++;
+    Sim_charge(SIM_ACCESS_CYCLES);
+    Sim_dispatch();
+    Sim_readHook(pRegister);
+    pPendingWrite = pRegister;
+
+    return pRegister;
+}
+
+/***************************************************************************//**
+ * @brief  Current simulated time, for the device models.
+ * @param  none
+ * @return Picoseconds since Sim_reset()
+ ******************************************************************************/
+
+uint64_t Sim_nowPs(void)
+{
+    return nowPs;
+}
+
+/***************************************************************************//**
+ * @brief  Report a condition the simulation cannot continue from and exit.
+ * @param  pFormat  printf style message
+ * @return none
+ ******************************************************************************/
+
+void Sim_fatal(const char *pFormat, ...)
+{
+    va_list args;
+
+    va_start(args, pFormat);
+    fprintf(stderr, "sim: ");
+    vfprintf(stderr, pFormat, args);
+    fprintf(stderr, " at %llu us\n", (unsigned long long)(nowPs / SIM_PS_PER_US));
+    va_end(args);
+    exit(2);
+}
+
+/***************************************************************************//**
+ * @brief  Put registers, devices and statistics in their power-up state.
+ *         Static state inside the HAL modules is not touched.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Sim_reset(void)
+{
+    uint8_t i;
+
+    memset(&simRegs, 0, sizeof(simRegs));
+    memset(usci, 0, sizeof(usci));
+    memset(selected, 0, sizeof(selected));
+    memset(timerAccum, 0, sizeof(timerAccum));
+    memset(adcInputs, 0, sizeof(adcInputs));
+    memset(inputs, 0xFF, sizeof(inputs));   // Pulled up buttons and lines
+
+    simRegs.WDTCTLReg = 0x6904;
+    simRegs.PMMCTL0Reg = 0x9600;
+    simRegs.SFRIFG1Reg = OFIFG;
+    simRegs.UCSCTL[1] = DCORSEL_2;
+    simRegs.UCSCTL[2] = FLLD__2 + 31;       // DCOCLKDIV = 32 x 32768 Hz
+    simRegs.UCSCTL[4] = SELS__DCOCLKDIV + SELM__DCOCLKDIV;
+    simRegs.UCSCTL[6] = 0xC1CD;
+    simRegs.UCSCTL[7] = DCOFFG + XT1LFOFFG + XT2OFFG;
+    for (i = 0; i < SIM_USCI_NUM; i++)
+    {
+        simRegs.U[i].CTL1 = UCSWRST;
+        simRegs.U[i].IFG = UCTXIFG;
+        usci[i].inReset = 1;
+    }
+
+    sr = 0;
+    isrDepth = 0;
+    pPendingWrite = 0;
+    nowPs = 0;
+    accelPowered = 0;
+    lcdInReset = 0;
+    uartOutCount = 0;
+    uartInHead = 0;
+    uartInCount = 0;
+    uartRxPs = SIM_NEVER;
+
+    SimLcd_reset(1);
+    SimAccel_reset();
+    SimSd_reset();
+    Sim_syncPins();
+    Sim_resetStats();
+}
+
+/***************************************************************************//**
+ * @brief  Read the statistics collected since the last Sim_resetStats().
+ * @param  pStats  Receives the statistics
+ * @return none
+ ******************************************************************************/
+
+void Sim_getStats(SimStats *pStats)
+{
+    Sim_flush();
+    *pStats = stats;
+    pStats->timeNs = (nowPs - statsStartPs) / 1000;
+    pStats->sleepNs = sleepPs / 1000;
+}
+
+/***************************************************************************//**
+ * @brief  Clear the statistics.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Sim_resetStats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+    statsStartPs = nowPs;
+    sleepPs = 0;
+}
+
+/***************************************************************************//**
+ * @brief  Let time pass with the CPU busy outside the HAL, e.g. in
+ *         application code. Interrupts are served meanwhile.
+ * @param  us  Microseconds
+ * @return none
+ ******************************************************************************/
+
+void Sim_elapse(uint32_t us)
+{
+    uint64_t endPs = nowPs + us * SIM_PS_PER_US;
+    uint64_t stepPs;
+
+    Sim_flush();
+    while (nowPs < endPs)
+    {
+        stepPs = Sim_nextEventPs();
+        stepPs = (stepPs < endPs ? stepPs : endPs) - nowPs;
+        stats.cycles += (unsigned __int128)stepPs * Sim_clockFrequency(0) / PS_PER_SECOND;
+        Sim_advance(stepPs);
+        Sim_dispatch();
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Drive external inputs of a port, e.g. a button press.
+ * @param  port   1 to 8
+ * @param  mask   Pins to drive
+ * @param  level  0 for low, else high
+ * @return none
+ ******************************************************************************/
+
+void Sim_setInput(uint8_t port, uint8_t mask, uint8_t level)
+{
+    if (port < 1 || port > 8)
+        return;
+
+    Sim_flush();
+    inputs[port] = (inputs[port] & ~mask) | (level ? mask : 0);
+    Sim_syncPins();
+    Sim_dispatch();
+}
+
+/***************************************************************************//**
+ * @brief  Set the value the ADC converts for an input channel.
+ * @param  channel  ADC12INCH_x value
+ * @param  value    12-bit result
+ * @return none
+ ******************************************************************************/
+
+void Sim_setAdc(uint8_t channel, uint16_t value)
+{
+    adcInputs[channel & 0x0F] = value & 0x0FFF;
+}
+
+/***************************************************************************//**
+ * @brief  Take the bytes USCI_A1 sent in UART mode.
+ * @param  pBuffer  Destination
+ * @param  size     Size of pBuffer
+ * @return Bytes copied, the rest stays queued
+ ******************************************************************************/
+
+uint16_t Sim_uartRead(uint8_t *pBuffer, uint16_t size)
+{
+    Sim_flush();
+    if (size > uartOutCount)
+        size = uartOutCount;
+
+    memcpy(pBuffer, uartOut, size);
+    memmove(uartOut, uartOut + size, uartOutCount - size);
+    uartOutCount -= size;
+
+    return size;
+}
+
+/***************************************************************************//**
+ * @brief  Send bytes to USCI_A1, received at its configured baud rate.
+ * @param  pData  Bytes
+ * @param  size   Number of bytes
+ * @return none
+ ******************************************************************************/
+
+void Sim_uartWrite(const uint8_t *pData, uint16_t size)
+{
+    Sim_flush();
+    if (!uartInCount && size)
+        uartRxPs = nowPs + Sim_usciByteTime(SIM_USCI_A1);
+
+    while (size-- && uartInCount < UART_BUFFER_SIZE)
+    {
+        uartIn[(uartInHead + uartInCount) % UART_BUFFER_SIZE] = *pData++;
+        uartInCount++;
+    }
+}
+
+/*******************************************************************************
+ * Intrinsics
+ ******************************************************************************/
+
+unsigned short __get_SR_register(void)
+{
+    Sim_flush();
+    Sim_charge(SIM_INTRINSIC_CYCLES);
+
+    return sr;
+}
+
+void __bis_SR_register(unsigned short bits)
+{
+    uint64_t nextPs;
+
+    Sim_flush();
+    Sim_charge(SIM_INTRINSIC_CYCLES);
+    sr |= bits;
+    Sim_dispatch();
+
+    // Sleep until an ISR clears CPUOFF in the saved SR
+    while (sr & CPUOFF)
+    {
+        nextPs = Sim_nextEventPs();
+        if (!(sr & GIE))
+            Sim_fatal("LPM entered with interrupts disabled (SR 0x%04X)", sr);
+        if (nextPs == SIM_NEVER || nextPs - nowPs > SIM_MAX_SLEEP_US * SIM_PS_PER_US)
+            Sim_fatal("no wake-up source for LPM (SR 0x%04X)", sr);
+
+        sleepPs += nextPs - nowPs;
+        Sim_advance(nextPs - nowPs);
+        Sim_dispatch();
+    }
+}
+
+void __bic_SR_register(unsigned short bits)
+{
+    Sim_flush();
+    Sim_charge(SIM_INTRINSIC_CYCLES);
+    sr &= ~bits;
+}
+
+void __bis_SR_register_on_exit(unsigned short bits)
+{
+    if (!isrDepth)
+        Sim_fatal("__bis_SR_register_on_exit() outside an ISR");
+    srStack[isrDepth - 1] |= bits;
+}
+
+void __bic_SR_register_on_exit(unsigned short bits)
+{
+    if (!isrDepth)
+        Sim_fatal("__bic_SR_register_on_exit() outside an ISR");
+    srStack[isrDepth - 1] &= ~bits;
+}
+
+void __disable_interrupt(void)
+{
+    Sim_flush();
+    Sim_charge(SIM_INTRINSIC_CYCLES);
+    sr &= ~GIE;
+}
+
+void __enable_interrupt(void)
+{
+    Sim_flush();
+    Sim_charge(SIM_INTRINSIC_CYCLES);
+    sr |= GIE;
+    Sim_dispatch();
+}
+
+void __no_operation(void)
+{
+    Sim_flush();
+    Sim_charge(SIM_INTRINSIC_CYCLES);
+}
+
+void __delay_cycles(unsigned long cycles)
+{
+    uint32_t chunk;
+
+    Sim_flush();
+    while (cycles)
+    {
+        chunk = cycles < DELAY_CHUNK_CYCLES ? cycles : DELAY_CHUNK_CYCLES;
+        Sim_charge(chunk);
+        Sim_dispatch();
+        cycles -= chunk;
+    }
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
@@ -0,0 +1,112 @@
+/*******************************************************************************
+ *
+ *  Sim.h
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Cost model in MCLK cycles. Only register accesses, intrinsics and
+// interrupt entry are charged; plain C code between them is free, so the
+// cycle counts are a lower bound that tracks peripheral-bound time.
+#define SIM_ACCESS_CYCLES       3      // MOV &reg: absolute addressing
+#define SIM_INTRINSIC_CYCLES    1
+#define SIM_ISR_ENTRY_CYCLES    6
+#define SIM_ISR_EXIT_CYCLES     5      // RETI
+
+#define SIM_MAX_SLEEP_US        60000000UL  // Longest LPM before giving up
+
+// USCI modules, in SimRegisters.U[] order
+#define SIM_USCI_A0             0
+#define SIM_USCI_A1             1
+#define SIM_USCI_B0             2
+#define SIM_USCI_B1             3
+#define SIM_USCI_NUM            4
+
+// SPI devices
+#define SIM_DEVICE_LCD          0      // DOGS102-6 on USCI_B1, CS P7.4
+#define SIM_DEVICE_SD           1      // SD card on USCI_B1, CS P3.7
+#define SIM_DEVICE_ACCEL        2      // CMA3000 on USCI_A0, CS P3.5
+#define SIM_DEVICE_NUM          3
+
+// Display geometry
+#define SIM_LCD_WIDTH           102
+#define SIM_LCD_HEIGHT          64
+
+// CMA3000 timing
+#define SIM_ACCEL_SETTLE_US     10000  // From mode write to the first sample
+
+// SD card timing
+#define SIM_SD_BLOCK_SIZE       512
+#define SIM_SD_INIT_RETRIES     2      // ACMD41s answered "idle" before ready
+#define SIM_SD_ACCESS_US        100    // CMD17/18 to data token
+#define SIM_SD_PROGRAM_US       500    // Busy after a written block
+
+typedef struct
+{
+    uint64_t cycles;                   // MCLK cycles while the CPU ran
+    uint64_t timeNs;                   // Simulated time
+    uint64_t sleepNs;                  // Part of timeNs spent in an LPM
+    uint32_t accesses;                 // Register accesses
+    uint32_t interrupts;               // ISRs dispatched
+    uint32_t usciBytes[SIM_USCI_NUM];
+    uint32_t deviceBytes[SIM_DEVICE_NUM];
+    uint32_t deviceSelects[SIM_DEVICE_NUM];  // CS assertions
+    uint32_t busErrors;                // Contention, wrong SPI mode or CS
+                                       // released mid-byte
+} SimStats;
+
+extern void Sim_reset(void);
+extern void Sim_getStats(SimStats *pStats);
+extern void Sim_resetStats(void);
+extern void Sim_elapse(uint32_t us);
+
+extern void Sim_setInput(uint8_t port, uint8_t mask, uint8_t level);
+extern void Sim_setAdc(uint8_t channel, uint16_t value);
+extern uint16_t Sim_uartRead(uint8_t *pBuffer, uint16_t size);
+extern void Sim_uartWrite(const uint8_t *pData, uint16_t size);
+
+extern uint8_t Sim_lcdGetPixel(uint8_t x, uint8_t y);
+extern void Sim_lcdDump(FILE *pFile);
+
+extern void Sim_accelSet(int8_t x, int8_t y, int8_t z);
+extern void Sim_accelSetPresent(uint8_t present);
+
+extern int Sim_sdOpen(const char *pPath, uint32_t blocks);
+extern void Sim_sdClose(void);
+
+#endif /* SIM_H */
@@ -0,0 +1,314 @@
+/*******************************************************************************
+ *
+ *  SimAccel.c - CMA3000 accelerometer model
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       SimAccel.c
+ * @addtogroup Sim
+ * @{
+ *
+ * CMA3000-D01 accelerometer model: register file, SPI framing (address
+ * byte, then one data byte) and the data-ready INT line, which rises at the
+ * output data rate once the sensor has settled in a measurement mode and
+ * falls when an output register is read.
+ ******************************************************************************/
+#include "Sim.h"
+#include "SimModels.h"
+
+// Registers
+#define REG_WHO_AM_I        0x00
+#define REG_REVID           0x01
+#define REG_CTRL            0x02
+#define REG_STATUS          0x03
+#define REG_INT_STATUS      0x05
+#define REG_DOUTX           0x06
+#define REG_DOUTY           0x07
+#define REG_DOUTZ           0x08
+#define REG_NUM             0x10
+
+#define WHO_AM_I_VALUE      0x10
+#define REVID_VALUE         0x10
+
+// CTRL bits
+#define CTRL_INT_DIS        0x01
+#define CTRL_MODE_MASK      0x0E
+#define CTRL_MODE_100       0x02
+#define CTRL_MODE_400       0x04
+#define CTRL_MODE_40        0x06
+
+#define ADDRESS_WRITE       0x02       // RW bit of the address byte
+
+static uint8_t registers[REG_NUM];
+static uint8_t present = 1;
+static uint8_t powered;
+static uint8_t frameByte;              // Position in the SPI frame
+static uint8_t frameAddress;
+static uint8_t frameWrite;
+static int8_t outputs[3];
+static uint64_t firstSamplePs;         // SIM_NEVER when not measuring
+static uint64_t samplePeriodPs;
+static int64_t lastReadSample;
+
+// Forward declared functions
+static int64_t SimAccel_currentSample(void);
+static void SimAccel_writeRegister(uint8_t address, uint8_t value);
+static uint8_t SimAccel_readRegister(uint8_t address);
+
+
+/***************************************************************************//**
+ * @brief  Index of the newest sample available.
+ * @param  none
+ * @return Sample number since the mode was set, -1 if none yet
+ ******************************************************************************/
+
+static int64_t SimAccel_currentSample(void)
+{
+    uint64_t now = Sim_nowPs();
+
+    if (firstSamplePs == SIM_NEVER || now < firstSamplePs)
+        return -1;
+
+    return (now - firstSamplePs) / samplePeriodPs;
+}
+
+/***************************************************************************//**
+ * @brief  Write a register. Changing the mode restarts settling.
+ * @param  address  Register address
+ * @param  value    New value
+ * @return none
+ ******************************************************************************/
+
+static void SimAccel_writeRegister(uint8_t address, uint8_t value)
+{
+    uint8_t mode = value & CTRL_MODE_MASK;
+
+    if (address != REG_CTRL)
+    {
+        if (address > REG_DOUTZ && address < REG_NUM)
+            registers[address] = value;
+        return;
+    }
+
+    if (mode != (registers[REG_CTRL] & CTRL_MODE_MASK))
+    {
+        switch (mode)
+        {
+            case CTRL_MODE_100:
+                samplePeriodPs = 10000 * SIM_PS_PER_US;
+                break;
+
+            case CTRL_MODE_400:
+                samplePeriodPs = 2500 * SIM_PS_PER_US;
+                break;
+
+            case CTRL_MODE_40:
+                samplePeriodPs = 25000 * SIM_PS_PER_US;
+                break;
+
+            default:
+                samplePeriodPs = 0;    // Power down and motion modes
+                break;
+        }
+
+        firstSamplePs = samplePeriodPs ? Sim_nowPs() + SIM_ACCEL_SETTLE_US * SIM_PS_PER_US
+                                       : SIM_NEVER;
+        lastReadSample = -1;
+    }
+
+    registers[REG_CTRL] = value;
+}
+
+/***************************************************************************//**
+ * @brief  Read a register. Output and interrupt status reads acknowledge
+ *         the data-ready interrupt.
+ * @param  address  Register address
+ * @return Register value
+ ******************************************************************************/
+
+static uint8_t SimAccel_readRegister(uint8_t address)
+{
+    if (address >= REG_NUM)
+        return 0;
+
+    if (address >= REG_INT_STATUS && address <= REG_DOUTZ)
+        lastReadSample = SimAccel_currentSample();
+
+    switch (address)
+    {
+        case REG_DOUTX:
+        case REG_DOUTY:
+        case REG_DOUTZ:
+            return (uint8_t)outputs[address - REG_DOUTX];
+
+        default:
+            return registers[address];
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Power-up state of the sensor.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void SimAccel_reset(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < REG_NUM; i++)
+        registers[i] = 0;
+    registers[REG_WHO_AM_I] = WHO_AM_I_VALUE;
+    registers[REG_REVID] = REVID_VALUE;
+
+    powered = 0;
+    frameByte = 0;
+    firstSamplePs = SIM_NEVER;
+    samplePeriodPs = 0;
+    lastReadSample = -1;
+}
+
+/***************************************************************************//**
+ * @brief  Follow the PWR pin.
+ * @param  on  Nonzero when the sensor is supplied
+ * @return none
+ ******************************************************************************/
+
+void SimAccel_setPower(uint8_t on)
+{
+    SimAccel_reset();
+    powered = on;
+}
+
+/***************************************************************************//**
+ * @brief  CS was asserted, a new frame starts.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void SimAccel_select(void)
+{
+    frameByte = 0;
+}
+
+/***************************************************************************//**
+ * @brief  Exchange one SPI byte.
+ * @param  byte  Byte from the master
+ * @return Byte to the master
+ ******************************************************************************/
+
+uint8_t SimAccel_exchange(uint8_t byte)
+{
+    uint8_t response = 0x00;
+
+    if (!powered || !present)
+        return 0xFF;
+
+    if (frameByte == 0)
+    {
+        frameAddress = byte >> 2;
+        frameWrite = byte & ADDRESS_WRITE;
+        response = registers[REG_STATUS];
+    }
+    else if (frameByte == 1)
+    {
+        if (frameWrite)
+            SimAccel_writeRegister(frameAddress, byte);
+        else
+            response = SimAccel_readRegister(frameAddress);
+    }
+
+    if (frameByte < 0xFF)
+        frameByte++;
+
+    return response;
+}
+
+/***************************************************************************//**
+ * @brief  Level of the INT line.
+ * @param  none
+ * @return 1 while an unread sample is available
+ ******************************************************************************/
+
+uint8_t SimAccel_getInt(void)
+{
+    if (!powered || !present || (registers[REG_CTRL] & CTRL_INT_DIS))
+        return 0;
+
+    return SimAccel_currentSample() > lastReadSample;
+}
+
+/***************************************************************************//**
+ * @brief  Time the INT line rises next, for waking up from an LPM.
+ * @param  none
+ * @return Absolute time in picoseconds, SIM_NEVER if it will not rise
+ ******************************************************************************/
+
+uint64_t SimAccel_nextIntPs(void)
+{
+    if (!powered || !present || firstSamplePs == SIM_NEVER || SimAccel_getInt())
+        return SIM_NEVER;
+
+    return firstSamplePs + (uint64_t)(lastReadSample + 1) * samplePeriodPs;
+}
+
+/***************************************************************************//**
+ * @brief  Set the acceleration the sensor reports.
+ * @param  x  DOUTX in counts
+ * @param  y  DOUTY in counts
+ * @param  z  DOUTZ in counts
+ * @return none
+ ******************************************************************************/
+
+void Sim_accelSet(int8_t x, int8_t y, int8_t z)
+{
+    outputs[0] = x;
+    outputs[1] = y;
+    outputs[2] = z;
+}
+
+/***************************************************************************//**
+ * @brief  Fit or remove the sensor, e.g. to exercise the init timeout.
+ * @param  isPresent  0 for a missing sensor
+ * @return none
+ ******************************************************************************/
+
+void Sim_accelSetPresent(uint8_t isPresent)
+{
+    present = isPresent;
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
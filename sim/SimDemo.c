@@ -0,0 +1,457 @@
+/*******************************************************************************
+ *
+ *  SimDemo.c - Driver benchmark and regression check on the simulator
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       SimDemo.c
+ * @addtogroup Sim
+ * @{
+ *
+ * Runs the LCD, accelerometer and SD card drivers against the simulator and
+ * prints one line per driver call:
+ *
+ *     name  bytes  selects  cycles  us
+ *
+ * bytes and selects count SPI bytes and chip select assertions on all
+ * devices. With -b the run is compared to a baseline written earlier with
+ * -w; more bytes or selects, more than BASELINE_TOLERANCE percent more
+ * cycles, a bus error or a functional mismatch make the run fail.
+ *
+ *     simdemo [-w baseline] [-b baseline] [-l] [-s image]
+ ******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "msp430.h"
+#include "HAL_UCS.h"
+#include "HAL_Timer.h"
+#include "HAL_Cycles.h"
+#include "HAL_Profile.h"
+#include "HAL_Latency.h"
+#include "HAL_Dogs102x6.h"
+#include "HAL_Cma3000.h"
+#include "HAL_SDCard.h"
+#include "Sim.h"
+
+#define BASELINE_TOLERANCE  5          // Percent of cycles
+#define MAX_RESULTS         32
+#define SD_BLOCKS           8192       // 4 MByte card
+#define SD_TEST_BLOCK       100
+#define SD_MAX_POLLS        2000
+
+// SD commands
+#define CMD_GO_IDLE_STATE   0
+#define CMD_SEND_IF_COND    8
+#define CMD_READ_SINGLE     17
+#define CMD_WRITE_SINGLE    24
+#define CMD_APP_CMD         55
+#define CMD_READ_OCR        58
+#define ACMD_SEND_OP_COND   41
+
+typedef struct
+{
+    char name[32];
+    uint32_t bytes;
+    uint32_t selects;
+    uint64_t cycles;
+    uint64_t us;
+} Result;
+
+static Result results[MAX_RESULTS];
+static uint8_t resultCount;
+static uint8_t failures;
+static SimStats before;
+
+// Forward declared functions
+static void SimDemo_begin(void);
+static void SimDemo_end(const char *pName);
+static void SimDemo_check(uint8_t ok, const char *pWhat);
+static uint8_t SimDemo_sdByte(uint8_t byte);
+static uint8_t SimDemo_sdCommand(uint8_t index, uint32_t argument, uint8_t crc);
+static uint8_t SimDemo_sdIdentify(void);
+static uint8_t SimDemo_sdReadBlock(uint32_t block, uint8_t *pBuffer);
+static uint8_t SimDemo_sdWriteBlock(uint32_t block, uint8_t *pBuffer);
+static uint8_t SimDemo_lcdMatchesShadow(void);
+static void SimDemo_writeBaseline(const char *pPath);
+static void SimDemo_compareBaseline(const char *pPath);
+
+#define MEASURE(name, statement) do { SimDemo_begin(); statement; SimDemo_end(name); } while (0)
+
+
+static void SimDemo_begin(void)
+{
+    Sim_getStats(&before);
+}
+
+
+static void SimDemo_end(const char *pName)
+{
+    SimStats after;
+    Result *pResult = &results[resultCount];
+    uint8_t i;
+
+    Sim_getStats(&after);
+    if (resultCount == MAX_RESULTS)
+        return;
+
+    strncpy(pResult->name, pName, sizeof(pResult->name) - 1);
+    pResult->bytes = 0;
+    pResult->selects = 0;
+    for (i = 0; i < SIM_DEVICE_NUM; i++)
+    {
+        pResult->bytes += after.deviceBytes[i] - before.deviceBytes[i];
+        pResult->selects += after.deviceSelects[i] - before.deviceSelects[i];
+    }
+    pResult->cycles = after.cycles - before.cycles;
+    pResult->us = (after.timeNs - before.timeNs) / 1000;
+    resultCount++;
+
+    printf("%-20s %8u %8u %10llu %10llu\n", pResult->name, pResult->bytes, pResult->selects,
+           (unsigned long long)pResult->cycles, (unsigned long long)pResult->us);
+
+    if (after.busErrors != before.busErrors)
+    {
+        printf("FAIL %s: %u SPI bus error(s)\n", pName, after.busErrors - before.busErrors);
+        failures++;
+    }
+}
+
+
+static void SimDemo_check(uint8_t ok, const char *pWhat)
+{
+    if (!ok)
+    {
+        printf("FAIL %s\n", pWhat);
+        failures++;
+    }
+}
+
+
+static uint8_t SimDemo_sdByte(uint8_t byte)
+{
+    SDCard_sendFrame(&byte, 1);
+    SDCard_readFrame(&byte, 1);
+    return byte;
+}
+
+
+static uint8_t SimDemo_sdCommand(uint8_t index, uint32_t argument, uint8_t crc)
+{
+    uint8_t frame[6];
+    uint8_t response, polls = 8;
+
+    frame[0] = 0x40 | index;
+    frame[1] = argument >> 24;
+    frame[2] = argument >> 16;
+    frame[3] = argument >> 8;
+    frame[4] = argument;
+    frame[5] = crc;
+    SDCard_sendFrame(frame, sizeof(frame));
+
+    do
+    {
+        SDCard_readFrame(&response, 1);
+    } while ((response & 0x80) && --polls);
+
+    return response;
+}
+
+
+static uint8_t SimDemo_sdIdentify(void)
+{
+    uint8_t dummy[10];
+    uint8_t r7[4];
+    uint8_t response;
+    uint16_t polls = SD_MAX_POLLS;
+
+    // 80 clocks with CS high to enter SPI mode
+    memset(dummy, 0xFF, sizeof(dummy));
+    SDCard_setCSHigh();
+    SDCard_sendFrame(dummy, sizeof(dummy));
+
+    SDCard_setCSLow();
+    response = SimDemo_sdCommand(CMD_GO_IDLE_STATE, 0, 0x95);
+    if (response == 0x01)
+    {
+        SimDemo_sdCommand(CMD_SEND_IF_COND, 0x1AA, 0x87);
+        SDCard_readFrame(r7, sizeof(r7));
+
+        do
+        {
+            SimDemo_sdCommand(CMD_APP_CMD, 0, 0xFF);
+            response = SimDemo_sdCommand(ACMD_SEND_OP_COND, 0x40000000UL, 0xFF);
+        } while (response && --polls);
+
+        SimDemo_sdCommand(CMD_READ_OCR, 0, 0xFF);
+        SDCard_readFrame(r7, sizeof(r7));
+    }
+    SDCard_setCSHigh();
+    SimDemo_sdByte(0xFF);
+
+    SDCard_fastMode();
+
+    return response == 0x00;
+}
+
+
+static uint8_t SimDemo_sdReadBlock(uint32_t block, uint8_t *pBuffer)
+{
+    uint8_t token = 0xFF;
+    uint8_t crc[2];
+    uint16_t polls = SD_MAX_POLLS;
+
+    SDCard_setCSLow();
+    if (SimDemo_sdCommand(CMD_READ_SINGLE, block, 0xFF) == 0x00)
+    {
+        do
+        {
+            SDCard_readFrame(&token, 1);
+        } while (token == 0xFF && --polls);
+
+        if (token == 0xFE)
+        {
+            SDCard_readFrame(pBuffer, 512);
+            SDCard_readFrame(crc, sizeof(crc));
+        }
+    }
+    SDCard_setCSHigh();
+    SimDemo_sdByte(0xFF);
+
+    return token == 0xFE;
+}
+
+
+static uint8_t SimDemo_sdWriteBlock(uint32_t block, uint8_t *pBuffer)
+{
+    uint8_t header[2] = { 0xFF, 0xFE };
+    uint8_t crc[2] = { 0xFF, 0xFF };
+    uint8_t response = 0xFF;
+    uint16_t polls = SD_MAX_POLLS;
+
+    SDCard_setCSLow();
+    if (SimDemo_sdCommand(CMD_WRITE_SINGLE, block, 0xFF) == 0x00)
+    {
+        SDCard_sendFrame(header, sizeof(header));
+        SDCard_sendFrame(pBuffer, 512);
+        SDCard_sendFrame(crc, sizeof(crc));
+
+        do
+        {
+            SDCard_readFrame(&response, 1);
+        } while (response == 0xFF && --polls);
+
+        // Wait while the card is programming
+        polls = SD_MAX_POLLS;
+        while (SimDemo_sdByte(0xFF) != 0xFF && --polls) ;
+    }
+    SDCard_setCSHigh();
+    SimDemo_sdByte(0xFF);
+
+    return (response & 0x1F) == 0x05;
+}
+
+
+static uint8_t SimDemo_lcdMatchesShadow(void)
+{
+    uint8_t x, y, shadow;
+
+    for (y = 0; y < DOGS102x6_Y_SIZE; y++)
+    {
+        for (x = 0; x < DOGS102x6_X_SIZE; x++)
+        {
+            shadow = dogs102x6Memory[2 + (y >> 3) * DOGS102x6_X_SIZE + x] & (0x80 >> (y & 0x07));
+            if (!shadow != !Sim_lcdGetPixel(x, y))
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+static void SimDemo_writeBaseline(const char *pPath)
+{
+    FILE *pFile = fopen(pPath, "w");
+    uint8_t i;
+
+    if (!pFile)
+    {
+        perror(pPath);
+        exit(2);
+    }
+
+    fprintf(pFile, "# name bytes selects cycles\n");
+    for (i = 0; i < resultCount; i++)
+    {
+        fprintf(pFile, "%s %u %u %llu\n", results[i].name, results[i].bytes,
+                results[i].selects, (unsigned long long)results[i].cycles);
+    }
+    fclose(pFile);
+}
+
+
+static void SimDemo_compareBaseline(const char *pPath)
+{
+    FILE *pFile = fopen(pPath, "r");
+    char line[128], name[32];
+    unsigned bytes, selects;
+    unsigned long long cycles;
+    uint8_t i;
+
+    if (!pFile)
+    {
+        perror(pPath);
+        exit(2);
+    }
+
+    while (fgets(line, sizeof(line), pFile))
+    {
+        if (line[0] == '#' || sscanf(line, "%31s %u %u %llu", name, &bytes, &selects, &cycles) != 4)
+            continue;
+
+        for (i = 0; i < resultCount && strcmp(results[i].name, name); i++) ;
+        if (i == resultCount)
+        {
+            printf("FAIL %s: not measured\n", name);
+            failures++;
+        }
+        else if (results[i].bytes > bytes || results[i].selects > selects ||
+                 results[i].cycles * 100 > cycles * (100 + BASELINE_TOLERANCE))
+        {
+            printf("FAIL %s: %u bytes, %u selects, %llu cycles; baseline %u, %u, %llu\n",
+                   name, results[i].bytes, results[i].selects,
+                   (unsigned long long)results[i].cycles, bytes, selects, cycles);
+            failures++;
+        }
+    }
+    fclose(pFile);
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *pBaseline = 0, *pNewBaseline = 0, *pImage = 0;
+    uint8_t dumpLcd = 0;
+    uint8_t block[512], readBack[512];
+    uint16_t i;
+    int option;
+
+    while ((option = getopt(argc, argv, "b:w:ls:")) != -1)
+    {
+        switch (option)
+        {
+            case 'b':
+                pBaseline = optarg;
+                break;
+
+            case 'w':
+                pNewBaseline = optarg;
+                break;
+
+            case 'l':
+                dumpLcd = 1;
+                break;
+
+            case 's':
+                pImage = optarg;
+                break;
+
+            default:
+                fprintf(stderr, "usage: %s [-w baseline] [-b baseline] [-l] [-s image]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    Sim_reset();
+    if (Sim_sdOpen(pImage, pImage ? 0 : SD_BLOCKS) && Sim_sdOpen(pImage, SD_BLOCKS))
+    {
+        fprintf(stderr, "cannot open SD image\n");
+        return 2;
+    }
+    Sim_accelSet(12, -5, 56);
+
+    printf("%-20s %8s %8s %10s %10s\n", "# name", "bytes", "selects", "cycles", "us");
+
+    MEASURE("boot",
+            UCS_init();
+            UCS_selectProfile(UCS_PROFILE_BURST);
+            Timer_init();
+            Cycles_init();
+            Profile_init();
+            Latency_init();
+            __enable_interrupt());
+
+    MEASURE("lcd_init", Dogs102x6_init());
+    MEASURE("lcd_clear", Dogs102x6_clearScreen());
+    MEASURE("lcd_string", Dogs102x6_stringDraw(1, 0, "Simulated HAL", DOGS102x6_DRAW_NORMAL));
+    MEASURE("lcd_pixel", Dogs102x6_pixelDraw(50, 40, DOGS102x6_DRAW_NORMAL));
+    MEASURE("lcd_hline", Dogs102x6_horizontalLineDraw(0, 101, 63, DOGS102x6_DRAW_NORMAL));
+    MEASURE("lcd_line", Dogs102x6_lineDraw(0, 24, 101, 62, DOGS102x6_DRAW_NORMAL));
+    MEASURE("lcd_circle", Dogs102x6_circleDraw(80, 40, 12, DOGS102x6_DRAW_NORMAL));
+    MEASURE("lcd_refresh", Dogs102x6_refresh(DOGS102x6_DRAW_IMMEDIATE));
+    SimDemo_check(SimDemo_lcdMatchesShadow(), "display RAM differs from the HAL frame buffer");
+
+    MEASURE("accel_init", SimDemo_check(Cma3000_init() == CMA3000_INIT_OK, "accelerometer init"));
+    Sim_elapse(3000);                  // Let a new sample come in
+    MEASURE("accel_read", Cma3000_readAccel());
+    SimDemo_check(Cma3000_xAccel == 12 && Cma3000_yAccel == -5 && Cma3000_zAccel == 56,
+                  "accelerometer values");
+
+    for (i = 0; i < sizeof(block); i++)
+        block[i] = i * 7 + 3;
+
+    MEASURE("sd_init", SDCard_init());
+    MEASURE("sd_identify", SimDemo_check(SimDemo_sdIdentify(), "SD card identification"));
+    MEASURE("sd_write_block", SimDemo_check(SimDemo_sdWriteBlock(SD_TEST_BLOCK, block), "SD write"));
+    MEASURE("sd_read_block", SimDemo_check(SimDemo_sdReadBlock(SD_TEST_BLOCK, readBack), "SD read"));
+    SimDemo_check(!memcmp(block, readBack, sizeof(block)), "SD data read back");
+
+    if (dumpLcd)
+        Sim_lcdDump(stdout);
+
+    if (pNewBaseline)
+        SimDemo_writeBaseline(pNewBaseline);
+    if (pBaseline)
+        SimDemo_compareBaseline(pBaseline);
+
+    Sim_sdClose();
+    printf(failures ? "%u failure(s)\n" : "ok\n", failures);
+
+    return failures ? 1 : 0;
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
@@ -0,0 +1,311 @@
+/*******************************************************************************
+ *
+ *  SimLcd.c - DOGS102-6 display controller model
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       SimLcd.c
+ * @addtogroup Sim
+ * @{
+ *
+ * DOGS102-6 display model: decodes the UC1701 command set into controller
+ * state and keeps the 132 x 65 display RAM, so the simulator can render
+ * what the panel would show.
+ ******************************************************************************/
+#include <string.h>
+#include "Sim.h"
+#include "SimModels.h"
+
+#define RAM_PAGES           9
+#define RAM_COLUMNS         132
+#define NO_COMMAND          0x00
+
+// Commands, see HAL_Dogs102x6.c
+#define CMD_COLUMN_LSB      0x00
+#define CMD_COLUMN_MSB      0x10
+#define CMD_RESISTOR_RATIO  0x20
+#define CMD_POWER_CONTROL   0x28
+#define CMD_SCROLL_LINE     0x40
+#define CMD_VOLUME          0x81
+#define CMD_SEG_DIRECTION   0xA0
+#define CMD_BIAS_RATIO      0xA2
+#define CMD_ALL_PIXEL_ON    0xA4
+#define CMD_INVERSE         0xA6
+#define CMD_DISPLAY_ENABLE  0xAE
+#define CMD_PAGE_ADDRESS    0xB0
+#define CMD_COM_DIRECTION   0xC0
+#define CMD_CURSOR_UPDATE   0xE0
+#define CMD_SYSTEM_RESET    0xE2
+#define CMD_NOP             0xE3
+#define CMD_CURSOR_RESTORE  0xEE
+#define CMD_ADV_CONTROL     0xFA
+
+#define ADV_WRAP_AROUND     0x02       // Column wraps to the next page
+
+static uint8_t ram[RAM_PAGES][RAM_COLUMNS];
+static uint8_t column, page, scrollLine;
+static uint8_t segReverse, comReverse;
+static uint8_t allPixelsOn, inverse, displayOn;
+static uint8_t volume, resistorRatio, powerControl, biasRatio, advancedControl;
+static uint8_t cursorUpdate, savedColumn;
+static uint8_t pendingCommand;        // First byte of a two byte command
+
+// Forward declared functions
+static void SimLcd_command(uint8_t byte);
+
+
+/***************************************************************************//**
+ * @brief  Execute a command byte.
+ * @param  byte  Command, or the argument of a pending two byte command
+ * @return none
+ ******************************************************************************/
+
+static void SimLcd_command(uint8_t byte)
+{
+    if (pendingCommand == CMD_VOLUME)
+    {
+        volume = byte & 0x3F;
+        pendingCommand = NO_COMMAND;
+        return;
+    }
+    if (pendingCommand == CMD_ADV_CONTROL)
+    {
+        advancedControl = byte;
+        pendingCommand = NO_COMMAND;
+        return;
+    }
+
+    switch (byte & 0xF0)
+    {
+        case CMD_COLUMN_LSB:
+            column = (column & 0xF0) | (byte & 0x0F);
+            return;
+
+        case CMD_COLUMN_MSB:
+            column = (column & 0x0F) | ((byte & 0x0F) << 4);
+            return;
+
+        case CMD_RESISTOR_RATIO:
+            if (byte & 0x08)
+                powerControl = byte & 0x07;
+            else
+                resistorRatio = byte & 0x07;
+            return;
+
+        case CMD_SCROLL_LINE:
+        case CMD_SCROLL_LINE + 0x10:
+        case CMD_SCROLL_LINE + 0x20:
+        case CMD_SCROLL_LINE + 0x30:
+            scrollLine = byte & 0x3F;
+            return;
+
+        case CMD_PAGE_ADDRESS:
+            page = byte & 0x0F;
+            if (page >= RAM_PAGES)
+                page = RAM_PAGES - 1;
+            return;
+
+        case CMD_COM_DIRECTION:
+            comReverse = (byte & 0x08) ? 1 : 0;
+            return;
+
+        default:
+            break;
+    }
+
+    switch (byte)
+    {
+        case CMD_VOLUME:
+        case CMD_ADV_CONTROL:
+            pendingCommand = byte;
+            break;
+
+        case CMD_SEG_DIRECTION:
+        case CMD_SEG_DIRECTION + 1:
+            segReverse = byte & 0x01;
+            break;
+
+        case CMD_BIAS_RATIO:
+        case CMD_BIAS_RATIO + 1:
+            biasRatio = byte & 0x01;
+            break;
+
+        case CMD_ALL_PIXEL_ON:
+        case CMD_ALL_PIXEL_ON + 1:
+            allPixelsOn = byte & 0x01;
+            break;
+
+        case CMD_INVERSE:
+        case CMD_INVERSE + 1:
+            inverse = byte & 0x01;
+            break;
+
+        case CMD_DISPLAY_ENABLE:
+        case CMD_DISPLAY_ENABLE + 1:
+            displayOn = byte & 0x01;
+            break;
+
+        case CMD_CURSOR_UPDATE:
+            cursorUpdate = 1;
+            savedColumn = column;
+            break;
+
+        case CMD_CURSOR_RESTORE:
+            if (cursorUpdate)
+                column = savedColumn;
+            cursorUpdate = 0;
+            break;
+
+        case CMD_SYSTEM_RESET:
+            SimLcd_reset(0);
+            break;
+
+        default:
+            break;                     // CMD_NOP and unsupported commands
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Reset the controller registers.
+ * @param  clearRam  Also clear the display RAM, as at power-up
+ * @return none
+ ******************************************************************************/
+
+void SimLcd_reset(uint8_t clearRam)
+{
+    if (clearRam)
+        memset(ram, 0, sizeof(ram));
+
+    column = 0;
+    page = 0;
+    scrollLine = 0;
+    segReverse = 0;
+    comReverse = 0;
+    allPixelsOn = 0;
+    inverse = 0;
+    displayOn = 0;
+    volume = 0x20;
+    resistorRatio = 4;
+    powerControl = 0;
+    biasRatio = 0;
+    advancedControl = 0x90;
+    cursorUpdate = 0;
+    pendingCommand = NO_COMMAND;
+}
+
+/***************************************************************************//**
+ * @brief  Take one byte clocked in while the display is selected.
+ * @param  byte    Byte received
+ * @param  isData  CD line level, nonzero for display data
+ * @return none
+ ******************************************************************************/
+
+void SimLcd_write(uint8_t byte, uint8_t isData)
+{
+    if (!isData)
+    {
+        SimLcd_command(byte);
+        return;
+    }
+
+    ram[page][column] = byte;
+    if (column < RAM_COLUMNS - 1)
+    {
+        column++;
+    }
+    else if (advancedControl & ADV_WRAP_AROUND)
+    {
+        column = 0;
+        page = (page + 1) % RAM_PAGES;
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Pixel as shown on the panel, after scrolling, mirroring and the
+ *         inverse and all-on modes. The coordinates match the HAL's:
+ *         x = 0 is the left column and y = 0 the top row.
+ * @param  x  Column, 0 to SIM_LCD_WIDTH - 1
+ * @param  y  Row, 0 to SIM_LCD_HEIGHT - 1
+ * @return 1 if the pixel is dark
+ ******************************************************************************/
+
+uint8_t Sim_lcdGetPixel(uint8_t x, uint8_t y)
+{
+    uint8_t line, ramColumn, pixel;
+
+    if (x >= SIM_LCD_WIDTH || y >= SIM_LCD_HEIGHT || !displayOn)
+        return 0;
+    if (allPixelsOn)
+        return 1;
+
+    // The panel is wired for mirrored SEG and COM scanning
+    line = ((comReverse ? SIM_LCD_HEIGHT - 1 - y : y) + scrollLine) % SIM_LCD_HEIGHT;
+    ramColumn = segReverse ? x : RAM_COLUMNS - 1 - x;
+    pixel = (ram[line >> 3][ramColumn] >> (line & 0x07)) & 0x01;
+
+    return pixel ^ inverse;
+}
+
+/***************************************************************************//**
+ * @brief  Print the panel as text, '#' for dark pixels.
+ * @param  pFile  Output stream
+ * @return none
+ ******************************************************************************/
+
+void Sim_lcdDump(FILE *pFile)
+{
+    uint8_t x, y;
+
+    fputc('+', pFile);
+    for (x = 0; x < SIM_LCD_WIDTH; x++)
+        fputc('-', pFile);
+    fputs("+\n", pFile);
+
+    for (y = 0; y < SIM_LCD_HEIGHT; y++)
+    {
+        fputc('|', pFile);
+        for (x = 0; x < SIM_LCD_WIDTH; x++)
+            fputc(Sim_lcdGetPixel(x, y) ? '#' : ' ', pFile);
+        fputs("|\n", pFile);
+    }
+
+    fputc('+', pFile);
+    for (x = 0; x < SIM_LCD_WIDTH; x++)
+        fputc('-', pFile);
+    fputs("+\n", pFile);
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
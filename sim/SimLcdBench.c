@@ -0,0 +1,99 @@
+/*******************************************************************************
+ *
+ *  SimLcdBench.c - HAL_LcdBench runner on the simulator
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       SimLcdBench.c
+ * @addtogroup Sim
+ * @{
+ *
+ * Runs the HAL_LcdBench workloads on the simulator and prints the same table
+ * as the "lcdbench" shell command, so host and target runs can be diffed.
+ *
+ *     lcdbench [-p profile]
+ *
+ * profile is a UCS_PROFILE_xxx number, UCS_PROFILE_BURST by default.
+ ******************************************************************************/
+#include <stdlib.h>
+#include <unistd.h>
+#include "msp430.h"
+#include "HAL_UCS.h"
+#include "HAL_Timer.h"
+#include "HAL_Cycles.h"
+#include "HAL_Dogs102x6.h"
+#include "HAL_LcdBench.h"
+#include "Sim.h"
+
+int main(int argc, char *argv[])
+{
+    LcdBenchResult result;
+    uint8_t profile = UCS_PROFILE_BURST;
+    uint8_t i;
+    int option;
+
+    while ((option = getopt(argc, argv, "p:")) != -1)
+    {
+        if (option != 'p' || atoi(optarg) < 0 || atoi(optarg) >= UCS_NUM_PROFILES)
+        {
+            fprintf(stderr, "usage: %s [-p profile]\n", argv[0]);
+            return 2;
+        }
+        profile = atoi(optarg);
+    }
+
+    Sim_reset();
+    UCS_init();
+    UCS_selectProfile(profile);
+    Timer_init();
+    Cycles_init();
+    Dogs102x6_init();
+    __enable_interrupt();
+
+    printf("# " LCDBENCH_COLUMNS "\n");
+    for (i = 0; i < LcdBench_getCount(); i++)
+    {
+        LcdBench_run(i, &result);
+        printf("%s %lu %lu %lu %lu %lu %lu\n", result.name,
+               (unsigned long)result.bytes, (unsigned long)result.selects,
+               (unsigned long)result.addressSets, (unsigned long)result.wireMicroseconds,
+               (unsigned long)result.cycles, (unsigned long)Cycles_toMicroseconds(result.cycles));
+    }
+
+    return 0;
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
@@ -0,0 +1,67 @@
+/*******************************************************************************
+ *
+ *  SimModels.h
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef SIM_MODELS_H
+#define SIM_MODELS_H
+
+#include <stdint.h>
+
+// Interface between the simulator core and its device models
+
+#define SIM_PS_PER_US           1000000ULL
+#define SIM_NEVER               UINT64_MAX
+
+extern uint64_t Sim_nowPs(void);
+extern void Sim_fatal(const char *pFormat, ...);
+
+// DOGS102-6, UC1701 controller; write only, CD selects command or data
+extern void SimLcd_reset(uint8_t clearRam);
+extern void SimLcd_write(uint8_t byte, uint8_t isData);
+
+// CMA3000-D01; the first byte after CS is the address byte
+extern void SimAccel_reset(void);
+extern void SimAccel_setPower(uint8_t on);
+extern void SimAccel_select(void);
+extern uint8_t SimAccel_exchange(uint8_t byte);
+extern uint8_t SimAccel_getInt(void);
+extern uint64_t SimAccel_nextIntPs(void);
+
+// SD card in SPI mode
+extern void SimSd_reset(void);
+extern void SimSd_select(void);
+extern uint8_t SimSd_exchange(uint8_t byte);
+
+#endif /* SIM_MODELS_H */
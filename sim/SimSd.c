@@ -0,0 +1,506 @@
+/*******************************************************************************
+ *
+ *  SimSd.c - SD card SPI mode model
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       SimSd.c
+ * @addtogroup Sim
+ * @{
+ *
+ * SD card model in SPI mode: command framing with R1/R3/R7 responses,
+ * ACMD41 initialization, single and multiple block reads and writes with
+ * access and programming delays, and CSD/CID reads. Blocks live in an image
+ * file or in memory; the card reports itself as SDHC (block addressing).
+ ******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "Sim.h"
+#include "SimModels.h"
+
+#define QUEUE_SIZE          (SIM_SD_BLOCK_SIZE + 8)
+
+// R1 bits
+#define R1_READY            0x00
+#define R1_IDLE             0x01
+#define R1_ILLEGAL_COMMAND  0x04
+#define R1_ADDRESS_ERROR    0x20
+
+// Tokens
+#define TOKEN_START_BLOCK   0xFE
+#define TOKEN_START_MULTI   0xFC
+#define TOKEN_STOP_TRAN     0xFD
+#define DATA_ACCEPTED       0x05
+#define DATA_WRITE_ERROR    0x0D
+
+// Transfer states
+#define XFER_NONE           0
+#define XFER_SINGLE         1
+#define XFER_MULTIPLE       2
+
+static FILE *pImage;
+static uint8_t *pMemory;
+static uint32_t blockCount;
+
+static uint8_t idle;
+static uint8_t appCommand;
+static uint8_t initRetries;
+static uint8_t command[6];
+static uint8_t commandCount;
+
+static uint8_t queue[QUEUE_SIZE];     // Bytes the card sends next
+static uint16_t queueHead, queueCount;
+static uint64_t busyUntilPs;
+
+static uint8_t readState;
+static uint32_t readAddress;
+static uint64_t dataReadyPs;
+
+static uint8_t writeState;
+static uint8_t writeToken;             // Waiting for a token, else receiving
+static uint32_t writeAddress;
+static uint16_t writeCount;
+static uint8_t writeBuffer[SIM_SD_BLOCK_SIZE + 2];
+
+// Forward declared functions
+static void SimSd_push(uint8_t byte);
+static uint8_t SimSd_transferBlock(uint32_t address, uint8_t *pBuffer, uint8_t write);
+static void SimSd_queueRegister(const uint8_t *pRegister);
+static void SimSd_command(uint8_t index, uint32_t argument);
+static void SimSd_writeByte(uint8_t byte);
+
+
+/***************************************************************************//**
+ * @brief  Queue a byte for the host.
+ * @param  byte  Byte to send
+ * @return none
+ ******************************************************************************/
+
+static void SimSd_push(uint8_t byte)
+{
+    if (queueCount == QUEUE_SIZE)
+        Sim_fatal("SD response queue overflow");
+
+    queue[(queueHead + queueCount) % QUEUE_SIZE] = byte;
+    queueCount++;
+}
+
+/***************************************************************************//**
+ * @brief  Read or write one block of the image.
+ * @param  address  Block number
+ * @param  pBuffer  SIM_SD_BLOCK_SIZE bytes
+ * @param  write    Nonzero to write pBuffer to the image
+ * @return 1 on success, 0 if the block does not exist
+ ******************************************************************************/
+
+static uint8_t SimSd_transferBlock(uint32_t address, uint8_t *pBuffer, uint8_t write)
+{
+    if (address >= blockCount)
+        return 0;
+
+    if (pMemory)
+    {
+        if (write)
+            memcpy(pMemory + (size_t)address * SIM_SD_BLOCK_SIZE, pBuffer, SIM_SD_BLOCK_SIZE);
+        else
+            memcpy(pBuffer, pMemory + (size_t)address * SIM_SD_BLOCK_SIZE, SIM_SD_BLOCK_SIZE);
+        return 1;
+    }
+
+    if (fseek(pImage, (long)address * SIM_SD_BLOCK_SIZE, SEEK_SET))
+        return 0;
+    if (write)
+        return fwrite(pBuffer, SIM_SD_BLOCK_SIZE, 1, pImage) == 1;
+    return fread(pBuffer, SIM_SD_BLOCK_SIZE, 1, pImage) == 1;
+}
+
+/***************************************************************************//**
+ * @brief  Queue a 16 byte register (CSD or CID) as a data block.
+ * @param  pRegister  Register content
+ * @return none
+ ******************************************************************************/
+
+static void SimSd_queueRegister(const uint8_t *pRegister)
+{
+    uint8_t i;
+
+    SimSd_push(0xFF);
+    SimSd_push(TOKEN_START_BLOCK);
+    for (i = 0; i < 16; i++)
+        SimSd_push(pRegister[i]);
+    SimSd_push(0xFF);                  // CRC is not checked in SPI mode
+    SimSd_push(0xFF);
+}
+
+/***************************************************************************//**
+ * @brief  Execute a complete command frame.
+ * @param  index     Command index, 0 to 63
+ * @param  argument  32-bit argument
+ * @return none
+ ******************************************************************************/
+
+static void SimSd_command(uint8_t index, uint32_t argument)
+{
+    static const uint8_t cid[16] = {
+        0x00, 'S', 'M', 'S', 'I', 'M', 'S', 'D', 0x10, 0x00, 0x00, 0x00, 0x01, 0x01, 0x5A, 0x01
+    };
+    uint8_t csd[16] = {
+        0x40, 0x0E, 0x00, 0x32, 0x5B, 0x59, 0x00, 0x00, 0x00, 0x00, 0x7F, 0x80, 0x0A, 0x40, 0x00, 0x01
+    };
+    uint32_t size = blockCount / 1024 - 1;   // C_SIZE, in 512 KByte units
+    uint8_t r1 = idle ? R1_IDLE : R1_READY;
+    uint8_t isAppCommand = appCommand;
+
+    // Only CMD12 is taken while a multiple block read is streaming
+    if (readState == XFER_MULTIPLE && index != 12)
+        return;
+
+    appCommand = 0;
+    SimSd_push(0xFF);                  // N_CR
+
+    if (isAppCommand && index == 41)
+    {
+        if (initRetries)
+            initRetries--;
+        else
+            idle = 0;
+        SimSd_push(idle ? R1_IDLE : R1_READY);
+        return;
+    }
+
+    if (idle && index != 0 && index != 8 && index != 55 && index != 58 && index != 59)
+    {
+        SimSd_push(r1 | R1_ILLEGAL_COMMAND);
+        return;
+    }
+
+    switch (index)
+    {
+        case 0:                        // GO_IDLE_STATE
+            idle = 1;
+            initRetries = SIM_SD_INIT_RETRIES;
+            readState = XFER_NONE;
+            writeState = XFER_NONE;
+            SimSd_push(R1_IDLE);
+            break;
+
+        case 8:                        // SEND_IF_COND, R7 echoes the pattern
+            SimSd_push(r1);
+            SimSd_push(0x00);
+            SimSd_push(0x00);
+            SimSd_push((argument >> 8) & 0x0F);
+            SimSd_push(argument & 0xFF);
+            break;
+
+        case 9:                        // SEND_CSD
+            csd[7] = (size >> 16) & 0x3F;
+            csd[8] = (size >> 8) & 0xFF;
+            csd[9] = size & 0xFF;
+            SimSd_push(r1);
+            SimSd_queueRegister(csd);
+            break;
+
+        case 10:                       // SEND_CID
+            SimSd_push(r1);
+            SimSd_queueRegister(cid);
+            break;
+
+        case 12:                       // STOP_TRANSMISSION
+            readState = XFER_NONE;
+            queueHead = 0;
+            queueCount = 0;
+            SimSd_push(0xFF);          // Stuff byte
+            SimSd_push(r1);
+            break;
+
+        case 13:                       // SEND_STATUS, R2
+            SimSd_push(r1);
+            SimSd_push(0x00);
+            break;
+
+        case 17:                       // READ_SINGLE_BLOCK
+        case 18:                       // READ_MULTIPLE_BLOCK
+        case 24:                       // WRITE_BLOCK
+        case 25:                       // WRITE_MULTIPLE_BLOCK
+            if (argument >= blockCount)
+            {
+                SimSd_push(r1 | R1_ADDRESS_ERROR);
+                break;
+            }
+            SimSd_push(r1);
+            if (index < 24)
+            {
+                readState = (index == 17) ? XFER_SINGLE : XFER_MULTIPLE;
+                readAddress = argument;
+                dataReadyPs = Sim_nowPs() + SIM_SD_ACCESS_US * SIM_PS_PER_US;
+            }
+            else
+            {
+                writeState = (index == 24) ? XFER_SINGLE : XFER_MULTIPLE;
+                writeToken = 1;
+                writeAddress = argument;
+            }
+            break;
+
+        case 55:                       // APP_CMD
+            appCommand = 1;
+            SimSd_push(r1);
+            break;
+
+        case 58:                       // READ_OCR, R3: powered up, CCS set
+            SimSd_push(r1);
+            SimSd_push(idle ? 0x40 : 0xC0);
+            SimSd_push(0xFF);
+            SimSd_push(0x80);
+            SimSd_push(0x00);
+            break;
+
+        case 16:                       // SET_BLOCKLEN, fixed for SDHC
+        case 59:                       // CRC_ON_OFF
+            SimSd_push(r1);
+            break;
+
+        default:
+            SimSd_push(r1 | R1_ILLEGAL_COMMAND);
+            break;
+    }
+}
+
+/***************************************************************************//**
+ * @brief  Take a byte of a write transfer: start token, data, CRC.
+ * @param  byte  Byte from the host
+ * @return none
+ ******************************************************************************/
+
+static void SimSd_writeByte(uint8_t byte)
+{
+    if (writeToken)
+    {
+        if (byte == TOKEN_STOP_TRAN && writeState == XFER_MULTIPLE)
+        {
+            writeState = XFER_NONE;
+            SimSd_push(0xFF);
+        }
+        else if (byte == (writeState == XFER_MULTIPLE ? TOKEN_START_MULTI : TOKEN_START_BLOCK))
+        {
+            writeToken = 0;
+            writeCount = 0;
+        }
+        return;
+    }
+
+    writeBuffer[writeCount++] = byte;
+    if (writeCount < sizeof(writeBuffer))
+        return;
+
+    if (SimSd_transferBlock(writeAddress++, writeBuffer, 1))
+    {
+        SimSd_push(DATA_ACCEPTED);
+        busyUntilPs = Sim_nowPs() + SIM_SD_PROGRAM_US * SIM_PS_PER_US;
+    }
+    else
+    {
+        SimSd_push(DATA_WRITE_ERROR);
+    }
+
+    writeToken = 1;
+    if (writeState == XFER_SINGLE)
+        writeState = XFER_NONE;
+}
+
+/***************************************************************************//**
+ * @brief  Protocol state after power-up; the image is kept.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void SimSd_reset(void)
+{
+    idle = 1;
+    appCommand = 0;
+    initRetries = SIM_SD_INIT_RETRIES;
+    commandCount = 0;
+    queueHead = 0;
+    queueCount = 0;
+    busyUntilPs = 0;
+    readState = XFER_NONE;
+    writeState = XFER_NONE;
+}
+
+/***************************************************************************//**
+ * @brief  CS was asserted, realign command framing.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void SimSd_select(void)
+{
+    commandCount = 0;
+}
+
+/***************************************************************************//**
+ * @brief  Exchange one SPI byte.
+ * @param  byte  Byte from the host
+ * @return Byte to the host
+ ******************************************************************************/
+
+uint8_t SimSd_exchange(uint8_t byte)
+{
+    uint8_t response = 0xFF;
+    uint8_t block[SIM_SD_BLOCK_SIZE];
+    uint16_t i;
+
+    if (!blockCount)
+        return 0xFF;                   // No card
+
+    // Output: queued response, busy, or the next data block once accessed
+    if (!queueCount && readState != XFER_NONE && Sim_nowPs() >= dataReadyPs)
+    {
+        SimSd_push(TOKEN_START_BLOCK);
+        if (!SimSd_transferBlock(readAddress++, block, 0))
+            memset(block, 0, sizeof(block));
+        for (i = 0; i < SIM_SD_BLOCK_SIZE; i++)
+            SimSd_push(block[i]);
+        SimSd_push(0xFF);
+        SimSd_push(0xFF);
+
+        if (readState == XFER_SINGLE)
+            readState = XFER_NONE;
+        else
+            dataReadyPs = Sim_nowPs() + SIM_SD_ACCESS_US * SIM_PS_PER_US;
+    }
+
+    if (queueCount)
+    {
+        response = queue[queueHead];
+        queueHead = (queueHead + 1) % QUEUE_SIZE;
+        queueCount--;
+    }
+    else if (Sim_nowPs() < busyUntilPs)
+    {
+        response = 0x00;
+    }
+
+    // Input: write data or a command frame
+    if (writeState != XFER_NONE)
+    {
+        SimSd_writeByte(byte);
+    }
+    else if (commandCount || (byte & 0xC0) == 0x40)
+    {
+        command[commandCount++] = byte;
+        if (commandCount == sizeof(command))
+        {
+            commandCount = 0;
+            SimSd_command(command[0] & 0x3F,
+                          ((uint32_t)command[1] << 24) | ((uint32_t)command[2] << 16) |
+                          ((uint32_t)command[3] << 8) | command[4]);
+        }
+    }
+
+    return response;
+}
+
+/***************************************************************************//**
+ * @brief  Insert a card backed by an image file, or by memory.
+ * @param  pPath   Image file, created if missing; 0 for a memory image
+ * @param  blocks  Card size in 512-byte blocks, at least 1024; 0 takes the
+ *                 size of an existing file
+ * @return 0 on success, -1 on error
+ ******************************************************************************/
+
+int Sim_sdOpen(const char *pPath, uint32_t blocks)
+{
+    long size;
+
+    Sim_sdClose();
+
+    if (!pPath)
+    {
+        pMemory = calloc(blocks, SIM_SD_BLOCK_SIZE);
+        if (!pMemory || blocks < 1024)
+        {
+            Sim_sdClose();
+            return -1;
+        }
+        blockCount = blocks;
+        return 0;
+    }
+
+    pImage = fopen(pPath, "r+b");
+    if (!pImage)
+        pImage = fopen(pPath, "w+b");
+    if (!pImage)
+        return -1;
+
+    fseek(pImage, 0, SEEK_END);
+    size = ftell(pImage);
+    if (!blocks)
+        blocks = size / SIM_SD_BLOCK_SIZE;
+    if (blocks < 1024)
+    {
+        Sim_sdClose();
+        return -1;
+    }
+    if (size < (long)blocks * SIM_SD_BLOCK_SIZE)
+    {
+        fseek(pImage, (long)blocks * SIM_SD_BLOCK_SIZE - 1, SEEK_SET);
+        fputc(0, pImage);
+    }
+
+    blockCount = blocks;
+    return 0;
+}
+
+/***************************************************************************//**
+ * @brief  Remove the card and release its image.
+ * @param  none
+ * @return none
+ ******************************************************************************/
+
+void Sim_sdClose(void)
+{
+    if (pImage)
+        fclose(pImage);
+    free(pMemory);
+
+    pImage = 0;
+    pMemory = 0;
+    blockCount = 0;
+    SimSd_reset();
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
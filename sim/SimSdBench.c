@@ -0,0 +1,231 @@
+/*******************************************************************************
+ *
+ *  SimSdBench.c - HAL_SdBench runner on the simulated card
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @file       SimSdBench.c
+ * @addtogroup Sim
+ * @{
+ *
+ * Runs the HAL_SdBench tests against the simulated card and prints the same
+ * table as the "sdbench" shell command. With -b the throughput of every row
+ * is compared to a baseline written earlier with -w; any error or a drop of
+ * more than BASELINE_TOLERANCE percent fails the run.
+ *
+ *     sdbench [-w baseline] [-b baseline] [-p profile] [-s image]
+ ******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "msp430.h"
+#include "HAL_UCS.h"
+#include "HAL_Timer.h"
+#include "HAL_Cycles.h"
+#include "HAL_SdBench.h"
+#include "Sim.h"
+
+#define BASELINE_TOLERANCE  5          // Percent of throughput
+#define SD_BLOCKS           8192       // 4 MByte card
+#define FIRST_BLOCK         2048
+#define MAX_RESULTS         128
+
+static SdBenchResult results[MAX_RESULTS];
+static uint8_t resultCount;
+static uint8_t failures;
+
+// Forward declared functions
+static void SimSdBench_writeBaseline(const char *pPath);
+static void SimSdBench_compareBaseline(const char *pPath);
+
+
+static void SimSdBench_writeBaseline(const char *pPath)
+{
+    FILE *pFile = fopen(pPath, "w");
+    uint8_t i;
+
+    if (!pFile)
+    {
+        perror(pPath);
+        exit(2);
+    }
+
+    fprintf(pFile, "# test divider bytes_per_second\n");
+    for (i = 0; i < resultCount; i++)
+    {
+        fprintf(pFile, "%s %u %lu\n", results[i].name, results[i].divider,
+                (unsigned long)results[i].bytesPerSecond);
+    }
+    fclose(pFile);
+}
+
+
+static void SimSdBench_compareBaseline(const char *pPath)
+{
+    FILE *pFile = fopen(pPath, "r");
+    char line[128], name[32];
+    unsigned divider;
+    unsigned long rate;
+    uint8_t i;
+
+    if (!pFile)
+    {
+        perror(pPath);
+        exit(2);
+    }
+
+    while (fgets(line, sizeof(line), pFile))
+    {
+        if (line[0] == '#' || sscanf(line, "%31s %u %lu", name, &divider, &rate) != 3)
+            continue;
+
+        for (i = 0; i < resultCount; i++)
+        {
+            if (!strcmp(results[i].name, name) && results[i].divider == divider)
+                break;
+        }
+        if (i == resultCount)
+        {
+            printf("FAIL %s /%u: not measured\n", name, divider);
+            failures++;
+        }
+        else if ((uint64_t)results[i].bytesPerSecond * 100 < (uint64_t)rate * (100 - BASELINE_TOLERANCE))
+        {
+            printf("FAIL %s /%u: %lu bytes/s, baseline %lu\n", name, divider,
+                   (unsigned long)results[i].bytesPerSecond, rate);
+            failures++;
+        }
+    }
+    fclose(pFile);
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *pBaseline = 0, *pNewBaseline = 0, *pImage = 0;
+    SdBenchResult *pResult;
+    uint8_t profile = UCS_PROFILE_BURST;
+    uint8_t status, divider, test;
+    int option;
+
+    while ((option = getopt(argc, argv, "b:w:p:s:")) != -1)
+    {
+        switch (option)
+        {
+            case 'b':
+                pBaseline = optarg;
+                break;
+
+            case 'w':
+                pNewBaseline = optarg;
+                break;
+
+            case 'p':
+                profile = atoi(optarg);
+                break;
+
+            case 's':
+                pImage = optarg;
+                break;
+
+            default:
+                fprintf(stderr, "usage: %s [-w baseline] [-b baseline] [-p profile] [-s image]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (profile >= UCS_NUM_PROFILES)
+    {
+        fprintf(stderr, "no clock profile %u\n", profile);
+        return 2;
+    }
+
+    Sim_reset();
+    if (Sim_sdOpen(pImage, pImage ? 0 : SD_BLOCKS) && Sim_sdOpen(pImage, SD_BLOCKS))
+    {
+        fprintf(stderr, "cannot open SD image\n");
+        return 2;
+    }
+
+    UCS_init();
+    UCS_selectProfile(profile);
+    Timer_init();
+    Cycles_init();
+    __enable_interrupt();
+
+    status = SdBench_begin(FIRST_BLOCK);
+    if (status != SDBENCH_OK)
+    {
+        SdBench_end();
+        printf("FAIL SdBench_begin() status %u\n", status);
+        return 1;
+    }
+
+    printf("# " SDBENCH_COLUMNS "\n");
+    for (divider = 0; divider < SdBench_getDividerCount(); divider++)
+    {
+        for (test = 0; test < SdBench_getTestCount() && resultCount < MAX_RESULTS; test++)
+        {
+            pResult = &results[resultCount++];
+            SdBench_run(divider, test, pResult);
+
+            printf("%s %u %lu %u %u %u %lu %lu %lu %lu %lu %lu\n", pResult->name,
+                   pResult->divider, (unsigned long)pResult->spiKhz, pResult->blocksPerOp,
+                   pResult->ops, pResult->errors, (unsigned long)pResult->bytesPerSecond / 1024,
+                   (unsigned long)pResult->p50Us, (unsigned long)pResult->p90Us,
+                   (unsigned long)pResult->maxUs, (unsigned long)pResult->busyAvgUs,
+                   (unsigned long)pResult->busyMaxUs);
+
+            if (pResult->errors)
+            {
+                printf("FAIL %s /%u: %u error(s)\n", pResult->name, pResult->divider, pResult->errors);
+                failures++;
+            }
+        }
+    }
+    SdBench_end();
+
+    if (pNewBaseline)
+        SimSdBench_writeBaseline(pNewBaseline);
+    if (pBaseline)
+        SimSdBench_compareBaseline(pBaseline);
+
+    Sim_sdClose();
+    printf(failures ? "%u failure(s)\n" : "ok\n", failures);
+
+    return failures ? 1 : 0;
+}
+
+/***************************************************************************//**
+ * @}
+ ******************************************************************************/
@@ -0,0 +1,620 @@
+/*******************************************************************************
+ *
+ *  msp430.h
+ *
+ *  Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+// Host replacement for the MSP430F5529 device header, used by the simulator
+// build in this directory. Every register is a field of simRegs and each
+// access goes through Sim_access(), which advances simulated time, runs the
+// peripheral models and dispatches interrupts. Only the registers and bits
+// used by the simulated HAL modules are provided.
+//
+// Sim_access() cannot tell a read from a write. Writes are acted on at the
+// next register access, and any access to a TXBUF register counts as a
+// write, which matches how the HAL uses them.
+
+#ifndef SIM_MSP430_H
+#define SIM_MSP430_H
+
+#include <stdint.h>
+
+#define __MSP430F5529__
+
+typedef struct
+{
+    uint8_t PIN, POUT, PDIR, PREN, PDS, PSEL;
+    uint8_t PIES, PIE, PIFG;
+    uint16_t PIV;
+} SimPortRegs;
+
+typedef struct
+{
+    uint16_t CTL, R, IV, EX0;
+    uint16_t CCTL[7];
+    uint16_t CCR[7];
+} SimTimerRegs;
+
+typedef struct
+{
+    uint8_t CTL0, CTL1;
+    uint8_t BR0, BR1;                  // Adjacent, UCxxBRW reads both
+    uint8_t MCTL, STAT, RXBUF, TXBUF, IE, IFG;
+    uint16_t IV;
+} SimUsciRegs;
+
+typedef struct
+{
+    uint16_t SFRIE1Reg, SFRIFG1Reg, SFRRPCRReg;
+    uint16_t WDTCTLReg;
+    uint16_t PMMCTL0Reg, PMMCTL1Reg, SVSMHCTLReg, SVSMLCTLReg, PMMIFGReg, PMMRIEReg;
+    uint16_t UCSCTL[9];
+    SimPortRegs P[9];                  // P[1]..P[8]
+    SimTimerRegs T[4];                 // TA0, TA1, TA2, TB0
+    SimUsciRegs U[4];                  // UCA0, UCA1, UCB0, UCB1
+    uint16_t ADC12CTL0Reg, ADC12CTL1Reg, ADC12CTL2Reg, ADC12IFGReg, ADC12IEReg, ADC12IVReg;
+    uint8_t ADC12MCTL[16];
+    uint16_t ADC12MEM[16];
+} SimRegisters;
+
+extern SimRegisters simRegs;
+extern void *Sim_access(void *pRegister);
+
+#define SIM_REG(field)           (*(volatile __typeof__(simRegs.field) *)Sim_access(&simRegs.field))
+#define SIM_REG8_AT(field, n)    (*(volatile uint8_t *)Sim_access((uint8_t *)&simRegs.field + (n)))
+#define SIM_REG16_AT(field)      (*(volatile uint16_t *)Sim_access(&simRegs.field))
+
+// Special function, watchdog, PMM and UCS
+#define SFRIE1           SIM_REG(SFRIE1Reg)
+#define SFRIFG1          SIM_REG(SFRIFG1Reg)
+#define SFRRPCR          SIM_REG(SFRRPCRReg)
+#define WDTCTL           SIM_REG(WDTCTLReg)
+#define PMMCTL0          SIM_REG(PMMCTL0Reg)
+#define PMMCTL1          SIM_REG(PMMCTL1Reg)
+#define SVSMHCTL         SIM_REG(SVSMHCTLReg)
+#define SVSMLCTL         SIM_REG(SVSMLCTLReg)
+#define PMMIFG           SIM_REG(PMMIFGReg)
+#define PMMRIE           SIM_REG(PMMRIEReg)
+#define PMMCTL0_L        SIM_REG8_AT(PMMCTL0Reg, 0)
+#define PMMCTL0_H        SIM_REG8_AT(PMMCTL0Reg, 1)
+#define UCSCTL0          SIM_REG(UCSCTL[0])
+#define UCSCTL1          SIM_REG(UCSCTL[1])
+#define UCSCTL2          SIM_REG(UCSCTL[2])
+#define UCSCTL3          SIM_REG(UCSCTL[3])
+#define UCSCTL4          SIM_REG(UCSCTL[4])
+#define UCSCTL5          SIM_REG(UCSCTL[5])
+#define UCSCTL6          SIM_REG(UCSCTL[6])
+#define UCSCTL7          SIM_REG(UCSCTL[7])
+#define UCSCTL8          SIM_REG(UCSCTL[8])
+
+// Digital I/O, P1 and P2 have interrupts
+#define P1IN             SIM_REG(P[1].PIN)
+#define P1OUT            SIM_REG(P[1].POUT)
+#define P1DIR            SIM_REG(P[1].PDIR)
+#define P1REN            SIM_REG(P[1].PREN)
+#define P1DS             SIM_REG(P[1].PDS)
+#define P1SEL            SIM_REG(P[1].PSEL)
+#define P1IES            SIM_REG(P[1].PIES)
+#define P1IE             SIM_REG(P[1].PIE)
+#define P1IFG            SIM_REG(P[1].PIFG)
+#define P1IV             SIM_REG(P[1].PIV)
+
+#define P2IN             SIM_REG(P[2].PIN)
+#define P2OUT            SIM_REG(P[2].POUT)
+#define P2DIR            SIM_REG(P[2].PDIR)
+#define P2REN            SIM_REG(P[2].PREN)
+#define P2DS             SIM_REG(P[2].PDS)
+#define P2SEL            SIM_REG(P[2].PSEL)
+#define P2IES            SIM_REG(P[2].PIES)
+#define P2IE             SIM_REG(P[2].PIE)
+#define P2IFG            SIM_REG(P[2].PIFG)
+#define P2IV             SIM_REG(P[2].PIV)
+
+#define P3IN             SIM_REG(P[3].PIN)
+#define P3OUT            SIM_REG(P[3].POUT)
+#define P3DIR            SIM_REG(P[3].PDIR)
+#define P3REN            SIM_REG(P[3].PREN)
+#define P3DS             SIM_REG(P[3].PDS)
+#define P3SEL            SIM_REG(P[3].PSEL)
+
+#define P4IN             SIM_REG(P[4].PIN)
+#define P4OUT            SIM_REG(P[4].POUT)
+#define P4DIR            SIM_REG(P[4].PDIR)
+#define P4REN            SIM_REG(P[4].PREN)
+#define P4DS             SIM_REG(P[4].PDS)
+#define P4SEL            SIM_REG(P[4].PSEL)
+
+#define P5IN             SIM_REG(P[5].PIN)
+#define P5OUT            SIM_REG(P[5].POUT)
+#define P5DIR            SIM_REG(P[5].PDIR)
+#define P5REN            SIM_REG(P[5].PREN)
+#define P5DS             SIM_REG(P[5].PDS)
+#define P5SEL            SIM_REG(P[5].PSEL)
+
+#define P6IN             SIM_REG(P[6].PIN)
+#define P6OUT            SIM_REG(P[6].POUT)
+#define P6DIR            SIM_REG(P[6].PDIR)
+#define P6REN            SIM_REG(P[6].PREN)
+#define P6DS             SIM_REG(P[6].PDS)
+#define P6SEL            SIM_REG(P[6].PSEL)
+
+#define P7IN             SIM_REG(P[7].PIN)
+#define P7OUT            SIM_REG(P[7].POUT)
+#define P7DIR            SIM_REG(P[7].PDIR)
+#define P7REN            SIM_REG(P[7].PREN)
+#define P7DS             SIM_REG(P[7].PDS)
+#define P7SEL            SIM_REG(P[7].PSEL)
+
+#define P8IN             SIM_REG(P[8].PIN)
+#define P8OUT            SIM_REG(P[8].POUT)
+#define P8DIR            SIM_REG(P[8].PDIR)
+#define P8REN            SIM_REG(P[8].PREN)
+#define P8DS             SIM_REG(P[8].PDS)
+#define P8SEL            SIM_REG(P[8].PSEL)
+
+// Timer_A0..A2, Timer_B0
+#define TA0CTL           SIM_REG(T[0].CTL)
+#define TA0R             SIM_REG(T[0].R)
+#define TA0IV            SIM_REG(T[0].IV)
+#define TA0EX0           SIM_REG(T[0].EX0)
+#define TA0CCTL0         SIM_REG(T[0].CCTL[0])
+#define TA0CCR0          SIM_REG(T[0].CCR[0])
+#define TA0CCTL1         SIM_REG(T[0].CCTL[1])
+#define TA0CCR1          SIM_REG(T[0].CCR[1])
+#define TA0CCTL2         SIM_REG(T[0].CCTL[2])
+#define TA0CCR2          SIM_REG(T[0].CCR[2])
+#define TA0CCTL3         SIM_REG(T[0].CCTL[3])
+#define TA0CCR3          SIM_REG(T[0].CCR[3])
+#define TA0CCTL4         SIM_REG(T[0].CCTL[4])
+#define TA0CCR4          SIM_REG(T[0].CCR[4])
+
+#define TA1CTL           SIM_REG(T[1].CTL)
+#define TA1R             SIM_REG(T[1].R)
+#define TA1IV            SIM_REG(T[1].IV)
+#define TA1EX0           SIM_REG(T[1].EX0)
+#define TA1CCTL0         SIM_REG(T[1].CCTL[0])
+#define TA1CCR0          SIM_REG(T[1].CCR[0])
+#define TA1CCTL1         SIM_REG(T[1].CCTL[1])
+#define TA1CCR1          SIM_REG(T[1].CCR[1])
+#define TA1CCTL2         SIM_REG(T[1].CCTL[2])
+#define TA1CCR2          SIM_REG(T[1].CCR[2])
+
+#define TA2CTL           SIM_REG(T[2].CTL)
+#define TA2R             SIM_REG(T[2].R)
+#define TA2IV            SIM_REG(T[2].IV)
+#define TA2EX0           SIM_REG(T[2].EX0)
+#define TA2CCTL0         SIM_REG(T[2].CCTL[0])
+#define TA2CCR0          SIM_REG(T[2].CCR[0])
+#define TA2CCTL1         SIM_REG(T[2].CCTL[1])
+#define TA2CCR1          SIM_REG(T[2].CCR[1])
+#define TA2CCTL2         SIM_REG(T[2].CCTL[2])
+#define TA2CCR2          SIM_REG(T[2].CCR[2])
+
+#define TB0CTL           SIM_REG(T[3].CTL)
+#define TB0R             SIM_REG(T[3].R)
+#define TB0IV            SIM_REG(T[3].IV)
+#define TB0EX0           SIM_REG(T[3].EX0)
+#define TB0CCTL0         SIM_REG(T[3].CCTL[0])
+#define TB0CCR0          SIM_REG(T[3].CCR[0])
+#define TB0CCTL1         SIM_REG(T[3].CCTL[1])
+#define TB0CCR1          SIM_REG(T[3].CCR[1])
+#define TB0CCTL2         SIM_REG(T[3].CCTL[2])
+#define TB0CCR2          SIM_REG(T[3].CCR[2])
+#define TB0CCTL3         SIM_REG(T[3].CCTL[3])
+#define TB0CCR3          SIM_REG(T[3].CCR[3])
+#define TB0CCTL4         SIM_REG(T[3].CCTL[4])
+#define TB0CCR4          SIM_REG(T[3].CCR[4])
+#define TB0CCTL5         SIM_REG(T[3].CCTL[5])
+#define TB0CCR5          SIM_REG(T[3].CCR[5])
+#define TB0CCTL6         SIM_REG(T[3].CCTL[6])
+#define TB0CCR6          SIM_REG(T[3].CCR[6])
+
+// USCI_A0, USCI_A1, USCI_B0, USCI_B1
+#define UCA0CTL0         SIM_REG(U[0].CTL0)
+#define UCA0CTL1         SIM_REG(U[0].CTL1)
+#define UCA0BR0          SIM_REG(U[0].BR0)
+#define UCA0BR1          SIM_REG(U[0].BR1)
+#define UCA0MCTL         SIM_REG(U[0].MCTL)
+#define UCA0STAT         SIM_REG(U[0].STAT)
+#define UCA0RXBUF        SIM_REG(U[0].RXBUF)
+#define UCA0TXBUF        SIM_REG(U[0].TXBUF)
+#define UCA0IE           SIM_REG(U[0].IE)
+#define UCA0IFG          SIM_REG(U[0].IFG)
+#define UCA0IV           SIM_REG(U[0].IV)
+#define UCA0BRW          SIM_REG16_AT(U[0].BR0)
+
+#define UCA1CTL0         SIM_REG(U[1].CTL0)
+#define UCA1CTL1         SIM_REG(U[1].CTL1)
+#define UCA1BR0          SIM_REG(U[1].BR0)
+#define UCA1BR1          SIM_REG(U[1].BR1)
+#define UCA1MCTL         SIM_REG(U[1].MCTL)
+#define UCA1STAT         SIM_REG(U[1].STAT)
+#define UCA1RXBUF        SIM_REG(U[1].RXBUF)
+#define UCA1TXBUF        SIM_REG(U[1].TXBUF)
+#define UCA1IE           SIM_REG(U[1].IE)
+#define UCA1IFG          SIM_REG(U[1].IFG)
+#define UCA1IV           SIM_REG(U[1].IV)
+#define UCA1BRW          SIM_REG16_AT(U[1].BR0)
+
+#define UCB0CTL0         SIM_REG(U[2].CTL0)
+#define UCB0CTL1         SIM_REG(U[2].CTL1)
+#define UCB0BR0          SIM_REG(U[2].BR0)
+#define UCB0BR1          SIM_REG(U[2].BR1)
+#define UCB0MCTL         SIM_REG(U[2].MCTL)
+#define UCB0STAT         SIM_REG(U[2].STAT)
+#define UCB0RXBUF        SIM_REG(U[2].RXBUF)
+#define UCB0TXBUF        SIM_REG(U[2].TXBUF)
+#define UCB0IE           SIM_REG(U[2].IE)
+#define UCB0IFG          SIM_REG(U[2].IFG)
+#define UCB0IV           SIM_REG(U[2].IV)
+#define UCB0BRW          SIM_REG16_AT(U[2].BR0)
+
+#define UCB1CTL0         SIM_REG(U[3].CTL0)
+#define UCB1CTL1         SIM_REG(U[3].CTL1)
+#define UCB1BR0          SIM_REG(U[3].BR0)
+#define UCB1BR1          SIM_REG(U[3].BR1)
+#define UCB1MCTL         SIM_REG(U[3].MCTL)
+#define UCB1STAT         SIM_REG(U[3].STAT)
+#define UCB1RXBUF        SIM_REG(U[3].RXBUF)
+#define UCB1TXBUF        SIM_REG(U[3].TXBUF)
+#define UCB1IE           SIM_REG(U[3].IE)
+#define UCB1IFG          SIM_REG(U[3].IFG)
+#define UCB1IV           SIM_REG(U[3].IV)
+#define UCB1BRW          SIM_REG16_AT(U[3].BR0)
+
+// ADC12_A
+#define ADC12CTL0        SIM_REG(ADC12CTL0Reg)
+#define ADC12CTL1        SIM_REG(ADC12CTL1Reg)
+#define ADC12CTL2        SIM_REG(ADC12CTL2Reg)
+#define ADC12IFG         SIM_REG(ADC12IFGReg)
+#define ADC12IE          SIM_REG(ADC12IEReg)
+#define ADC12IV          SIM_REG(ADC12IVReg)
+#define ADC12MCTL0       SIM_REG(ADC12MCTL[0])
+#define ADC12MCTL1       SIM_REG(ADC12MCTL[1])
+#define ADC12MCTL2       SIM_REG(ADC12MCTL[2])
+#define ADC12MCTL3       SIM_REG(ADC12MCTL[3])
+#define ADC12MCTL4       SIM_REG(ADC12MCTL[4])
+#define ADC12MCTL5       SIM_REG(ADC12MCTL[5])
+#define ADC12MCTL6       SIM_REG(ADC12MCTL[6])
+#define ADC12MCTL7       SIM_REG(ADC12MCTL[7])
+#define ADC12MCTL8       SIM_REG(ADC12MCTL[8])
+#define ADC12MCTL9       SIM_REG(ADC12MCTL[9])
+#define ADC12MCTL10      SIM_REG(ADC12MCTL[10])
+#define ADC12MCTL11      SIM_REG(ADC12MCTL[11])
+#define ADC12MCTL12      SIM_REG(ADC12MCTL[12])
+#define ADC12MCTL13      SIM_REG(ADC12MCTL[13])
+#define ADC12MCTL14      SIM_REG(ADC12MCTL[14])
+#define ADC12MCTL15      SIM_REG(ADC12MCTL[15])
+#define ADC12MEM0        SIM_REG(ADC12MEM[0])
+#define ADC12MEM1        SIM_REG(ADC12MEM[1])
+#define ADC12MEM2        SIM_REG(ADC12MEM[2])
+#define ADC12MEM3        SIM_REG(ADC12MEM[3])
+#define ADC12MEM4        SIM_REG(ADC12MEM[4])
+#define ADC12MEM5        SIM_REG(ADC12MEM[5])
+#define ADC12MEM6        SIM_REG(ADC12MEM[6])
+#define ADC12MEM7        SIM_REG(ADC12MEM[7])
+#define ADC12MEM8        SIM_REG(ADC12MEM[8])
+#define ADC12MEM9        SIM_REG(ADC12MEM[9])
+#define ADC12MEM10       SIM_REG(ADC12MEM[10])
+#define ADC12MEM11       SIM_REG(ADC12MEM[11])
+#define ADC12MEM12       SIM_REG(ADC12MEM[12])
+#define ADC12MEM13       SIM_REG(ADC12MEM[13])
+#define ADC12MEM14       SIM_REG(ADC12MEM[14])
+#define ADC12MEM15       SIM_REG(ADC12MEM[15])
+
+/*******************************************************************************
+ * Intrinsics
+ ******************************************************************************/
+
+#define __interrupt
+#define __even_in_range(value, bound)   (value)
+
+extern unsigned short __get_SR_register(void);
+extern void __bis_SR_register(unsigned short bits);
+extern void __bic_SR_register(unsigned short bits);
+extern void __bis_SR_register_on_exit(unsigned short bits);
+extern void __bic_SR_register_on_exit(unsigned short bits);
+extern void __disable_interrupt(void);
+extern void __enable_interrupt(void);
+extern void __no_operation(void);
+extern void __delay_cycles(unsigned long cycles);
+
+/*******************************************************************************
+ * Bits
+ ******************************************************************************/
+
+#define BIT0                (0x0001)
+#define BIT1                (0x0002)
+#define BIT2                (0x0004)
+#define BIT3                (0x0008)
+#define BIT4                (0x0010)
+#define BIT5                (0x0020)
+#define BIT6                (0x0040)
+#define BIT7                (0x0080)
+#define BIT8                (0x0100)
+#define BIT9                (0x0200)
+#define BITA                (0x0400)
+#define BITB                (0x0800)
+#define BITC                (0x1000)
+#define BITD                (0x2000)
+#define BITE                (0x4000)
+#define BITF                (0x8000)
+
+// Status register
+#define GIE                 (0x0008)
+#define CPUOFF              (0x0010)
+#define OSCOFF              (0x0020)
+#define SCG0                (0x0040)
+#define SCG1                (0x0080)
+#define LPM0_bits           (CPUOFF)
+#define LPM1_bits           (SCG0 + CPUOFF)
+#define LPM2_bits           (SCG1 + CPUOFF)
+#define LPM3_bits           (SCG1 + SCG0 + CPUOFF)
+#define LPM4_bits           (SCG1 + SCG0 + OSCOFF + CPUOFF)
+
+// Interrupt vectors, only used by #pragma vector
+#define RTC_VECTOR          (41)
+#define PORT2_VECTOR        (42)
+#define TIMER2_A1_VECTOR    (43)
+#define TIMER2_A0_VECTOR    (44)
+#define USCI_B1_VECTOR      (45)
+#define USCI_A1_VECTOR      (46)
+#define PORT1_VECTOR        (47)
+#define TIMER1_A1_VECTOR    (48)
+#define TIMER1_A0_VECTOR    (49)
+#define DMA_VECTOR          (50)
+#define TIMER0_A1_VECTOR    (52)
+#define TIMER0_A0_VECTOR    (53)
+#define ADC12_VECTOR        (54)
+#define USCI_A0_VECTOR      (56)
+#define WDT_VECTOR          (57)
+#define TIMER0_B1_VECTOR    (58)
+#define TIMER0_B0_VECTOR    (59)
+
+// SFR
+#define OFIFG               (0x0002)
+#define OFIE                (0x0002)
+
+// WDT_A
+#define WDTPW               (0x5A00)
+#define WDTHOLD             (0x0080)
+
+// PMM
+#define PMMPW               (0xA500)
+#define PMMPW_H             (0xA5)
+#define PMMCOREV0           (0x0001)
+#define PMMCOREV_0          (0x0000)
+#define PMMCOREV_1          (0x0001)
+#define PMMCOREV_2          (0x0002)
+#define PMMCOREV_3          (0x0003)
+#define SVSMHRRL0           (0x0001)
+#define SVSHRVL0            (0x0100)
+#define SVSHE               (0x0400)
+#define SVMHE               (0x4000)
+#define SVSMLRRL0           (0x0001)
+#define SVSLRVL0            (0x0100)
+#define SVSLRVL_3           (0x0300)
+#define SVSLE               (0x0400)
+#define SVMLE               (0x4000)
+#define SVSMLDLYIFG         (0x0001)
+#define SVMLIFG             (0x0002)
+#define SVMLVLRIFG          (0x0004)
+#define SVSMHDLYIFG         (0x0010)
+#define SVMHIFG             (0x0020)
+#define SVMHVLRIFG          (0x0040)
+
+// UCS
+#define DCORSEL_0           (0x0000)
+#define DCORSEL_1           (0x0010)
+#define DCORSEL_2           (0x0020)
+#define DCORSEL_3           (0x0030)
+#define DCORSEL_4           (0x0040)
+#define DCORSEL_5           (0x0050)
+#define DCORSEL_6           (0x0060)
+#define DCORSEL_7           (0x0070)
+#define FLLD__1             (0x0000)
+#define FLLD__2             (0x1000)
+#define FLLD__4             (0x2000)
+#define FLLD__8             (0x3000)
+#define FLLD__16            (0x4000)
+#define FLLD__32            (0x5000)
+#define FLLREFDIV__1        (0x0000)
+#define FLLREFDIV__2        (0x0001)
+#define FLLREFDIV__4        (0x0002)
+#define FLLREFDIV__8        (0x0003)
+#define FLLREFDIV__12       (0x0004)
+#define FLLREFDIV__16       (0x0005)
+#define SELREF_7            (0x0070)
+#define SELREF__XT1CLK      (0x0000)
+#define SELREF__REFOCLK     (0x0020)
+#define SELREF__XT2CLK      (0x0050)
+#define SELM_7              (0x0007)
+#define SELM__XT1CLK        (0x0000)
+#define SELM__VLOCLK        (0x0001)
+#define SELM__REFOCLK       (0x0002)
+#define SELM__DCOCLK        (0x0003)
+#define SELM__DCOCLKDIV     (0x0004)
+#define SELM__XT2CLK        (0x0005)
+#define SELS_7              (0x0070)
+#define SELS__XT1CLK        (0x0000)
+#define SELS__VLOCLK        (0x0010)
+#define SELS__REFOCLK       (0x0020)
+#define SELS__DCOCLK        (0x0030)
+#define SELS__DCOCLKDIV     (0x0040)
+#define SELS__XT2CLK        (0x0050)
+#define SELA_7              (0x0700)
+#define SELA__XT1CLK        (0x0000)
+#define SELA__VLOCLK        (0x0100)
+#define SELA__REFOCLK       (0x0200)
+#define SELA__DCOCLK        (0x0300)
+#define SELA__DCOCLKDIV     (0x0400)
+#define SELA__XT2CLK        (0x0500)
+#define DIVM_7              (0x0007)
+#define DIVS_7              (0x0070)
+#define DIVS__1             (0x0000)
+#define DIVS__2             (0x0010)
+#define DIVS__4             (0x0020)
+#define DIVS__8             (0x0030)
+#define DIVS__16            (0x0040)
+#define DIVS__32            (0x0050)
+#define DIVA_7              (0x0700)
+#define XT1OFF              (0x0001)
+#define SMCLKOFF            (0x0002)
+#define XCAP_3              (0x000C)
+#define XT1BYPASS           (0x0010)
+#define XTS                 (0x0020)
+#define XT1DRIVE_3          (0x00C0)
+#define XT2OFF              (0x0100)
+#define DCOFFG              (0x0001)
+#define XT1LFOFFG           (0x0002)
+#define XT1HFOFFG           (0x0004)
+#define XT2OFFG             (0x0008)
+
+// Timer_A / Timer_B
+#define TAIFG               (0x0001)
+#define TAIE                (0x0002)
+#define TACLR               (0x0004)
+#define MC0                 (0x0010)
+#define MC1                 (0x0020)
+#define MC_0                (0x0000)
+#define MC_1                (0x0010)
+#define MC_2                (0x0020)
+#define MC_3                (0x0030)
+#define MC__STOP            (0x0000)
+#define MC__UP              (0x0010)
+#define MC__CONTINOUS       (0x0020)
+#define MC__CONTINUOUS      (0x0020)
+#define MC__UPDOWN          (0x0030)
+#define ID_0                (0x0000)
+#define ID_1                (0x0040)
+#define ID_2                (0x0080)
+#define ID_3                (0x00C0)
+#define ID__1               (0x0000)
+#define ID__2               (0x0040)
+#define ID__4               (0x0080)
+#define ID__8               (0x00C0)
+#define TASSEL_0            (0x0000)
+#define TASSEL_1            (0x0100)
+#define TASSEL_2            (0x0200)
+#define TASSEL_3            (0x0300)
+#define TASSEL__TACLK       (0x0000)
+#define TASSEL__ACLK        (0x0100)
+#define TASSEL__SMCLK       (0x0200)
+#define TASSEL__INCLK       (0x0300)
+#define TAIDEX_0            (0x0000)
+#define TAIDEX_7            (0x0007)
+#define TBIFG               (0x0001)
+#define TBIE                (0x0002)
+#define TBCLR               (0x0004)
+#define TBSSEL_1            (0x0100)
+#define TBSSEL_2            (0x0200)
+#define TBSSEL__ACLK        (0x0100)
+#define TBSSEL__SMCLK       (0x0200)
+#define CCIFG               (0x0001)
+#define COV                 (0x0002)
+#define OUT                 (0x0004)
+#define CCIE                (0x0010)
+#define OUTMOD_0            (0x0000)
+#define OUTMOD_3            (0x0060)
+#define OUTMOD_4            (0x0080)
+#define OUTMOD_7            (0x00E0)
+#define CAP                 (0x0100)
+#define TA0IV_NONE          (0)
+#define TA0IV_TACCR1        (2)
+#define TA0IV_TAIFG         (14)
+#define TA1IV_NONE          (0)
+#define TA1IV_TACCR1        (2)
+#define TA1IV_TACCR2        (4)
+#define TA1IV_TAIFG         (14)
+#define TA2IV_NONE          (0)
+#define TA2IV_TACCR1        (2)
+#define TA2IV_TACCR2        (4)
+#define TA2IV_TAIFG         (14)
+
+// USCI
+#define UCSWRST             (0x01)
+#define UCSSEL_0            (0x00)
+#define UCSSEL_1            (0x40)
+#define UCSSEL_2            (0x80)
+#define UCSSEL_3            (0xC0)
+#define UCSSEL__ACLK        (0x40)
+#define UCSSEL__SMCLK       (0x80)
+#define UCSYNC              (0x01)
+#define UCMODE_0            (0x00)
+#define UCMODE_1            (0x02)
+#define UCMODE_2            (0x04)
+#define UCMODE_3            (0x06)
+#define UCMST               (0x08)
+#define UC7BIT              (0x10)
+#define UCMSB               (0x20)
+#define UCCKPL              (0x40)
+#define UCCKPH              (0x80)
+#define UCSPB               (0x08)
+#define UCPAR               (0x40)
+#define UCPEN               (0x80)
+#define UCOS16              (0x01)
+#define UCBRS_0             (0x00)
+#define UCBRF_0             (0x00)
+#define UCBUSY              (0x01)
+#define UCOE                (0x20)
+#define UCFE                (0x40)
+#define UCLISTEN            (0x80)
+#define UCRXIFG             (0x01)
+#define UCTXIFG             (0x02)
+#define UCRXIE              (0x01)
+#define UCTXIE              (0x02)
+#define USCI_NONE           (0)
+#define USCI_UCRXIFG        (2)
+#define USCI_UCTXIFG        (4)
+
+// Digital I/O
+#define P1IV_NONE           (0)
+#define P2IV_NONE           (0)
+
+// ADC12_A
+#define ADC12SC             (0x0001)
+#define ADC12ENC            (0x0002)
+#define ADC12ON             (0x0010)
+#define ADC12MSC            (0x0080)
+#define ADC12BUSY           (0x0001)
+#define ADC12CONSEQ_0       (0x0000)
+#define ADC12CONSEQ_1       (0x0002)
+#define ADC12CONSEQ_2       (0x0004)
+#define ADC12CONSEQ_3       (0x0006)
+#define ADC12SHP            (0x0200)
+#define ADC12CSTARTADD_0    (0x0000)
+#define ADC12EOS            (0x80)
+#define ADC12INCH_0         (0x00)
+#define ADC12IV_NONE        (0)
+
+#endif /* SIM_MSP430_H */
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""Decode COBS framed AppFrame packets sent by HAL_AppFrame.c.
+
+Reads a raw byte stream from a serial port (needs pyserial) or a file /
+stdin, splits it at 0x00 delimiters, COBS-decodes each frame, checks the
+CRC-CCITT and reports sequence gaps.
+
+    appframe_decode.py --port /dev/ttyACM0 --baud 460800
+    appframe_decode.py capture.bin
+"""
+
+import argparse
+import sys
+
+TYPE_TEXT = 0x01
+TYPE_ACCEL = 0x02
+
+TYPE_NAMES = {
+    TYPE_TEXT: "text",
+    TYPE_ACCEL: "accel",
+}
+
+
+def crc_ccitt(data, crc=0xFFFF):
+    """CRC-CCITT (poly 0x1021, init 0xFFFF), as computed by the CRC16 module."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    """Return the decoded bytes, or None if the encoding is malformed."""
+    out = bytearray()
+    index = 0
+    while index < len(data):
+        code = data[index]
+        if code == 0 or index + code > len(data):
+            return None
+        out += data[index + 1:index + code]
+        index += code
+        if code < 0xFF and index < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def int8(value):
+    return value - 256 if value > 127 else value
+
+
+class Decoder:
+    def __init__(self, out):
+        self.out = out
+        self.buffer = bytearray()
+        self.expected_seq = None
+        self.frames = 0
+        self.crc_errors = 0
+        self.lost = 0
+
+    def feed(self, chunk):
+        for byte in chunk:
+            if byte == 0:
+                if self.buffer:
+                    self.frame(bytes(self.buffer))
+                self.buffer.clear()
+            else:
+                self.buffer.append(byte)
+
+    def frame(self, encoded):
+        raw = cobs_decode(encoded)
+        if raw is None or len(raw) < 4:
+            self.crc_errors += 1
+            self.out.write("! malformed frame (%d bytes)\n" % len(encoded))
+            return
+        body, crc = raw[:-2], (raw[-2] << 8) | raw[-1]
+        if crc_ccitt(body) != crc:
+            self.crc_errors += 1
+            self.out.write("! CRC error\n")
+            return
+
+        frame_type, seq, payload = body[0], body[1], body[2:]
+        if self.expected_seq is not None and seq != self.expected_seq:
+            gap = (seq - self.expected_seq) & 0xFF
+            self.lost += gap
+            self.out.write("! %d frame(s) lost before seq %d\n" % (gap, seq))
+        self.expected_seq = (seq + 1) & 0xFF
+        self.frames += 1
+
+        name = TYPE_NAMES.get(frame_type, "0x%02X" % frame_type)
+        if frame_type == TYPE_TEXT:
+            text = payload.decode("ascii", "replace")
+            self.out.write("%3d %s %s\n" % (seq, name, text))
+        elif frame_type == TYPE_ACCEL:
+            samples = [tuple(int8(v) for v in payload[i:i + 3])
+                       for i in range(0, len(payload) - 2, 3)]
+            for x, y, z in samples:
+                self.out.write("%3d %s %4d %4d %4d\n" % (seq, name, x, y, z))
+        else:
+            self.out.write("%3d %s %s\n" % (seq, name, payload.hex()))
+
+    def summary(self):
+        return "%d frames, %d lost, %d CRC/format errors" % (
+            self.frames, self.lost, self.crc_errors)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("file", nargs="?", help="capture file (default: stdin)")
+    parser.add_argument("--port", help="serial port to read from")
+    parser.add_argument("--baud", type=int, default=9600)
+    args = parser.parse_args()
+
+    decoder = Decoder(sys.stdout)
+    try:
+        if args.port:
+            import serial
+            with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+                while True:
+                    decoder.feed(port.read(4096))
+        else:
+            stream = open(args.file, "rb") if args.file else sys.stdin.buffer
+            with stream:
+                while True:
+                    chunk = stream.read(4096)
+                    if not chunk:
+                        break
+                    decoder.feed(chunk)
+    except KeyboardInterrupt:
+        pass
+    sys.stderr.write(decoder.summary() + "\n")
+
+
+if __name__ == "__main__":
+    main()
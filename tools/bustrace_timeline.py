@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+"""Turn a "bustrace" shell dump into a timeline of SPI bus activity.
+
+Reads the dump printed by the bustrace shell command from a file / stdin,
+or sends the command to the board over a serial port (needs pyserial). It
+prints every transaction with its start time and the idle gap on its bus,
+then a summary of bus load per device and the largest idle gaps. With
+--chrome it also writes a trace that chrome://tracing or Perfetto show as
+one lane per bus.
+
+    bustrace_timeline.py dump.txt
+    bustrace_timeline.py --port /dev/ttyACM0 --baud 460800 --chrome bus.json
+"""
+
+import argparse
+import json
+import sys
+
+TICK_SLACK = 2      # ACLK ticks the cycle delta may disagree before resyncing
+
+
+class Entry:
+    def __init__(self, fields):
+        self.seq = int(fields[0])
+        self.device = fields[1]
+        self.bus = fields[2]
+        self.direction = fields[3]
+        self.bytes = int(fields[4])
+        self.tick = int(fields[5])
+        self.start = int(fields[6])
+        self.cycles = int(fields[7])
+        self.time_us = 0.0
+        self.duration_us = 0.0
+
+
+def parse(lines):
+    """Return (header dict, entries) from the lines of a dump."""
+    header = {}
+    entries = []
+    for line in lines:
+        fields = line.split()
+        if not fields:
+            continue
+        if fields[0] == "#":
+            if len(fields) > 1 and fields[1] == "bustrace":
+                header = dict(zip(fields[2::2], (int(v) for v in fields[3::2])))
+            continue
+        if len(fields) == 8 and fields[0].isdigit():
+            entries.append(Entry(fields))
+    if not header:
+        raise SystemExit("no '# bustrace' header found")
+    return header, entries
+
+
+def place(header, entries):
+    """Set time_us of every entry, relative to the first one.
+
+    The cycle counter is precise but stops in LPM3; the ACLK tick keeps
+    counting. Consecutive entries use the cycle delta as long as it agrees
+    with the tick delta, otherwise the CPU slept in between and the ticks
+    are used.
+    """
+    smclk = header["smclk_hz"]
+    aclk = header["aclk_hz"]
+    previous = None
+    for entry in entries:
+        entry.duration_us = entry.cycles * 1e6 / smclk
+        if previous is None:
+            entry.time_us = 0.0
+        else:
+            cycle_delta = (entry.start - previous.start) & 0xFFFFFFFF
+            tick_delta = (entry.tick - previous.tick) & 0xFFFFFFFF
+            if abs(cycle_delta * aclk / smclk - tick_delta) <= TICK_SLACK:
+                entry.time_us = previous.time_us + cycle_delta * 1e6 / smclk
+            else:
+                entry.time_us = previous.time_us + tick_delta * 1e6 / aclk
+        previous = entry
+
+
+def timeline(entries, out):
+    out.write("%12s %10s %10s %-6s %-6s %-3s %6s\n" % (
+        "start_us", "dur_us", "gap_us", "bus", "device", "dir", "bytes"))
+    bus_end = {}
+    for entry in entries:
+        end = bus_end.get(entry.bus)
+        gap = "-" if end is None else "%.1f" % (entry.time_us - end)
+        out.write("%12.1f %10.1f %10s %-6s %-6s %-3s %6d\n" % (
+            entry.time_us, entry.duration_us, gap, entry.bus, entry.device,
+            entry.direction, entry.bytes))
+        bus_end[entry.bus] = entry.time_us + entry.duration_us
+
+
+def summary(header, entries, out, worst):
+    if not entries:
+        out.write("no transactions\n")
+        return
+    span = entries[-1].time_us + entries[-1].duration_us - entries[0].time_us
+    dropped = entries[0].seq
+    out.write("\n%d transactions over %.1f us, %d older ones overwritten\n" % (
+        len(entries), span, dropped))
+
+    out.write("\n%-6s %-6s %6s %8s %10s %6s\n" % ("bus", "device", "count", "bytes", "busy_us", "load"))
+    totals = {}
+    for entry in entries:
+        key = (entry.bus, entry.device)
+        count, size, busy = totals.get(key, (0, 0, 0.0))
+        totals[key] = (count + 1, size + entry.bytes, busy + entry.duration_us)
+    for (bus, device), (count, size, busy) in sorted(totals.items()):
+        out.write("%-6s %-6s %6d %8d %10.1f %5.1f%%\n" % (
+            bus, device, count, size, busy, 100.0 * busy / span if span else 0.0))
+
+    # Idle gaps per bus and back-to-back transfers of different devices
+    gaps = []
+    switches = 0
+    last = {}
+    for entry in entries:
+        previous = last.get(entry.bus)
+        if previous is not None:
+            gap = entry.time_us - (previous.time_us + previous.duration_us)
+            gaps.append((gap, entry.bus, previous, entry))
+            if previous.device != entry.device:
+                switches += 1
+        last[entry.bus] = entry
+    out.write("\n%d device switches on a shared bus\n" % switches)
+    out.write("\nlargest idle gaps\n")
+    for gap, bus, before, after in sorted(gaps, key=lambda g: -g[0])[:worst]:
+        out.write("%10.1f us on %s after %s #%d at %.1f us, before %s #%d\n" % (
+            gap, bus, before.device, before.seq, before.time_us + before.duration_us,
+            after.device, after.seq))
+
+
+def chrome_trace(entries, path):
+    events = []
+    buses = sorted(set(entry.bus for entry in entries))
+    for index, bus in enumerate(buses):
+        events.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": index,
+                       "args": {"name": bus}})
+    for entry in entries:
+        events.append({
+            "name": "%s %s %d" % (entry.device, entry.direction, entry.bytes),
+            "cat": entry.device,
+            "ph": "X",
+            "pid": 1,
+            "tid": buses.index(entry.bus),
+            "ts": entry.time_us,
+            "dur": entry.duration_us,
+            "args": {"seq": entry.seq, "bytes": entry.bytes},
+        })
+    with open(path, "w") as stream:
+        json.dump({"traceEvents": events}, stream)
+
+
+def read_port(port, baud):
+    import serial
+    lines = []
+    with serial.Serial(port, baud, timeout=2) as stream:
+        stream.write(b"bustrace\r")
+        while True:
+            line = stream.readline().decode("ascii", "replace")
+            if not line:
+                raise SystemExit("timeout waiting for the dump")
+            lines.append(line)
+            if line.startswith("# end"):
+                return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("file", nargs="?", help="dump file (default: stdin)")
+    parser.add_argument("--port", help="serial port of the shell")
+    parser.add_argument("--baud", type=int, default=9600)
+    parser.add_argument("--chrome", metavar="JSON", help="also write a Chrome trace")
+    parser.add_argument("--gaps", type=int, default=5, help="idle gaps to list")
+    args = parser.parse_args()
+
+    if args.port:
+        lines = read_port(args.port, args.baud)
+    else:
+        with (open(args.file) if args.file else sys.stdin) as stream:
+            lines = stream.readlines()
+
+    header, entries = parse(lines)
+    place(header, entries)
+    timeline(entries, sys.stdout)
+    summary(header, entries, sys.stdout, args.gaps)
+    if args.chrome:
+        chrome_trace(entries, args.chrome)
+
+
+if __name__ == "__main__":
+    main()